@@ -71,7 +71,8 @@ namespace casual
                booted = 1,
                idle,
                busy,
-               shutdown
+               shutdown,
+               reserved
             };
 
             Process process;
@@ -41,24 +41,6 @@ namespace casual
 
          } // instance
 
-         struct Pending
-         {
-            Pending( const state::Server::Instance& instance) : m_instance( instance) {}
-
-            bool operator () ( const common::message::service::lookup::Request& request)
-            {
-               for( auto& service : m_instance.services)
-               {
-                  if( service.get().information.name == request.requested)
-                  {
-                     return true;
-                  }
-               }
-               return false;
-            }
-            const state::Server::Instance& m_instance;
-         };
-
          namespace group
          {
 
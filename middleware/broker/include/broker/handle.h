@@ -74,6 +74,23 @@ namespace casual
             void instances( State& state, const state::Server& server);
          } // update
 
+         namespace reservation
+         {
+            //!
+            //! @return time until the first revoked reservation shall be reclaimed,
+            //!   std::chrono::microseconds::min() if there are none (no timeout)
+            //!
+            std::chrono::microseconds timeout( const State& state);
+
+            //!
+            //! Takes back the instances that the callers has not released in time, after
+            //! a revoke. The instance might still serve the caller, so we ping it, and the
+            //! instance is idle first when the ping reply comes, @see reservation::Reclaimed
+            //!
+            void reclaim( State& state);
+
+         } // reservation
+
 
          namespace traffic
          {
@@ -192,8 +209,42 @@ namespace casual
                void operator () ( const common::message::lookup::process::Request& message);
             };
 
+            //!
+            //! Handles release of reserved instances from callers.
+            //!
+            //! The instance is idle after this, hence if there are pending request for
+            //! the instance's services we send response directly
+            //!
+            struct Release : Base
+            {
+               typedef common::message::service::lookup::Release message_type;
+
+               using Base::Base;
+
+               void operator () ( message_type& message);
+            };
+
          } // lookup
 
+         namespace reservation
+         {
+            //!
+            //! Handles the ping reply from an instance we're taking back from a caller.
+            //!
+            //! The instance has served all calls the caller sent before the ping, so it's idle,
+            //! and if there are pending request for the instance's services we send response directly
+            //!
+            struct Reclaimed : Base
+            {
+               typedef common::message::server::ping::Reply message_type;
+
+               using Base::Base;
+
+               void operator () ( message_type& message);
+            };
+
+         } // reservation
+
 
          //!
          //! Advertise 0..N services for a server.
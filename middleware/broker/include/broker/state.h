@@ -164,17 +164,40 @@ namespace casual
                   booted = 1,
                   idle,
                   busy,
-                  shutdown
+                  shutdown,
+                  //! reserved by a caller, that calls the instance directly
+                  reserved
                };
 
-               void alterState( State state)
-               {
-                  this->state = state;
-                  last = common::platform::clock_type::now();
-               }
+               //!
+               //! Sets the state, and keeps the idle instances of the services up to date
+               //!
+               void alterState( State state);
 
 
                common::process::Handle process;
+
+               //!
+               //! The caller that has reserved the instance, if state is reserved
+               //!
+               common::process::Handle caller;
+
+               //!
+               //! true if we've asked the caller to release the reservation
+               //!
+               bool revoked = false;
+
+               //!
+               //! When we take the instance back, if the caller has not released it after a revoke
+               //!
+               common::platform::time_point reclaim = common::platform::time_point::max();
+
+               //!
+               //! true if we've pinged the instance to take it back. The ping reply comes after
+               //! the calls the caller has already sent, so we know the instance is done with them
+               //!
+               bool reclaiming = false;
+
                std::size_t invoked = 0;
                common::platform::time_point last = common::platform::time_point::min();
                Server::id_type server = 0;
@@ -209,6 +232,88 @@ namespace casual
          };
 
 
+         namespace service
+         {
+            //!
+            //! How to choose among idle instances
+            //!
+            enum class Routing
+            {
+               //! the next idle instance, in pid order, after the last one we chose
+               round_robin,
+               //! the instance that has been idle for the longest time (least recently used)
+               lru,
+               //! the instance with fewest invocations
+               least_invoked
+            };
+
+            //!
+            //! @return routing from configuration name, "round-robin", "lru" or "least-invoked"
+            //! @throws common::exception::invalid::Argument if name is unknown
+            //!
+            Routing routing( const std::string& name);
+
+            std::ostream& operator << ( std::ostream& out, Routing value);
+
+            //!
+            //! Idle instances of a service, ordered so the next one (given the routing)
+            //! is found without scanning all instances
+            //!
+            class Idle
+            {
+            public:
+               using pid_type = common::platform::pid_type;
+
+               //!
+               //! Adds @p instance, if not already added
+               //!
+               void add( Server::Instance& instance, Routing routing);
+               void remove( const Server::Instance& instance);
+
+               //!
+               //! @return the next instance to use, or nullptr if there are no idle instances
+               //!
+               Server::Instance* next( Routing routing);
+
+               std::size_t size() const { return m_instances.size();}
+               bool empty() const { return m_instances.empty();}
+
+            private:
+               using key_type = std::pair< std::uint64_t, std::uint64_t>;
+
+               std::map< key_type, std::reference_wrapper< Server::Instance>> m_instances;
+               std::unordered_map< pid_type, key_type> m_keys;
+
+               std::uint64_t m_sequence = 0;
+               pid_type m_cursor = 0;
+            };
+
+            //!
+            //! A lookup request that waits for an idle instance
+            //!
+            struct Pending
+            {
+               Pending( common::message::service::lookup::Request request, const common::platform::time_point& deadline, std::uint64_t order)
+                  : request( std::move( request)), deadline( deadline), order( order) {}
+
+               common::message::service::lookup::Request request;
+
+               //!
+               //! when the caller has given up, time_point::max() if never
+               //!
+               common::platform::time_point deadline;
+
+               //!
+               //! arrival order among all pending requests, so an instance with several services
+               //! takes the oldest request
+               //!
+               std::uint64_t order;
+
+               bool expired( const common::platform::time_point& now) const { return deadline < now;}
+            };
+
+         } // service
+
          struct Service
          {
             Service( const std::string& name) : information( name) {}
@@ -219,6 +324,15 @@ namespace casual
             std::size_t lookedup = 0;
             std::vector< std::reference_wrapper< Server::Instance>> instances;
 
+            service::Routing routing = service::Routing::round_robin;
+            service::Idle idle;
+
+            //!
+            //! Lookups that waits for an idle instance, in arrival order (and hence deadline order, since
+            //! the deadline is given by the service timeout)
+            //!
+            std::deque< service::Pending> pending;
+
             void remove( const Server::Instance& instance);
 
             friend bool operator == ( const Service& lhs, const Service& rhs) { return lhs.information.name == rhs.information.name;}
@@ -253,7 +367,6 @@ namespace casual
          typedef std::unordered_map< state::Executable::id_type, state::Executable> executable_mapping_type;
          typedef std::unordered_map< state::Server::pid_type, state::Server::Instance> instance_mapping_type;
          typedef std::unordered_map< std::string, state::Service> service_mapping_type;
-         typedef std::deque< common::message::service::lookup::Request> pending_requests_type;
 
 
 
@@ -270,7 +383,11 @@ namespace casual
 
          struct pending_t
          {
-            pending_requests_type requests;
+            //!
+            //! Next order for pending lookups, the lookups are kept by the service
+            //!
+            std::uint64_t order = 0;
+
             std::vector< common::message::pending::Message> replies;
             std::vector< common::message::lookup::process::Request> process_lookup;
          } pending;
@@ -286,6 +403,17 @@ namespace casual
 
 
 
+         struct reservation_t
+         {
+            //!
+            //! How long a caller has to release a revoked reservation before we take the
+            //! instance back. The caller only sees the revoke when it calls again (or in
+            //! its message pump), hence it might never release it by it self.
+            //!
+            std::chrono::microseconds reclaim = std::chrono::seconds{ 1};
+
+         } reservation;
+
          struct traffic_t
          {
             std::vector< common::platform::queue_id_type> monitors;
@@ -169,6 +169,7 @@ namespace casual
                         case admin::InstanceVO::State::booted: out << terminal::color::magenta.start() << '^'; break;
                         case admin::InstanceVO::State::idle: out << terminal::color::green.start() << '+'; break;
                         case admin::InstanceVO::State::busy: out << terminal::color::yellow.start() << '*'; break;
+                        case admin::InstanceVO::State::reserved: out << terminal::color::cyan.start() << '~'; break;
                         case admin::InstanceVO::State::shutdown: out << terminal::color::red.start() << 'x'; break;
                         default: out << terminal::color::red.start() <<  '-'; break;
                      }
@@ -184,6 +185,7 @@ namespace casual
                         case admin::InstanceVO::State::booted: out << '^'; break;
                         case admin::InstanceVO::State::idle: out << '+'; break;
                         case admin::InstanceVO::State::busy: out << '*'; break;
+                        case admin::InstanceVO::State::reserved: out << '~'; break;
                         case admin::InstanceVO::State::shutdown: out << 'x'; break;
                         default: out <<  '-'; break;
                      }
@@ -388,6 +390,7 @@ namespace casual
                   {
                      case admin::InstanceVO::State::booted: return 6;
                      case admin::InstanceVO::State::shutdown: return 8;
+                     case admin::InstanceVO::State::reserved: return 8;
                      default: return 4;
                   }
                }
@@ -403,6 +406,7 @@ namespace casual
                         case admin::InstanceVO::State::booted: out << std::right << std::setw( width) << terminal::color::red << "booted"; break;
                         case admin::InstanceVO::State::idle: out << std::right << std::setw( width) << terminal::color::green << "idle"; break;
                         case admin::InstanceVO::State::busy: out << std::right << std::setw( width) << terminal::color::yellow << "busy"; break;
+                        case admin::InstanceVO::State::reserved: out << std::right << std::setw( width) << terminal::color::cyan << "reserved"; break;
                         case admin::InstanceVO::State::shutdown: out << std::right << std::setw( width) << terminal::color::red << "shutdown"; break;
                      }
                   }
@@ -413,6 +417,7 @@ namespace casual
                         case admin::InstanceVO::State::booted: out << std::right << std::setw( width) << "booted"; break;
                         case admin::InstanceVO::State::idle: out << std::right << std::setw( width) << "idle"; break;
                         case admin::InstanceVO::State::busy: out << std::right << std::setw( width) << "busy"; break;
+                        case admin::InstanceVO::State::reserved: out << std::right << std::setw( width) << "reserved"; break;
                         case admin::InstanceVO::State::shutdown: out  << std::right << std::setw( width) << "shutdown"; break;
                      }
                   }
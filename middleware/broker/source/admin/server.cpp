@@ -197,8 +197,13 @@ namespace broker
          }
 
          {
-            common::range::transform( state.pending.requests, result.pending,
-                  admin::transform::Pending{});
+            for( auto& service : state.services)
+            {
+               for( auto& pending : service.second.pending)
+               {
+                  result.pending.push_back( admin::transform::Pending{}( pending.request));
+               }
+            }
          }
 
          return result;
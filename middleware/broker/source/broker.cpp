@@ -13,6 +13,7 @@
 
 #include "config/domain.h"
 
+#include "common/communication/ipc.h"
 #include "common/environment.h"
 
 #include "common/internal/trace.h"
@@ -21,6 +22,7 @@
 #include "common/message/dispatch.h"
 #include "common/message/handle.h"
 #include "common/process.h"
+#include "common/signal.h"
 
 
 #include "sf/log.h"
@@ -201,6 +203,20 @@ namespace casual
 
             auto start = common::platform::clock_type::now();
 
+            {
+               //
+               // Remove segments that are owned by ipc-queues that are gone. The owner has
+               // died before the queue was removed, most likely the last time the domain was up
+               //
+               for( auto owner : communication::message::segment::owners())
+               {
+                  if( owner >= 0 && ! communication::ipc::exists( owner))
+                  {
+                     communication::message::segment::clear( owner);
+                  }
+               }
+            }
+
 
             {
                common::trace::internal::Scope trace( "boot domain");
@@ -258,7 +274,25 @@ namespace casual
                {
                   if( state.pending.replies.empty())
                   {
-                     handler( ipc::device().blocking_next());
+                     common::communication::message::Complete message;
+
+                     try
+                     {
+                        //
+                        // Make sure we wake up to take back revoked reservations that the
+                        // callers has not released in time
+                        //
+                        common::signal::timer::Scoped timeout{ handle::reservation::timeout( state)};
+
+                        message = ipc::device().blocking_next();
+                     }
+                     catch( const common::exception::signal::Timeout&)
+                     {
+                        handle::reservation::reclaim( state);
+                        continue;
+                     }
+
+                     handler( message);
                   }
                   else
                   {
@@ -299,6 +333,8 @@ namespace casual
                            ;
                      }
 
+                     handle::reservation::reclaim( state);
+
                   }
                }
 
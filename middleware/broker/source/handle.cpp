@@ -250,9 +250,159 @@ namespace casual
 
                } // handle
 
+               namespace reservation
+               {
+                  //!
+                  //! Sends a revoke to the caller that has reserved the instance
+                  //!
+                  void revoke( State& state, state::Server::Instance& instance, common::message::service::lookup::Revoke::Reason reason)
+                  {
+                     using Reason = common::message::service::lookup::Revoke::Reason;
+
+                     if( instance.state != state::Server::Instance::State::reserved
+                           || ( instance.revoked && reason != Reason::deceased))
+                     {
+                        return;
+                     }
+
+                     instance.revoked = true;
+                     instance.reclaim = platform::clock_type::now() + state.reservation.reclaim;
+
+                     common::message::service::lookup::Revoke message;
+                     message.process = instance.process;
+                     message.reason = reason;
+
+                     if( ! ipc::device().non_blocking_send( instance.caller.queue, message))
+                     {
+                        state.pending.replies.emplace_back( message, instance.caller.queue);
+                     }
+                  }
+
+                  void revoke( State& state, common::message::service::lookup::Revoke::Reason reason)
+                  {
+                     for( auto& instance : state.instances)
+                     {
+                        revoke( state, instance.second, reason);
+                     }
+                  }
+
+               } // reservation
+
+               namespace instance
+               {
+                  //!
+                  //! The instance is ready for new calls, if there are pending request for services that
+                  //! this instance has, we use it directly
+                  //!
+                  void idle( State& state, state::Server::Instance& instance)
+                  {
+                     instance.alterState( state::Server::Instance::State::idle);
+                     instance.caller = common::process::Handle{};
+                     instance.revoked = false;
+                     instance.reclaim = platform::time_point::max();
+                     instance.reclaiming = false;
+
+                     //
+                     // Take the oldest pending request among the services of the instance, and
+                     // drop the ones the caller has already given up on
+                     //
+                     auto now = platform::clock_type::now();
+
+                     state::Service* oldest = nullptr;
+
+                     for( auto& service : instance.services)
+                     {
+                        auto& pending = service.get().pending;
+
+                        while( ! pending.empty() && pending.front().expired( now))
+                        {
+                           log::internal::debug << "pending lookup expired - service: " << pending.front().request.requested
+                                 << " caller: " << pending.front().request.process << " - action: discard\n";
+                           pending.pop_front();
+                        }
+
+                        if( ! pending.empty() && ( ! oldest || pending.front().order < oldest->pending.front().order))
+                        {
+                           oldest = &service.get();
+                        }
+                     }
+
+                     if( oldest)
+                     {
+                        //
+                        // We now know that there are one idle server that has advertised the
+                        // requested service (we've just marked it as idle...).
+                        // We can use the normal request to get the response
+                        //
+                        auto request = std::move( oldest->pending.front().request);
+                        oldest->pending.pop_front();
+
+                        ServiceLookup lookup( state);
+                        lookup( request);
+                     }
+                  }
+
+               } // instance
+
             } // <unnamed>
          } // local
 
+         namespace reservation
+         {
+            std::chrono::microseconds timeout( const State& state)
+            {
+               auto deadline = platform::time_point::max();
+
+               for( auto& instance : state.instances)
+               {
+                  if( instance.second.state == state::Server::Instance::State::reserved && instance.second.revoked)
+                  {
+                     deadline = std::min( deadline, instance.second.reclaim);
+                  }
+               }
+
+               if( deadline == platform::time_point::max())
+               {
+                  return std::chrono::microseconds::min();
+               }
+
+               return std::max(
+                     std::chrono::duration_cast< std::chrono::microseconds>( deadline - platform::clock_type::now()),
+                     std::chrono::microseconds::zero());
+            }
+
+            void reclaim( State& state)
+            {
+               auto now = platform::clock_type::now();
+
+               for( auto& instance : state.instances)
+               {
+                  if( instance.second.state == state::Server::Instance::State::reserved
+                        && instance.second.revoked && instance.second.reclaim <= now)
+                  {
+                     log::internal::debug << "reservation not released - instance: " << instance.second.process
+                           << " caller: " << instance.second.caller << " - action: ping instance and reclaim on reply\n";
+
+                     //
+                     // The instance might still serve a call from the caller. It stays reserved
+                     // until it has replied the ping, and is done with the calls sent before it
+                     //
+                     instance.second.reclaim = platform::time_point::max();
+                     instance.second.reclaiming = true;
+
+                     common::message::server::ping::Request request;
+                     request.process = common::process::handle();
+
+                     if( ! ipc::device().non_blocking_send( instance.second.process.queue, request))
+                     {
+                        state.pending.replies.emplace_back( request, instance.second.process.queue);
+                     }
+                  }
+               }
+            }
+
+         } // reservation
+
          void boot( State& state)
          {
 
@@ -403,6 +553,11 @@ namespace casual
                   if( ! range::find( m_state.traffic.monitors, message.process.queue))
                   {
                      m_state.traffic.monitors.push_back( message.process.queue);
+
+                     //
+                     // Callers with reservations have the old monitors
+                     //
+                     local::reservation::revoke( m_state, common::message::service::lookup::Revoke::Reason::changed);
                   }
                   else
                   {
@@ -421,6 +576,8 @@ namespace casual
                if( found)
                {
                   m_state.traffic.monitors.erase( std::begin( found));
+
+                  local::reservation::revoke( m_state, common::message::service::lookup::Revoke::Reason::changed);
                }
                else
                {
@@ -594,7 +751,26 @@ namespace casual
                         }
                      }
 
-                     auto& server = m_state.getServer( m_state.getInstance( event.death.pid).server);
+                     //
+                     // Hand back the instances the deceased has reserved
+                     //
+                     for( auto& instance : m_state.instances)
+                     {
+                        if( instance.second.state == state::Server::Instance::State::reserved
+                              && instance.second.caller.pid == event.death.pid)
+                        {
+                           local::instance::idle( m_state, instance.second);
+                        }
+                     }
+
+                     auto& instance = m_state.getInstance( event.death.pid);
+
+                     //
+                     // The caller that has reserved the deceased has to know
+                     //
+                     local::reservation::revoke( m_state, instance, common::message::service::lookup::Revoke::Reason::deceased);
+
+                     auto& server = m_state.getServer( instance.server);
 
                      ++server.deaths;
 
@@ -678,6 +854,9 @@ namespace casual
                common::range::transform( message.services, services, transform::Service{});
 
                m_state.removeServices( message.process.pid, std::move( services));
+
+               local::reservation::revoke( m_state, m_state.getInstance( message.process.pid),
+                     common::message::service::lookup::Revoke::Reason::unadvertised);
             }
             catch( ...)
             {
@@ -745,11 +924,9 @@ namespace casual
                auto& service = m_state.getService( message.requested);
 
                //
-               // Try to find an idle instance.
+               // Try to find an idle instance, given the routing of the service.
                //
-               auto idle = common::range::find_if(
-                     service.instances,
-                     filter::instance::Idle{});
+               auto idle = service.idle.next( service.routing);
 
                //
                // Prepare the message
@@ -766,10 +943,23 @@ namespace casual
 
                if( idle)
                {
-                  //
-                  // flag it as busy.
-                  //
-                  idle->get().alterState( state::Server::Instance::State::busy);
+                  if( message.reserve && message.context == common::message::service::lookup::Request::Context::regular)
+                  {
+                     //
+                     // The caller calls the instance directly until we revoke the reservation
+                     //
+                     idle->alterState( state::Server::Instance::State::reserved);
+                     idle->caller = message.process;
+                     idle->revoked = false;
+                     reply.reserved = true;
+                  }
+                  else
+                  {
+                     //
+                     // flag it as busy.
+                     //
+                     idle->alterState( state::Server::Instance::State::busy);
+                  }
 
                   reply.state = decltype( reply.state)::idle;
                   reply.process = transform::Instance()( *idle);
@@ -801,7 +991,28 @@ namespace casual
                   //
                   // All instances are busy, we stack the request
                   //
-                  m_state.pending.requests.push_back( std::move( message));
+                  {
+                     //
+                     // Only callers that have a deadline of their own gives up, the rest
+                     // (TPNOTIME, forward cache, ...) waits until an instance is idle
+                     //
+                     auto deadline = platform::time_point::max();
+
+                     if( message.expire && service.information.timeout != std::chrono::microseconds::zero())
+                     {
+                        deadline = platform::clock_type::now() + service.information.timeout;
+                     }
+
+                     service.pending.emplace_back( std::move( message), deadline, m_state.pending.order++);
+                  }
+
+                  //
+                  // Ask callers that have reserved instances to hand them back
+                  //
+                  for( auto& instance : service.instances)
+                  {
+                     local::reservation::revoke( m_state, instance, common::message::service::lookup::Revoke::Reason::pending);
+                  }
 
                   //
                   // ...and send busy-message to caller, to set timeouts and stuff
@@ -836,42 +1047,85 @@ namespace casual
             {
                auto& instance = m_state.getInstance( message.process.pid);
 
-               instance.alterState( state::Server::Instance::State::idle);
                ++instance.invoked;
 
-               //
-               // Check if there are pending request for services that this
-               // instance has.
-               //
+               if( instance.state == state::Server::Instance::State::reserved)
+               {
+                  //
+                  // The caller owns the instance, it's not idle until it's released
+                  //
+                  return;
+               }
+
+               local::instance::idle( m_state, instance);
+            }
+            catch( state::exception::Missing& exception)
+            {
+               common::log::error << "failed to find instance on ACK - indicate inconsistency " << exception.what() <<std::endl;
+            }
+         }
+
+
+         namespace lookup
+         {
+            void Release::operator () ( message_type& message)
+            {
+               common::trace::internal::Scope trace{ "broker::handle::lookup::Release"};
+
+               try
                {
-                  auto pending = common::range::find_if(
-                     m_state.pending.requests,
-                     filter::Pending( instance));
+                  auto& instance = m_state.getInstance( message.instance.pid);
 
-                  if( pending)
+                  if( instance.state != state::Server::Instance::State::reserved || instance.caller.pid != message.process.pid)
                   {
+                     common::log::internal::debug << "instance: " << message.instance << " is not reserved by: " << message.process << " - action: ignore\n";
+                     return;
+                  }
 
-                     //
-                     // We now know that there are one idle server that has advertised the
-                     // requested service (we've just marked it as idle...).
-                     // We can use the normal request to get the response
-                     //
-                     ServiceLookup lookup( m_state);
-                     lookup( *pending);
+                  //
+                  // The instance has ACK:ed every call, so invoked is already counted
+                  //
+                  local::instance::idle( m_state, instance);
+               }
+               catch( state::exception::Missing& exception)
+               {
+                  //
+                  // The instance has died, and the caller has not got the revoke yet
+                  //
+                  common::log::internal::debug << "released instance: " << message.instance << " is gone - action: ignore\n";
+               }
+            }
+
+         } // lookup
+
+         namespace reservation
+         {
+            void Reclaimed::operator () ( message_type& message)
+            {
+               common::trace::internal::Scope trace{ "broker::handle::reservation::Reclaimed"};
+
+               try
+               {
+                  auto& instance = m_state.getInstance( message.process.pid);
 
+                  if( instance.state != state::Server::Instance::State::reserved || ! instance.reclaiming)
+                  {
                      //
-                     // Remove pending
+                     // The caller released the instance before the ping reply came
                      //
-                     m_state.pending.requests.erase( std::begin( pending));
+                     common::log::internal::debug << "instance: " << message.process << " is not reclaimed - action: ignore\n";
+                     return;
                   }
 
+                  local::instance::idle( m_state, instance);
+               }
+               catch( state::exception::Missing& exception)
+               {
+                  common::log::internal::debug << "reclaimed instance: " << message.process << " is gone - action: ignore\n";
                }
             }
-            catch( state::exception::Missing& exception)
-            {
-               common::log::error << "failed to find instance on ACK - indicate inconsistency " << exception.what() <<std::endl;
-            }
-         }
+
+         } // reservation
 
 
          void Policy::connect( common::communication::ipc::inbound::Device& ipc, std::vector< common::message::Service> services, const std::vector< common::transaction::Resource>& resources)
@@ -934,6 +1188,8 @@ namespace casual
             handle::Unadvertise{ state},
             handle::ServiceLookup{ state},
             handle::ACK{ state},
+            handle::lookup::Release{ state},
+            handle::reservation::Reclaimed{ state},
             handle::traffic::Connect{ state},
             handle::traffic::Disconnect{ state},
             handle::transaction::client::Connect{ state},
@@ -957,6 +1213,8 @@ namespace casual
             handle::Unadvertise{ state},
             handle::ServiceLookup{ state},
             handle::ACK{ state},
+            handle::lookup::Release{ state},
+            handle::reservation::Reclaimed{ state},
             handle::traffic::Connect{ state},
             handle::traffic::Disconnect{ state},
             handle::transaction::client::Connect{ state},
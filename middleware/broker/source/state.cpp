@@ -71,6 +71,27 @@ namespace casual
             }
          }
 
+         void Server::Instance::alterState( State state)
+         {
+            if( this->state != State::idle && state == State::idle)
+            {
+               for( auto& service : services)
+               {
+                  service.get().idle.add( *this, service.get().routing);
+               }
+            }
+            else if( this->state == State::idle && state != State::idle)
+            {
+               for( auto& service : services)
+               {
+                  service.get().idle.remove( *this);
+               }
+            }
+
+            this->state = state;
+            last = common::platform::clock_type::now();
+         }
+
          void Service::remove( const Server::Instance& instance)
          {
             auto found = range::find( instances, instance);
@@ -80,8 +101,91 @@ namespace casual
                instances.erase( std::begin( found));
             }
 
+            idle.remove( instance);
          }
 
+         namespace service
+         {
+            Routing routing( const std::string& name)
+            {
+               if( name.empty() || name == "round-robin") { return Routing::round_robin;}
+               if( name == "lru") { return Routing::lru;}
+               if( name == "least-invoked") { return Routing::least_invoked;}
+
+               throw common::exception::invalid::Argument{ "unknown service routing", CASUAL_NIP( name)};
+            }
+
+            std::ostream& operator << ( std::ostream& out, Routing value)
+            {
+               switch( value)
+               {
+                  case Routing::round_robin: return out << "round-robin";
+                  case Routing::lru: return out << "lru";
+                  case Routing::least_invoked: return out << "least-invoked";
+               }
+               return out << "unknown";
+            }
+
+            void Idle::add( Server::Instance& instance, Routing routing)
+            {
+               if( m_keys.count( instance.process.pid) > 0)
+               {
+                  return;
+               }
+
+               //
+               // The key orders the instances so the one to use next is first (or, for
+               // round-robin, found with upper_bound on the last chosen pid)
+               //
+               key_type key;
+
+               switch( routing)
+               {
+                  case Routing::round_robin: key = key_type{ 0, instance.process.pid}; break;
+                  case Routing::lru: key = key_type{ m_sequence++, 0}; break;
+                  case Routing::least_invoked: key = key_type{ instance.invoked, m_sequence++}; break;
+               }
+
+               m_instances.emplace( key, instance);
+               m_keys.emplace( instance.process.pid, key);
+            }
+
+            void Idle::remove( const Server::Instance& instance)
+            {
+               auto found = m_keys.find( instance.process.pid);
+
+               if( found != std::end( m_keys))
+               {
+                  m_instances.erase( found->second);
+                  m_keys.erase( found);
+               }
+            }
+
+            Server::Instance* Idle::next( Routing routing)
+            {
+               if( m_instances.empty())
+               {
+                  return nullptr;
+               }
+
+               auto found = std::begin( m_instances);
+
+               if( routing == Routing::round_robin)
+               {
+                  found = m_instances.upper_bound( key_type{ 0, m_cursor});
+
+                  if( found == std::end( m_instances))
+                  {
+                     found = std::begin( m_instances);
+                  }
+                  m_cursor = found->second.get().process.pid;
+               }
+
+               return &found->second.get();
+            }
+
+         } // service
+
 
          bool operator == ( const Group& lhs, const Group& rhs) { return lhs.id == rhs.id;}
 
@@ -227,6 +331,7 @@ namespace casual
                }
                service.information.type = s.information.type;
                service.information.transaction = s.information.transaction;
+               service.routing = standard.service.routing;
             }
 
             service.instances.push_back( instance);
@@ -234,6 +339,11 @@ namespace casual
 
             instance.services.push_back( service);
             range::trim( instance.services, range::unique( range::sort( instance.services)));;
+
+            if( instance.state == state::Server::Instance::State::idle)
+            {
+               service.idle.add( instance, service.routing);
+            }
          }
       }
 
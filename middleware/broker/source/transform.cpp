@@ -82,6 +82,7 @@ namespace casual
 
                result.information.name = service.name;
                result.information.timeout = common::chronology::from::string( service.timeout);
+               result.routing = state::service::routing( service.routing);
 
                return result;
             }
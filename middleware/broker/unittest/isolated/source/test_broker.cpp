@@ -17,6 +17,8 @@
 #include "common/mockup/ipc.h"
 #include "common/message/type.h"
 
+#include <thread>
+
 
 namespace casual
 {
@@ -108,7 +110,6 @@ namespace casual
                domain_3() : server2{ 20}
                {
                   auto& instance = state.getInstance( server1.process().pid);
-                  instance.state = state::Server::Instance::State::idle;
 
                   {
                      auto& service = state.add( state::Service{ "service1"});
@@ -121,6 +122,8 @@ namespace casual
                      service.instances.emplace_back( instance);
                      instance.services.emplace_back( service);
                   }
+
+                  instance.alterState( state::Server::Instance::State::idle);
                }
 
                state::Server::Instance& instance1() { return state.getInstance( server1.process().pid);}
@@ -350,7 +353,7 @@ namespace casual
       TEST( casual_broker, service_lookup_service1__expect__busy_reply__pending_reply)
       {
          local::domain_3 domain;
-         domain.instance1().state = state::Server::Instance::State::busy;
+         domain.instance1().alterState( state::Server::Instance::State::busy);
 
          {
             local::Broker broker{ domain.state};
@@ -368,15 +371,15 @@ namespace casual
             EXPECT_FALSE( static_cast< bool>( reply.process)) << "process: " <<  reply.process;
             EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::busy);
          }
-         ASSERT_TRUE( domain.state.pending.requests.size() == 1);
-         EXPECT_TRUE( domain.state.pending.requests.at( 0).process == domain.server2.process());
+         ASSERT_TRUE( domain.state.getService( "service1").pending.size() == 1);
+         EXPECT_TRUE( domain.state.getService( "service1").pending.at( 0).request.process == domain.server2.process());
       }
 
 
       TEST( casual_broker, service_lookup_service1__forward_context___expect__forward_reply)
       {
          local::domain_4 domain;
-         domain.instance1().state = state::Server::Instance::State::busy;
+         domain.instance1().alterState( state::Server::Instance::State::busy);
 
          {
             local::Broker broker{ domain.state};
@@ -396,7 +399,7 @@ namespace casual
             EXPECT_TRUE( reply.process == domain.state.forward) << "process: " <<  reply.process;
             EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::idle);
          }
-         EXPECT_TRUE( domain.state.pending.requests.empty());
+         EXPECT_TRUE( domain.state.getService( "service1").pending.empty());
       }
 
 
@@ -426,8 +429,8 @@ namespace casual
             EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::busy);
          }
 
-         ASSERT_TRUE( domain.state.pending.requests.size() == 1);
-         EXPECT_TRUE( domain.state.pending.requests.at( 0).process == domain.server2.process());
+         ASSERT_TRUE( domain.state.getService( "service1").pending.size() == 1);
+         EXPECT_TRUE( domain.state.getService( "service1").pending.at( 0).request.process == domain.server2.process());
 
          {
             local::Broker broker{ domain.state};
@@ -456,6 +459,350 @@ namespace casual
 
       }
 
+      TEST( casual_broker, service_lookup_service1__busy__pending_expires__service_ACK__expect_no_reply)
+      {
+         local::domain_3 domain;
+         domain.instance1().alterState( state::Server::Instance::State::busy);
+         domain.state.getService( "service1").information.timeout = std::chrono::microseconds{ 1};
+
+         {
+            local::Broker broker{ domain.state};
+
+            common::message::service::lookup::Request request;
+            request.process = domain.server2.process();
+            request.requested = "service1";
+            request.expire = true;
+
+            communication::ipc::blocking::send( broker.queue_id, request);
+
+            common::message::service::lookup::Reply reply;
+            communication::ipc::blocking::receive( domain.server2.output(), reply);
+            EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::busy);
+         }
+
+         ASSERT_TRUE( domain.state.getService( "service1").pending.size() == 1);
+
+         std::this_thread::sleep_for( std::chrono::milliseconds{ 1});
+
+         {
+            local::Broker broker{ domain.state};
+
+            common::message::service::call::ACK ack;
+            ack.process = domain.server1.process();
+            ack.service = "service1";
+
+            communication::ipc::blocking::send( broker.queue_id, ack);
+         }
+
+         EXPECT_TRUE( domain.state.getService( "service1").pending.empty());
+         EXPECT_TRUE( domain.instance1().state == state::Server::Instance::State::idle);
+
+         common::message::service::lookup::Reply reply;
+         EXPECT_FALSE( communication::ipc::non::blocking::receive( domain.server2.output(), reply));
+      }
+
+      TEST( casual_broker, service_lookup_service1__busy__no_caller_deadline__service_timeout_passed__service_ACK__expect_idle_reply)
+      {
+         local::domain_3 domain;
+         domain.instance1().alterState( state::Server::Instance::State::busy);
+         domain.state.getService( "service1").information.timeout = std::chrono::microseconds{ 1};
+
+         {
+            local::Broker broker{ domain.state};
+
+            //
+            // Same as the forward cache does, no deadline of its own
+            //
+            common::message::service::lookup::Request request;
+            request.process = domain.server2.process();
+            request.requested = "service1";
+
+            communication::ipc::blocking::send( broker.queue_id, request);
+
+            common::message::service::lookup::Reply reply;
+            communication::ipc::blocking::receive( domain.server2.output(), reply);
+            EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::busy);
+         }
+
+         std::this_thread::sleep_for( std::chrono::milliseconds{ 1});
+
+         {
+            local::Broker broker{ domain.state};
+
+            common::message::service::call::ACK ack;
+            ack.process = domain.server1.process();
+            ack.service = "service1";
+
+            communication::ipc::blocking::send( broker.queue_id, ack);
+         }
+
+         EXPECT_TRUE( domain.state.getService( "service1").pending.empty());
+
+         common::message::service::lookup::Reply reply;
+         communication::ipc::blocking::receive( domain.server2.output(), reply);
+         EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::idle);
+         EXPECT_TRUE( reply.process == domain.server1.process());
+      }
+
+      TEST( casual_broker, service_lookup_service1__reserved__caller_does_not_release__reclaim__expect_pending_lookup_served)
+      {
+         local::domain_3 domain;
+         mockup::ipc::Instance caller{ 30};
+
+         domain.instance1().alterState( state::Server::Instance::State::reserved);
+         domain.instance1().caller = caller.process();
+
+         EXPECT_TRUE( handle::reservation::timeout( domain.state) == std::chrono::microseconds::min());
+
+         {
+            local::Broker broker{ domain.state};
+
+            common::message::service::lookup::Request request;
+            request.process = domain.server2.process();
+            request.requested = "service1";
+
+            communication::ipc::blocking::send( broker.queue_id, request);
+
+            common::message::service::lookup::Reply reply;
+            communication::ipc::blocking::receive( domain.server2.output(), reply);
+            EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::busy);
+         }
+
+         common::message::service::lookup::Revoke revoke;
+         communication::ipc::blocking::receive( caller.output(), revoke);
+         EXPECT_TRUE( revoke.process == domain.server1.process());
+         EXPECT_TRUE( revoke.reason == common::message::service::lookup::Revoke::Reason::pending);
+
+         ASSERT_TRUE( domain.instance1().revoked);
+         EXPECT_TRUE( handle::reservation::timeout( domain.state) > std::chrono::microseconds::zero());
+
+         //
+         // The caller has not released in time, the instance might still serve it, so we ping
+         //
+         domain.instance1().reclaim = platform::clock_type::now();
+         handle::reservation::reclaim( domain.state);
+
+         EXPECT_TRUE( domain.instance1().state == state::Server::Instance::State::reserved);
+         EXPECT_TRUE( domain.state.getService( "service1").pending.size() == 1);
+         EXPECT_TRUE( handle::reservation::timeout( domain.state) == std::chrono::microseconds::min());
+
+         common::message::server::ping::Request ping;
+         communication::ipc::blocking::receive( domain.server1.output(), ping);
+
+         {
+            local::Broker broker{ domain.state};
+
+            //
+            // The ACK of the caller's call in flight, still ours
+            //
+            common::message::service::call::ACK ack;
+            ack.process = domain.server1.process();
+            ack.service = "service1";
+            communication::ipc::blocking::send( broker.queue_id, ack);
+
+            //
+            // ...and then the ping reply, the instance is done with the caller
+            //
+            auto pong = common::message::reverse::type( ping);
+            pong.process = domain.server1.process();
+            communication::ipc::blocking::send( broker.queue_id, pong);
+         }
+
+         EXPECT_TRUE( domain.state.getService( "service1").pending.empty());
+         EXPECT_TRUE( domain.instance1().state == state::Server::Instance::State::busy);
+         EXPECT_FALSE( domain.instance1().reclaiming);
+
+         common::message::service::lookup::Reply reply;
+         communication::ipc::blocking::receive( domain.server2.output(), reply);
+         EXPECT_TRUE( reply.state == common::message::service::lookup::Reply::State::idle);
+         EXPECT_TRUE( reply.process == domain.server1.process());
+      }
+
+      TEST( casual_broker, reserved__reclaim__caller_releases__ping_reply__expect_ignored)
+      {
+         local::domain_3 domain;
+         mockup::ipc::Instance caller{ 30};
+
+         domain.instance1().alterState( state::Server::Instance::State::reserved);
+         domain.instance1().caller = caller.process();
+         domain.instance1().revoked = true;
+         domain.instance1().reclaim = platform::clock_type::now();
+
+         handle::reservation::reclaim( domain.state);
+
+         common::message::server::ping::Request ping;
+         communication::ipc::blocking::receive( domain.server1.output(), ping);
+
+         {
+            local::Broker broker{ domain.state};
+
+            common::message::service::lookup::Release release;
+            release.process = caller.process();
+            release.instance = domain.server1.process();
+            communication::ipc::blocking::send( broker.queue_id, release);
+         }
+
+         EXPECT_TRUE( domain.instance1().state == state::Server::Instance::State::idle);
+
+         //
+         // Some one else gets the instance before the ping reply arrives
+         //
+         domain.instance1().alterState( state::Server::Instance::State::busy);
+
+         {
+            local::Broker broker{ domain.state};
+
+            auto pong = common::message::reverse::type( ping);
+            pong.process = domain.server1.process();
+            communication::ipc::blocking::send( broker.queue_id, pong);
+         }
+
+         EXPECT_TRUE( domain.instance1().state == state::Server::Instance::State::busy);
+      }
+
+      TEST( casual_broker, service_lookup_service1__busy__TPNOTIME_pending__expect_no_deadline)
+      {
+         local::domain_3 domain;
+         domain.instance1().alterState( state::Server::Instance::State::busy);
+         domain.state.getService( "service1").information.timeout = std::chrono::microseconds{ 1};
+
+         {
+            local::Broker broker{ domain.state};
+
+            common::message::service::lookup::Request request;
+            request.process = domain.server2.process();
+            request.requested = "service1";
+            request.expire = false;
+
+            communication::ipc::blocking::send( broker.queue_id, request);
+
+            common::message::service::lookup::Reply reply;
+            communication::ipc::blocking::receive( domain.server2.output(), reply);
+         }
+
+         ASSERT_TRUE( domain.state.getService( "service1").pending.size() == 1);
+         EXPECT_TRUE( domain.state.getService( "service1").pending.front().deadline == platform::time_point::max());
+      }
+
+      namespace local
+      {
+         namespace
+         {
+            std::vector< state::Server::Instance> instances( std::vector< platform::pid_type> pids)
+            {
+               std::vector< state::Server::Instance> result;
+
+               for( auto pid : pids)
+               {
+                  state::Server::Instance instance;
+                  instance.process.pid = pid;
+                  result.push_back( std::move( instance));
+               }
+               return result;
+            }
+         } // <unnamed>
+      } // local
+
+      TEST( casual_broker, service_routing__names)
+      {
+         EXPECT_TRUE( state::service::routing( "round-robin") == state::service::Routing::round_robin);
+         EXPECT_TRUE( state::service::routing( "") == state::service::Routing::round_robin);
+         EXPECT_TRUE( state::service::routing( "lru") == state::service::Routing::lru);
+         EXPECT_TRUE( state::service::routing( "least-invoked") == state::service::Routing::least_invoked);
+         EXPECT_THROW({
+            state::service::routing( "first");
+         }, common::exception::invalid::Argument);
+      }
+
+      TEST( casual_broker, service_idle_round_robin__3_instances__expect_cyclic)
+      {
+         auto instances = local::instances( { 1, 2, 3});
+         auto routing = state::service::Routing::round_robin;
+
+         state::service::Idle idle;
+
+         for( auto& instance : instances)
+         {
+            idle.add( instance, routing);
+         }
+
+         std::vector< platform::pid_type> chosen;
+
+         for( auto count = 6; count > 0; --count)
+         {
+            auto next = idle.next( routing);
+            ASSERT_TRUE( next != nullptr);
+            chosen.push_back( next->process.pid);
+
+            //
+            // busy and idle again
+            //
+            idle.remove( *next);
+            idle.add( *next, routing);
+         }
+
+         EXPECT_TRUE( ( chosen == std::vector< platform::pid_type>{ 1, 2, 3, 1, 2, 3})) << range::make( chosen);
+      }
+
+      TEST( casual_broker, service_idle_lru__expect_longest_idle)
+      {
+         auto instances = local::instances( { 1, 2, 3});
+         auto routing = state::service::Routing::lru;
+
+         state::service::Idle idle;
+
+         idle.add( instances.at( 2), routing);
+         idle.add( instances.at( 0), routing);
+         idle.add( instances.at( 1), routing);
+
+         EXPECT_TRUE( idle.next( routing)->process.pid == 3);
+
+         idle.remove( instances.at( 2));
+         EXPECT_TRUE( idle.next( routing)->process.pid == 1);
+
+         idle.add( instances.at( 2), routing);
+         idle.remove( instances.at( 0));
+         EXPECT_TRUE( idle.next( routing)->process.pid == 2);
+      }
+
+      TEST( casual_broker, service_idle_least_invoked__expect_fewest_invocations)
+      {
+         auto instances = local::instances( { 1, 2, 3});
+         instances.at( 0).invoked = 5;
+         instances.at( 1).invoked = 2;
+         instances.at( 2).invoked = 9;
+
+         auto routing = state::service::Routing::least_invoked;
+
+         state::service::Idle idle;
+
+         for( auto& instance : instances)
+         {
+            idle.add( instance, routing);
+         }
+
+         EXPECT_TRUE( idle.size() == 3);
+         EXPECT_TRUE( idle.next( routing)->process.pid == 2);
+
+         idle.remove( instances.at( 1));
+         EXPECT_TRUE( idle.next( routing)->process.pid == 1);
+      }
+
+      TEST( casual_broker, instance_alter_state__expect_service_idle_updated)
+      {
+         local::domain_3 domain;
+
+         auto& service = domain.state.getService( "service1");
+         EXPECT_TRUE( service.idle.size() == 1);
+
+         domain.instance1().alterState( state::Server::Instance::State::busy);
+         EXPECT_TRUE( service.idle.empty());
+         EXPECT_TRUE( service.idle.next( service.routing) == nullptr);
+
+         domain.instance1().alterState( state::Server::Instance::State::idle);
+         EXPECT_TRUE( service.idle.next( service.routing) == &domain.instance1());
+      }
+
       TEST( casual_broker, forward_connect)
       {
          local::domain_3 domain;
@@ -63,6 +63,28 @@
 #define CASUAL_FIELD_TYPE_BASE 0x2000000
 
 
+#include <stddef.h>
+
+/*
+   describes how a struct member maps to a field, see CasualFieldMappingCompile
+*/
+typedef struct
+{
+   /* the field id */
+   long id;
+   /* CASUAL_FIELD_SHORT etc, has to correspond to the id */
+   int type;
+   /* offset of the member in the struct */
+   size_t offset;
+   /* size of the member (strings are char-arrays) */
+   size_t size;
+} CasualFieldMember;
+
+/* describes a member of a struct */
+#define CASUAL_FIELD_MEMBER( structure, member, id, type) \
+   { (id), (type), offsetof( structure, member), sizeof( ((structure*)0)->member) }
+
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -200,6 +222,50 @@ int CasualFieldPrint( const char* buffer);
 /* experimental */
 int CasualFieldMatch( const char* buffer, const char* expression, int* match);
 
+/*
+   compiles an expression to be used with CasualFieldMatchExecute
+
+   The expression is evaluated directly against the field values, where
+   a predicate is a field name (or id), an optional occurrence and an
+   optional comparison with a literal, e.g.
+
+      FLD_LONG1 >= 100 && ( FLD_STRING1[0] == 'abc' || FLD_STRING2 =~ "a.*" ) && ! FLD_SHORT1
+
+   Without occurrence any occurrence may match and without comparison the
+   field just has to exist. Strings and binaries compare with text-literals
+   (=~ is regular expression match) and other types with number-literals
+   (a char may also be compared with a one-character-text-literal)
+
+   Integral literals are compared exactly with short, long and char and an
+   occurrence has to be a non-negative integer
+
+   The matcher is released with CasualFieldMatchRelease
+*/
+int CasualFieldMatchCompile( const char* expression, const void** matcher);
+/* evaluates a compiled expression against the buffer */
+int CasualFieldMatchExecute( const char* buffer, const void* matcher, int* match);
+/* releases a compiled expression */
+int CasualFieldMatchRelease( const void* matcher);
+
+
+/*
+   compiles a mapping between a struct and a buffer from members (count of them)
+
+   Several members with the same id are mapped to consecutive occurrences
+
+   Members of fixed size types (short, long, char, float, double) must have the size of the
+   native type, otherwise CASUAL_FIELD_INVALID_ARGUMENT is returned
+
+   The mapping is released with CasualFieldMappingRelease
+*/
+int CasualFieldMappingCompile( const CasualFieldMember* members, long count, const void** mapping);
+/* adds all members in source to buffer, with (at most) one reallocation (hence buffer may be changed), either all members are added or none */
+int CasualFieldMappingAdd( char** buffer, const void* mapping, const void* source);
+/* gets all members to target, members that does not occur in buffer are zeroed */
+int CasualFieldMappingGet( const char* buffer, const void* mapping, void* target);
+/* releases a compiled mapping */
+int CasualFieldMappingRelease( const void* mapping);
+
 
 
 #ifdef __cplusplus
@@ -0,0 +1,118 @@
+//
+// mapping.h
+//
+//  Created on: 18 oct 2016
+//      Author: Kristone
+//
+
+#ifndef CASUAL_BUFFER_FIELD_MAPPING_H
+#define CASUAL_BUFFER_FIELD_MAPPING_H
+
+#include "buffer/field.h"
+
+#include <type_traits>
+#include <stdexcept>
+#include <cstddef>
+
+namespace casual
+{
+   namespace buffer
+   {
+      namespace field
+      {
+         namespace mapping
+         {
+            //
+            // The field type of a member type
+            //
+            template< typename T> struct type;
+
+            template<> struct type< short> : std::integral_constant< int, CASUAL_FIELD_SHORT> {};
+            template<> struct type< long> : std::integral_constant< int, CASUAL_FIELD_LONG> {};
+            template<> struct type< char> : std::integral_constant< int, CASUAL_FIELD_CHAR> {};
+            template<> struct type< float> : std::integral_constant< int, CASUAL_FIELD_FLOAT> {};
+            template<> struct type< double> : std::integral_constant< int, CASUAL_FIELD_DOUBLE> {};
+            template< std::size_t size> struct type< char[ size]> : std::integral_constant< int, CASUAL_FIELD_STRING> {};
+
+            //
+            // Describes a member with the type deduced from the member type
+            //
+            template< typename T>
+            constexpr CasualFieldMember member( const long id, const std::size_t offset)
+            {
+               return CasualFieldMember{ id, type< T>::value, offset, sizeof( T)};
+            }
+
+            //
+            // Describes a member that is mapped as binary (the whole member)
+            //
+            template< typename T>
+            constexpr CasualFieldMember binary( const long id, const std::size_t offset)
+            {
+               return CasualFieldMember{ id, CASUAL_FIELD_BINARY, offset, sizeof( T)};
+            }
+
+            //
+            // A compiled mapping for struct S, e.g.
+            //
+            //    constexpr CasualFieldMember members[] = {
+            //       CASUAL_FIELD_MAPPING_MEMBER( S, name, FLD_NAME),
+            //       CASUAL_FIELD_MAPPING_MEMBER( S, age, FLD_AGE)};
+            //
+            //    const mapping::Mapping< S> mapping{ members};
+            //
+            //    mapping.add( buffer, s);
+            //
+            template< typename S>
+            class Mapping
+            {
+            public:
+
+               //
+               // @throw std::invalid_argument if members are invalid
+               //
+               template< std::size_t count>
+               explicit Mapping( const CasualFieldMember (&members)[ count])
+               {
+                  const auto result = CasualFieldMappingCompile( members, count, &m_mapping);
+
+                  if( result != CASUAL_FIELD_SUCCESS)
+                  {
+                     throw std::invalid_argument{ CasualFieldDescription( result)};
+                  }
+               }
+
+               ~Mapping()
+               {
+                  CasualFieldMappingRelease( m_mapping);
+               }
+
+               Mapping( const Mapping&) = delete;
+               Mapping& operator = ( const Mapping&) = delete;
+
+               int add( char*& buffer, const S& source) const
+               {
+                  return CasualFieldMappingAdd( &buffer, m_mapping, &source);
+               }
+
+               int get( const char* const buffer, S& target) const
+               {
+                  return CasualFieldMappingGet( buffer, m_mapping, &target);
+               }
+
+            private:
+               const void* m_mapping = nullptr;
+            };
+
+         } // mapping
+      } // field
+   } // buffer
+} // casual
+
+//
+// Describes a member of a struct, with the type deduced from the member
+//
+#define CASUAL_FIELD_MAPPING_MEMBER( structure, element, id) \
+   casual::buffer::field::mapping::member< decltype( structure::element)>( id, offsetof( structure, element))
+
+#endif /* CASUAL_BUFFER_FIELD_MAPPING_H */
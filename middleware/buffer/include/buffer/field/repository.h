@@ -0,0 +1,86 @@
+//
+// repository.h
+//
+//  Created on: 18 oct 2016
+//      Author: Kristone
+//
+
+#ifndef CASUAL_BUFFER_FIELD_REPOSITORY_H
+#define CASUAL_BUFFER_FIELD_REPOSITORY_H
+
+#include <unordered_map>
+#include <string>
+#include <cstddef>
+
+namespace casual
+{
+   namespace buffer
+   {
+      namespace field
+      {
+         namespace repository
+         {
+            //
+            // Parses the field table (CASUAL_FIELD_TABLE)
+            //
+            std::unordered_map<std::string,long> name_to_id();
+
+            //
+            // A precompiled repository is a binary image of the field table with
+            // perfect hashes for both names and ids, so it can be memory mapped
+            // and used as is, without any parsing or heap
+            //
+            // If CASUAL_FIELD_REPOSITORY is set the image is used instead of
+            // CASUAL_FIELD_TABLE
+            //
+            namespace image
+            {
+               //
+               // Writes the image of fields to file
+               //
+               // @throw common::exception::invalid::File if file could not be written
+               // @throw common::exception::invalid::Argument if ids are not unique
+               //
+               void write( const std::unordered_map<std::string,long>& fields, const std::string& file);
+
+               class Mapping
+               {
+               public:
+
+                  //
+                  // @throw common::exception::invalid::File if file is not a valid image
+                  //
+                  explicit Mapping( const std::string& file);
+                  ~Mapping();
+
+                  Mapping( const Mapping&) = delete;
+                  Mapping& operator = ( const Mapping&) = delete;
+
+                  //
+                  // @return id of name or CASUAL_FIELD_NO_ID if not found
+                  //
+                  long id( const char* name) const;
+
+                  //
+                  // @return name of id or nullptr if not found
+                  //
+                  const char* name( long id) const;
+
+                  std::size_t size() const;
+
+               private:
+                  const void* m_memory = nullptr;
+                  std::size_t m_size = 0;
+               };
+
+            } // image
+
+         } // repository
+
+      } // field
+
+   } // buffer
+
+} // casual
+
+#endif /* CASUAL_BUFFER_FIELD_REPOSITORY_H */
@@ -6,6 +6,7 @@
 //
 
 #include "buffer/field.h"
+#include "buffer/field/repository.h"
 
 #include "common/environment.h"
 #include "common/exception.h"
@@ -20,10 +21,14 @@
 #include "sf/archive/maker.h"
 
 #include <cstring>
+#include <cctype>
+#include <cerrno>
 
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <memory>
+#include <type_traits>
 
 
 #include <algorithm>
@@ -33,6 +38,13 @@
 
 #include <iostream>
 #include <sstream>
+#include <fstream>
+#include <cstdint>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 namespace casual
 {
@@ -83,11 +95,15 @@ namespace casual
                typedef common::platform::binary_type::size_type size_type;
                typedef common::platform::binary_type::const_pointer const_data_type;
 
-               struct compare_first
-               {
-                  const long first;
-                  bool operator()( const std::pair<long,long>& pair) const { return pair.first == first;}
-               };
+               //
+               // Id and offset of every field, in buffer order
+               //
+               typedef std::vector< std::pair< long, long> > index_type;
+
+               //
+               // Positions (in the index) of every occurrence of an id, in buffer order
+               //
+               typedef std::unordered_map< long, std::vector< index_type::size_type> > occurrences_type;
 
                struct update_second
                {
@@ -131,14 +147,6 @@ namespace casual
 
             private:
 
-               // TODO: Perhaps move this to common/algorithm.h
-               template<typename Iterator, typename Predicate, typename Index>
-               static Iterator find_if_index( Iterator first, Iterator last, Predicate p, Index i)
-               {
-                  using Reference = typename std::iterator_traits<Iterator>::reference;
-                  return std::find_if( first, last, [&]( Reference item) { return p( item) && !(i--); } );
-               }
-
                template<typename T>
                static T decode( const_data_type where)
                {
@@ -164,6 +172,7 @@ namespace casual
 
                   this->payload.memory = other.payload.memory;
                   this->m_index = other.m_index;
+                  this->m_occurrences = other.m_occurrences;
 
                   return true;
                }
@@ -185,26 +194,37 @@ namespace casual
                }
 
 
-               const std::vector< std::pair< long, long> >& index() const
+               const index_type& index() const
                {
                   return m_index;
                }
 
 
-               std::vector< std::pair< long, long> >::const_iterator index( const long id, const long occurrence) const
+               index_type::const_iterator index( const long id, const long occurrence) const
+               {
+                  return m_index.begin() + position( id, occurrence);
+               }
+
+               index_type::iterator index( const long id, const long occurrence)
                {
-                  return find_if_index( m_index.begin(), m_index.end(), compare_first{ id}, occurrence);
+                  return m_index.begin() + position( id, occurrence);
                }
 
-               std::vector< std::pair< long, long> >::iterator index( const long id, const long occurrence)
+               //!
+               //! @return which occurrence (of its id) the field at @p current is
+               //!
+               long occurrence( index_type::const_iterator current) const
                {
-                  return find_if_index( m_index.begin(), m_index.end(), compare_first{ id}, occurrence);
+                  const auto& positions = m_occurrences.at( current->first);
+                  const auto position = static_cast< index_type::size_type>( current - m_index.begin());
+
+                  return std::lower_bound( positions.begin(), positions.end(), position) - positions.begin();
                }
 
                //! @throw std::out_of_range when occurrence is not found
                size_type offset( const long id, const long occurrence) const
                {
-                  return m_index.at( index( id, occurrence) - m_index.begin()).second;
+                  return m_index.at( position( id, occurrence)).second;
                }
 
                const_data_type find( const long id, const long occurrence) const
@@ -231,6 +251,7 @@ namespace casual
                   //
                   // Append current offset to index
                   //
+                  m_occurrences[ id].push_back( m_index.size());
                   m_index.emplace_back( id, utilized());
 
                   //
@@ -415,6 +436,30 @@ namespace casual
                         payload.memory.begin() + offset->second,
                         payload.memory.begin() + offset->second + data_offset + count);
 
+                     //
+                     // Remove the occurrence and update positions of the ones beyond
+                     //
+                     const auto position = static_cast< index_type::size_type>( offset - m_index.begin());
+
+                     {
+                        auto& positions = m_occurrences[ id];
+                        positions.erase( positions.begin() + occurrence);
+
+                        if( positions.empty())
+                        {
+                           m_occurrences.erase( id);
+                        }
+                     }
+
+                     for( auto& positions : m_occurrences)
+                     {
+                        for( auto current = std::upper_bound( positions.second.begin(), positions.second.end(), position);
+                              current != positions.second.end(); ++current)
+                        {
+                           --*current;
+                        }
+                     }
+
                      //
                      // Remove entry and update offsets
                      //
@@ -437,6 +482,28 @@ namespace casual
                {
                   payload.memory.clear();
                   m_index.clear();
+                  m_occurrences.clear();
+               }
+
+               //!
+               //! Removes the fields that has been appended since the buffer had @p fields fields,
+               //! to undo appends that did not go all the way
+               //!
+               void truncate( const index_type::size_type fields)
+               {
+                  while( m_index.size() > fields)
+                  {
+                     const auto found = m_occurrences.find( m_index.back().first);
+                     found->second.pop_back();
+
+                     if( found->second.empty())
+                     {
+                        m_occurrences.erase( found);
+                     }
+
+                     payload.memory.resize( m_index.back().second);
+                     m_index.pop_back();
+                  }
                }
 
 
@@ -462,7 +529,14 @@ namespace casual
 
                long count( const long id) const
                {
-                  return std::count_if( m_index.begin(), m_index.end(), compare_first{ id});
+                  const auto found = m_occurrences.find( id);
+
+                  if( found != m_occurrences.end())
+                  {
+                     return found->second.size();
+                  }
+
+                  return 0;
                }
 
             private:
@@ -477,9 +551,25 @@ namespace casual
                      reinterpret_cast<const_data_type>( &encoded) + sizeof( encoded));
                }
 
+               //!
+               //! @return position in m_index of the @p occurrence of @p id, or m_index.size() if not found
+               //!
+               index_type::size_type position( const long id, const long occurrence) const
+               {
+                  const auto found = m_occurrences.find( id);
+
+                  if( found != m_occurrences.end() && occurrence >= 0 && static_cast< std::size_t>( occurrence) < found->second.size())
+                  {
+                     return found->second[ occurrence];
+                  }
+
+                  return m_index.size();
+               }
+
                void update_index()
                {
                   m_index.clear();
+                  m_occurrences.clear();
 
                   const auto begin = payload.memory.begin();
                   const auto end = payload.memory.end();
@@ -490,6 +580,7 @@ namespace casual
                      const auto id = decode<long>( &*cursor + item_offset);
                      const auto size = decode<long>( &*cursor + size_offset);
 
+                     m_occurrences[ id].push_back( m_index.size());
                      m_index.emplace_back( id, std::distance( begin, cursor));
 
                      std::advance( cursor, data_offset + size);
@@ -498,7 +589,8 @@ namespace casual
 
             private:
 
-               std::vector< std::pair< long, long> > m_index;
+               index_type m_index;
+               occurrences_type m_occurrences;
 
             };
 
@@ -523,14 +615,14 @@ namespace casual
 
                common::platform::raw_buffer_type allocate( const common::buffer::Type& type, const common::platform::binary_size_type size)
                {
-                  m_pool.emplace_back( type, 0);
+                  auto buffer = emplace( type, 0);
 
                   //
                   // GCC returns null for std::vector::data with size zero, so
                   // we need to ensure that at least some allocation occurs
                   //
-                  m_pool.back().payload.memory.reserve( size ? size : 1);
-                  return m_pool.back().payload.memory.data();
+                  buffer->payload.memory.reserve( size ? size : 1);
+                  return index( buffer);
                }
 
                common::platform::raw_buffer_type reallocate( const common::platform::const_raw_buffer_type handle, const common::platform::binary_size_type size)
@@ -547,13 +639,7 @@ namespace casual
                   // we need to ensure that at least some allocation occurs
                   //
                   result->payload.memory.reserve( size ? size : 1);
-                  return result->payload.memory.data();
-               }
-
-               common::platform::raw_buffer_type insert( common::buffer::Payload payload)
-               {
-                  m_pool.emplace_back( std::move( payload));
-                  return m_pool.back().payload.memory.data();
+                  return index( result, handle);
                }
             };
 
@@ -775,7 +861,7 @@ namespace casual
                      if( adjacent != buffer->index().end())
                      {
                         id = adjacent->first;
-                        index = std::count_if( buffer->index().begin(), adjacent, Buffer::compare_first{ id});
+                        index = buffer->occurrence( adjacent);
                      }
                      else
                      {
@@ -1499,8 +1585,385 @@ namespace casual
             }
 
 
+            namespace image
+            {
+               namespace
+               {
+                  //
+                  // The layout of the image (host byteorder) is
+                  //
+                  // |header|entries...|name-displacements...|name-slots...|id-displacements...|id-slots...|names...|
+                  //
+                  struct Header
+                  {
+                     char magic[ 8];
+                     std::uint64_t count;
+                     std::uint64_t names;
+                  };
+
+                  struct Entry
+                  {
+                     std::int64_t id;
+                     std::uint64_t name; // offset in names
+                  };
+
+                  const char magic[ 8] = { 'C', 'F', 'I', 'E', 'L', 'D', 'R', '1'};
+
+                  std::uint32_t hash( const char* data, std::size_t size, const std::uint32_t seed)
+                  {
+                     //
+                     // FNV-1a with a final mix, so different seeds gives different distributions
+                     //
+                     std::uint32_t result = 2166136261u ^ ( seed * 0x9e3779b9u);
+
+                     while( size-- > 0)
+                     {
+                        result ^= static_cast< unsigned char>( *data++);
+                        result *= 16777619u;
+                     }
+
+                     result ^= result >> 16;
+                     result *= 0x85ebca6bu;
+                     result ^= result >> 13;
+                     result *= 0xc2b2ae35u;
+                     result ^= result >> 16;
+
+                     return result;
+                  }
+
+                  struct Key
+                  {
+                     const char* data;
+                     std::size_t size;
+                  };
+
+                  //
+                  // Plenty for any sane table, we only run out if keys are duplicated
+                  //
+                  const std::uint32_t seeds = 1 << 20;
+
+                  //
+                  // Hash and displace, each key gets a unique slot
+                  //
+                  // @throw common::exception::invalid::Argument if no seed places all keys of a bucket
+                  //
+                  void perfect( const std::vector< Key>& keys, std::vector< std::int32_t>& displacements, std::vector< std::uint32_t>& slots)
+                  {
+                     const auto count = keys.size();
+                     const auto empty = static_cast< std::uint32_t>( count);
+
+                     displacements.assign( count, 0);
+                     slots.assign( count, empty);
+
+                     std::vector< std::vector< std::uint32_t>> buckets( count);
+
+                     for( std::uint32_t index = 0; index < count; ++index)
+                     {
+                        buckets[ hash( keys[ index].data, keys[ index].size, 0) % count].push_back( index);
+                     }
+
+                     std::vector< std::uint32_t> order( count);
+                     for( std::uint32_t index = 0; index < count; ++index)
+                     {
+                        order[ index] = index;
+                     }
+
+                     std::stable_sort( order.begin(), order.end(), [&]( std::uint32_t lhs, std::uint32_t rhs){
+                        return buckets[ lhs].size() > buckets[ rhs].size();
+                     });
+
+                     auto current = order.begin();
+
+                     for( ; current != order.end() && buckets[ *current].size() > 1; ++current)
+                     {
+                        const auto& bucket = buckets[ *current];
+
+                        std::vector< std::uint32_t> tentative;
+
+                        std::uint32_t seed = 1;
+
+                        for( ; seed <= seeds; ++seed)
+                        {
+                           tentative.clear();
+
+                           for( auto key : bucket)
+                           {
+                              const auto slot = hash( keys[ key].data, keys[ key].size, seed) % count;
+
+                              if( slots[ slot] != empty || std::find( tentative.begin(), tentative.end(), slot) != tentative.end())
+                              {
+                                 break;
+                              }
+                              tentative.push_back( slot);
+                           }
+
+                           if( tentative.size() == bucket.size())
+                           {
+                              for( std::size_t index = 0; index < bucket.size(); ++index)
+                              {
+                                 slots[ tentative[ index]] = bucket[ index];
+                              }
+                              displacements[ *current] = static_cast< std::int32_t>( seed);
+                              break;
+                           }
+                        }
+
+                        if( seed > seeds)
+                        {
+                           throw common::exception::invalid::Argument{ "failed to place field repository keys - duplicated?", CASUAL_NIP( bucket.size())};
+                        }
+                     }
+
+                     //
+                     // Buckets with one key takes the free slots directly
+                     //
+                     std::uint32_t free = 0;
+
+                     for( ; current != order.end() && buckets[ *current].size() == 1; ++current)
+                     {
+                        while( slots[ free] != empty)
+                        {
+                           ++free;
+                        }
+                        slots[ free] = buckets[ *current].front();
+                        displacements[ *current] = -static_cast< std::int32_t>( free) - 1;
+                     }
+                  }
+
+                  std::uint32_t slot( const std::int32_t* displacements, const std::uint64_t count, const char* data, std::size_t size)
+                  {
+                     const auto displacement = displacements[ hash( data, size, 0) % count];
+
+                     if( displacement < 0)
+                     {
+                        return -displacement - 1;
+                     }
+                     return hash( data, size, displacement) % count;
+                  }
+
+                  struct Layout
+                  {
+                     Layout( const Header& header)
+                     {
+                        const auto count = header.count;
+
+                        entries = sizeof( Header);
+                        name_displacements = entries + count * sizeof( Entry);
+                        name_slots = name_displacements + count * sizeof( std::int32_t);
+                        id_displacements = name_slots + count * sizeof( std::uint32_t);
+                        id_slots = id_displacements + count * sizeof( std::int32_t);
+                        names = id_slots + count * sizeof( std::uint32_t);
+                        size = names + header.names;
+                     }
+
+                     std::size_t entries;
+                     std::size_t name_displacements;
+                     std::size_t name_slots;
+                     std::size_t id_displacements;
+                     std::size_t id_slots;
+                     std::size_t names;
+                     std::size_t size;
+                  };
+
+               } //
+
+               void write( const std::unordered_map<std::string,long>& fields, const std::string& file)
+               {
+                  std::vector< Entry> entries;
+                  std::vector< Key> names;
+                  std::vector< std::int64_t> ids;
+                  std::string strings;
+
+                  for( const auto& field : fields)
+                  {
+                     entries.push_back( Entry{ field.second, strings.size()});
+                     strings.append( field.first).push_back( '\0');
+                     ids.push_back( field.second);
+                  }
+
+                  //
+                  // Keys refer to strings, that is done now
+                  //
+                  for( const auto& entry : entries)
+                  {
+                     names.push_back( Key{ strings.data() + entry.name, std::strlen( strings.data() + entry.name)});
+                  }
+
+                  std::vector< Key> keys;
+                  for( const auto& id : ids)
+                  {
+                     keys.push_back( Key{ reinterpret_cast< const char*>( &id), sizeof( id)});
+                  }
+
+                  std::vector< std::int32_t> name_displacements;
+                  std::vector< std::uint32_t> name_slots;
+                  perfect( names, name_displacements, name_slots);
+
+                  std::vector< std::int32_t> id_displacements;
+                  std::vector< std::uint32_t> id_slots;
+                  perfect( keys, id_displacements, id_slots);
+
+                  Header header;
+                  std::copy( std::begin( magic), std::end( magic), std::begin( header.magic));
+                  header.count = entries.size();
+                  header.names = strings.size();
+
+                  std::ofstream out{ file, std::ios::binary | std::ios::trunc};
+
+                  auto write = [&]( const void* data, std::size_t size){
+                     out.write( static_cast< const char*>( data), size);
+                  };
+
+                  write( &header, sizeof( header));
+                  write( entries.data(), entries.size() * sizeof( Entry));
+                  write( name_displacements.data(), name_displacements.size() * sizeof( std::int32_t));
+                  write( name_slots.data(), name_slots.size() * sizeof( std::uint32_t));
+                  write( id_displacements.data(), id_displacements.size() * sizeof( std::int32_t));
+                  write( id_slots.data(), id_slots.size() * sizeof( std::uint32_t));
+                  write( strings.data(), strings.size());
+
+                  if( ! out)
+                  {
+                     throw common::exception::invalid::File{ "failed to write field repository image", CASUAL_NIP( file)};
+                  }
+               }
+
+               Mapping::Mapping( const std::string& file)
+               {
+                  const auto descriptor = ::open( file.c_str(), O_RDONLY);
+
+                  if( descriptor == -1)
+                  {
+                     throw common::exception::invalid::File{ "failed to open field repository image", CASUAL_NIP( file)};
+                  }
+
+                  struct stat status;
+
+                  if( ::fstat( descriptor, &status) == 0 && static_cast< std::size_t>( status.st_size) >= sizeof( Header))
+                  {
+                     auto memory = ::mmap( nullptr, status.st_size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+                     if( memory != MAP_FAILED)
+                     {
+                        m_memory = memory;
+                        m_size = status.st_size;
+                     }
+                  }
+
+                  ::close( descriptor);
+
+                  if( ! m_memory)
+                  {
+                     throw common::exception::invalid::File{ "failed to map field repository image", CASUAL_NIP( file)};
+                  }
+
+                  const auto& header = *static_cast< const Header*>( m_memory);
+
+                  if( ! std::equal( std::begin( magic), std::end( magic), header.magic) || Layout( header).size != m_size)
+                  {
+                     ::munmap( const_cast< void*>( m_memory), m_size);
+                     throw common::exception::invalid::File{ "invalid field repository image", CASUAL_NIP( file)};
+                  }
+               }
+
+               Mapping::~Mapping()
+               {
+                  ::munmap( const_cast< void*>( m_memory), m_size);
+               }
+
+               long Mapping::id( const char* const name) const
+               {
+                  const auto base = static_cast< const char*>( m_memory);
+                  const auto& header = *reinterpret_cast< const Header*>( base);
+
+                  if( header.count == 0)
+                  {
+                     return CASUAL_FIELD_NO_ID;
+                  }
+
+                  const Layout layout{ header};
+
+                  const auto index = reinterpret_cast< const std::uint32_t*>( base + layout.name_slots)[
+                     slot( reinterpret_cast< const std::int32_t*>( base + layout.name_displacements), header.count, name, std::strlen( name))];
+
+                  const auto& entry = reinterpret_cast< const Entry*>( base + layout.entries)[ index];
+
+                  if( std::strcmp( base + layout.names + entry.name, name) == 0)
+                  {
+                     return entry.id;
+                  }
+
+                  return CASUAL_FIELD_NO_ID;
+               }
+
+               const char* Mapping::name( const long id) const
+               {
+                  const auto base = static_cast< const char*>( m_memory);
+                  const auto& header = *reinterpret_cast< const Header*>( base);
+
+                  if( header.count == 0)
+                  {
+                     return nullptr;
+                  }
+
+                  const Layout layout{ header};
+
+                  const std::int64_t key = id;
+
+                  const auto index = reinterpret_cast< const std::uint32_t*>( base + layout.id_slots)[
+                     slot( reinterpret_cast< const std::int32_t*>( base + layout.id_displacements), header.count, reinterpret_cast< const char*>( &key), sizeof( key))];
+
+                  const auto& entry = reinterpret_cast< const Entry*>( base + layout.entries)[ index];
+
+                  if( entry.id == key)
+                  {
+                     return base + layout.names + entry.name;
+                  }
+
+                  return nullptr;
+               }
+
+               std::size_t Mapping::size() const
+               {
+                  return static_cast< const Header*>( m_memory)->count;
+               }
+
+               namespace
+               {
+                  //
+                  // @return the mapped repository if CASUAL_FIELD_REPOSITORY is set
+                  //
+                  const Mapping* mapping()
+                  {
+                     static const auto result = []() -> std::unique_ptr< Mapping>
+                     {
+                        if( common::environment::variable::exists( "CASUAL_FIELD_REPOSITORY"))
+                        {
+                           try
+                           {
+                              return std::unique_ptr< Mapping>{ new Mapping{ common::environment::variable::get( "CASUAL_FIELD_REPOSITORY")}};
+                           }
+                           catch( ...)
+                           {
+                              casual::common::error::handler();
+                           }
+                        }
+                        return nullptr;
+                     }();
+
+                     return result.get();
+                  }
+               } //
+
+            } // image
+
+
             long name_to_id( const char* const name)
             {
+               if( const auto image = image::mapping())
+               {
+                  return image->id( name);
+               }
 
                try
                {
@@ -1526,6 +1989,11 @@ namespace casual
 
             const char* id_to_name( const long id)
             {
+               if( const auto image = image::mapping())
+               {
+                  return image->name( id);
+               }
+
                try
                {
                   static const auto mapping = id_to_name();
@@ -1895,3 +2363,873 @@ int CasualFieldMatch( const char* const buffer, const char* const expression, in
 
    return CASUAL_FIELD_SUCCESS;
 }
+
+
+namespace casual
+{
+   namespace buffer
+   {
+      namespace field
+      {
+         namespace match
+         {
+            namespace
+            {
+               //
+               // Thrown by the parser with the CASUAL_FIELD_ code to return
+               //
+               struct Error
+               {
+                  int code;
+               };
+
+               struct Node
+               {
+                  virtual ~Node() = default;
+                  virtual bool evaluate( const Buffer& buffer) const = 0;
+               };
+
+               typedef std::unique_ptr< Node> node_type;
+
+               struct Not : Node
+               {
+                  explicit Not( node_type operand) : operand( std::move( operand)) {}
+
+                  bool evaluate( const Buffer& buffer) const override
+                  {
+                     return ! operand->evaluate( buffer);
+                  }
+
+                  node_type operand;
+               };
+
+               struct And : Node
+               {
+                  And( node_type lhs, node_type rhs) : lhs( std::move( lhs)), rhs( std::move( rhs)) {}
+
+                  bool evaluate( const Buffer& buffer) const override
+                  {
+                     return lhs->evaluate( buffer) && rhs->evaluate( buffer);
+                  }
+
+                  node_type lhs;
+                  node_type rhs;
+               };
+
+               struct Or : Node
+               {
+                  Or( node_type lhs, node_type rhs) : lhs( std::move( lhs)), rhs( std::move( rhs)) {}
+
+                  bool evaluate( const Buffer& buffer) const override
+                  {
+                     return lhs->evaluate( buffer) || rhs->evaluate( buffer);
+                  }
+
+                  node_type lhs;
+                  node_type rhs;
+               };
+
+               enum class Operator
+               {
+                  exists,
+                  equal,
+                  not_equal,
+                  less,
+                  less_equal,
+                  greater,
+                  greater_equal,
+                  regex
+               };
+
+               template<typename T>
+               bool compare( const Operator operation, const T& lhs, const T& rhs)
+               {
+                  switch( operation)
+                  {
+                  case Operator::equal: return lhs == rhs;
+                  case Operator::not_equal: return lhs != rhs;
+                  case Operator::less: return lhs < rhs;
+                  case Operator::less_equal: return lhs <= rhs;
+                  case Operator::greater: return lhs > rhs;
+                  case Operator::greater_equal: return lhs >= rhs;
+                  default: return false;
+                  }
+               }
+
+               //
+               // A field (any or a specific occurrence) compared to a literal
+               //
+               struct Predicate : Node
+               {
+                  long id = CASUAL_FIELD_NO_ID;
+                  long occurrence = -1;
+                  Operator operation = Operator::exists;
+
+                  //
+                  // Integral literals are compared as integers with integral fields
+                  //
+                  bool integral = false;
+                  long integer = 0;
+                  double number = 0;
+
+                  std::string text;
+                  std::regex expression;
+
+                  bool evaluate( const Buffer& buffer) const override
+                  {
+                     if( occurrence >= 0)
+                     {
+                        return test( buffer, occurrence);
+                     }
+
+                     for( long index = 0, count = buffer.count( id); index < count; ++index)
+                     {
+                        if( test( buffer, index))
+                        {
+                           return true;
+                        }
+                     }
+
+                     return false;
+                  }
+
+               private:
+
+                  template<typename T>
+                  typename std::enable_if< std::is_integral< T>::value, bool>::type
+                  numeric( const Buffer& buffer, const long index) const
+                  {
+                     T value;
+
+                     if( ! buffer.select( id, index, value))
+                     {
+                        return false;
+                     }
+
+                     if( integral)
+                     {
+                        return compare( operation, static_cast< long>( value), integer);
+                     }
+                     return compare( operation, static_cast< double>( value), number);
+                  }
+
+                  template<typename T>
+                  typename std::enable_if< std::is_floating_point< T>::value, bool>::type
+                  numeric( const Buffer& buffer, const long index) const
+                  {
+                     T value;
+                     return buffer.select( id, index, value) && compare( operation, static_cast< double>( value), number);
+                  }
+
+                  bool textual( const std::string& value) const
+                  {
+                     if( operation == Operator::regex)
+                     {
+                        return std::regex_match( value, expression);
+                     }
+                     return compare( operation, value, text);
+                  }
+
+                  bool test( const Buffer& buffer, const long index) const
+                  {
+                     if( operation == Operator::exists)
+                     {
+                        return buffer.find( id, index) != nullptr;
+                     }
+
+                     switch( id / CASUAL_FIELD_TYPE_BASE)
+                     {
+                     case CASUAL_FIELD_SHORT:
+                        return numeric< short>( buffer, index);
+                     case CASUAL_FIELD_LONG:
+                        return numeric< long>( buffer, index);
+                     case CASUAL_FIELD_CHAR:
+                        return numeric< char>( buffer, index);
+                     case CASUAL_FIELD_FLOAT:
+                        return numeric< float>( buffer, index);
+                     case CASUAL_FIELD_DOUBLE:
+                        return numeric< double>( buffer, index);
+                     case CASUAL_FIELD_STRING:
+                     {
+                        const char* value;
+                        return buffer.select( id, index, value) && textual( value);
+                     }
+                     case CASUAL_FIELD_BINARY:
+                     {
+                        Buffer::const_data_type value;
+                        long count;
+                        return buffer.select( id, index, value, count) && textual( std::string( value, count));
+                     }
+                     default:
+                        return false;
+                     }
+                  }
+               };
+
+               struct Expression
+               {
+                  node_type root;
+               };
+
+               //
+               // expression  := and { '||' and }
+               // and         := unary { '&&' unary }
+               // unary       := '!' unary | '(' expression ')' | predicate
+               // predicate   := field [ '[' occurrence ']' ] [ operator literal ]
+               // field       := name | id
+               // operator    := '==' | '!=' | '<' | '<=' | '>' | '>=' | '=~'
+               // literal     := number | 'text' | "text"
+               //
+               class Parser
+               {
+               public:
+                  explicit Parser( const char* const expression) : m_cursor( expression) {}
+
+                  node_type parse()
+                  {
+                     auto result = disjunction();
+
+                     if( ! end())
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                     }
+
+                     return result;
+                  }
+
+               private:
+
+                  void skip()
+                  {
+                     while( std::isspace( static_cast< unsigned char>( *m_cursor)))
+                     {
+                        ++m_cursor;
+                     }
+                  }
+
+                  bool end()
+                  {
+                     skip();
+                     return *m_cursor == '\0';
+                  }
+
+                  bool consume( const char* const token)
+                  {
+                     skip();
+
+                     const auto size = std::strlen( token);
+
+                     if( std::strncmp( m_cursor, token, size) == 0)
+                     {
+                        m_cursor += size;
+                        return true;
+                     }
+                     return false;
+                  }
+
+                  void expect( const char* const token)
+                  {
+                     if( ! consume( token))
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                     }
+                  }
+
+                  node_type disjunction()
+                  {
+                     auto result = conjunction();
+
+                     while( consume( "||"))
+                     {
+                        result = node_type{ new Or{ std::move( result), conjunction()}};
+                     }
+                     return result;
+                  }
+
+                  node_type conjunction()
+                  {
+                     auto result = unary();
+
+                     while( consume( "&&"))
+                     {
+                        result = node_type{ new And{ std::move( result), unary()}};
+                     }
+                     return result;
+                  }
+
+                  node_type unary()
+                  {
+                     if( consume( "!"))
+                     {
+                        return node_type{ new Not{ unary()}};
+                     }
+
+                     if( consume( "("))
+                     {
+                        auto result = disjunction();
+                        expect( ")");
+                        return result;
+                     }
+
+                     return predicate();
+                  }
+
+                  long field()
+                  {
+                     skip();
+
+                     if( std::isdigit( static_cast< unsigned char>( *m_cursor)))
+                     {
+                        return integer();
+                     }
+
+                     const auto first = m_cursor;
+
+                     while( std::isalnum( static_cast< unsigned char>( *m_cursor)) || *m_cursor == '_')
+                     {
+                        ++m_cursor;
+                     }
+
+                     if( first == m_cursor)
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                     }
+
+                     const auto id = repository::name_to_id( std::string( first, m_cursor).c_str());
+
+                     if( id == CASUAL_FIELD_NO_ID)
+                     {
+                        throw Error{ CASUAL_FIELD_UNKNOWN_ID};
+                     }
+
+                     return id;
+                  }
+
+                  Operator operation()
+                  {
+                     // Longest tokens first
+                     if( consume( "==")) return Operator::equal;
+                     if( consume( "!=")) return Operator::not_equal;
+                     if( consume( "<=")) return Operator::less_equal;
+                     if( consume( ">=")) return Operator::greater_equal;
+                     if( consume( "=~")) return Operator::regex;
+                     if( consume( "<")) return Operator::less;
+                     if( consume( ">")) return Operator::greater;
+
+                     return Operator::exists;
+                  }
+
+                  bool text( std::string& value)
+                  {
+                     skip();
+
+                     const auto quote = *m_cursor;
+
+                     if( quote != '\'' && quote != '"')
+                     {
+                        return false;
+                     }
+
+                     const auto last = std::strchr( m_cursor + 1, quote);
+
+                     if( ! last)
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                     }
+
+                     value.assign( m_cursor + 1, last);
+                     m_cursor = last + 1;
+
+                     return true;
+                  }
+
+                  //
+                  // Unsigned decimal digits only, so ids and occurrences are exact
+                  //
+                  long integer()
+                  {
+                     skip();
+
+                     if( ! std::isdigit( static_cast< unsigned char>( *m_cursor)))
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                     }
+
+                     errno = 0;
+                     char* last = nullptr;
+                     const auto result = std::strtol( m_cursor, &last, 10);
+
+                     if( errno == ERANGE)
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                     }
+
+                     m_cursor = last;
+                     return result;
+                  }
+
+                  void number( Predicate& predicate)
+                  {
+                     skip();
+
+                     char* last = nullptr;
+                     predicate.number = std::strtod( m_cursor, &last);
+
+                     if( last == m_cursor)
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                     }
+
+                     //
+                     // If the same characters makes a long, we keep it as well
+                     //
+                     errno = 0;
+                     char* integral = nullptr;
+                     const auto integer = std::strtol( m_cursor, &integral, 10);
+
+                     if( integral == last && errno != ERANGE)
+                     {
+                        predicate.integral = true;
+                        predicate.integer = integer;
+                     }
+
+                     m_cursor = last;
+                  }
+
+                  node_type predicate()
+                  {
+                     std::unique_ptr< Predicate> result{ new Predicate};
+
+                     result->id = field();
+
+                     const auto type = result->id / CASUAL_FIELD_TYPE_BASE;
+
+                     if( type < CASUAL_FIELD_SHORT || type > CASUAL_FIELD_BINARY)
+                     {
+                        throw Error{ CASUAL_FIELD_INVALID_ID};
+                     }
+
+                     if( consume( "["))
+                     {
+                        result->occurrence = integer();
+                        expect( "]");
+                     }
+
+                     result->operation = operation();
+
+                     if( result->operation == Operator::exists)
+                     {
+                        return node_type{ std::move( result)};
+                     }
+
+                     const bool textual = type == CASUAL_FIELD_STRING || type == CASUAL_FIELD_BINARY;
+
+                     if( text( result->text))
+                     {
+                        if( type == CASUAL_FIELD_CHAR && result->text.size() == 1 && result->operation != Operator::regex)
+                        {
+                           //
+                           // A char is compared as its value
+                           //
+                           result->integral = true;
+                           result->integer = result->text.front();
+                        }
+                        else if( ! textual)
+                        {
+                           throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                        }
+                        else if( result->operation == Operator::regex)
+                        {
+                           try
+                           {
+                              result->expression = std::regex( result->text);
+                           }
+                           catch( const std::regex_error&)
+                           {
+                              throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                           }
+                        }
+                     }
+                     else
+                     {
+                        if( textual || result->operation == Operator::regex)
+                        {
+                           throw Error{ CASUAL_FIELD_INVALID_ARGUMENT};
+                        }
+
+                        number( *result);
+                     }
+
+                     return node_type{ std::move( result)};
+                  }
+
+                  const char* m_cursor;
+               };
+
+            } //
+         } // match
+      } // field
+   } // buffer
+} // casual
+
+int CasualFieldMatchCompile( const char* const expression, const void** const matcher)
+{
+   if( ! expression || ! matcher)
+   {
+      return CASUAL_FIELD_INVALID_ARGUMENT;
+   }
+
+   try
+   {
+      using casual::buffer::field::match::Expression;
+      using casual::buffer::field::match::Parser;
+
+      std::unique_ptr< Expression> result{ new Expression};
+      result->root = Parser{ expression}.parse();
+
+      *matcher = result.release();
+   }
+   catch( const casual::buffer::field::match::Error& error)
+   {
+      return error.code;
+   }
+   catch( ...)
+   {
+      casual::common::error::handler();
+      return CASUAL_FIELD_INTERNAL_FAILURE;
+   }
+
+   return CASUAL_FIELD_SUCCESS;
+}
+
+int CasualFieldMatchExecute( const char* const buffer, const void* const matcher, int* const match)
+{
+   if( ! matcher)
+   {
+      return CASUAL_FIELD_INVALID_ARGUMENT;
+   }
+
+   if( const auto field = casual::buffer::field::find( buffer))
+   {
+      const auto& expression = *static_cast< const casual::buffer::field::match::Expression*>( matcher);
+
+      const bool result = expression.root->evaluate( *field);
+
+      if( match) *match = result;
+
+      return CASUAL_FIELD_SUCCESS;
+   }
+
+   return CASUAL_FIELD_INVALID_BUFFER;
+}
+
+int CasualFieldMatchRelease( const void* const matcher)
+{
+   delete static_cast< const casual::buffer::field::match::Expression*>( matcher);
+   return CASUAL_FIELD_SUCCESS;
+}
+
+
+namespace casual
+{
+   namespace buffer
+   {
+      namespace field
+      {
+         namespace mapping
+         {
+            namespace
+            {
+               struct Member
+               {
+                  long id;
+                  int type;
+                  std::size_t offset;
+                  std::size_t size;
+                  //
+                  // Several members with the same id maps to consecutive occurrences
+                  //
+                  long occurrence;
+               };
+
+               struct Mapping
+               {
+                  std::vector< Member> members;
+               };
+
+               //
+               // @return the size of the native type, or 0 if the type has the size of the member
+               //
+               std::size_t native( int type)
+               {
+                  switch( type)
+                  {
+                     case CASUAL_FIELD_SHORT: return sizeof( short);
+                     case CASUAL_FIELD_LONG: return sizeof( long);
+                     case CASUAL_FIELD_CHAR: return sizeof( char);
+                     case CASUAL_FIELD_FLOAT: return sizeof( float);
+                     case CASUAL_FIELD_DOUBLE: return sizeof( double);
+                     default: return 0;
+                  }
+               }
+
+               //
+               // @return the size the member will occupy in the buffer, or -1 if it cannot be added
+               //
+               long size( const Member& member, const char* const source)
+               {
+                  switch( member.type)
+                  {
+                     case CASUAL_FIELD_SHORT: return common::network::byteorder::bytes< short>();
+                     case CASUAL_FIELD_LONG: return common::network::byteorder::bytes< long>();
+                     case CASUAL_FIELD_CHAR: return common::network::byteorder::bytes< char>();
+                     case CASUAL_FIELD_FLOAT: return common::network::byteorder::bytes< float>();
+                     case CASUAL_FIELD_DOUBLE: return common::network::byteorder::bytes< double>();
+                     case CASUAL_FIELD_STRING:
+                     {
+                        //
+                        // The string has to be terminated within the member
+                        //
+                        const auto length = strnlen( source + member.offset, member.size);
+                        return length < member.size ? length + 1 : -1;
+                     }
+                     case CASUAL_FIELD_BINARY: return member.size;
+                     default: return -1;
+                  }
+               }
+
+               template< typename T>
+               bool append( Buffer& buffer, const Member& member, const char* const source)
+               {
+                  T value;
+                  std::memcpy( &value, source + member.offset, sizeof( T));
+                  return buffer.append( member.id, value);
+               }
+
+               bool append( Buffer& buffer, const Member& member, const char* const source)
+               {
+                  switch( member.type)
+                  {
+                     case CASUAL_FIELD_SHORT: return append< short>( buffer, member, source);
+                     case CASUAL_FIELD_LONG: return append< long>( buffer, member, source);
+                     case CASUAL_FIELD_CHAR: return append< char>( buffer, member, source);
+                     case CASUAL_FIELD_FLOAT: return append< float>( buffer, member, source);
+                     case CASUAL_FIELD_DOUBLE: return append< double>( buffer, member, source);
+                     case CASUAL_FIELD_STRING: return buffer.append( member.id, source + member.offset);
+                     case CASUAL_FIELD_BINARY: return buffer.append( member.id, source + member.offset, member.size);
+                     default: return false;
+                  }
+               }
+
+               template< typename T>
+               bool select( const Buffer& buffer, const Member& member, char* const target)
+               {
+                  T value;
+                  if( buffer.select( member.id, member.occurrence, value))
+                  {
+                     std::memcpy( target + member.offset, &value, sizeof( T));
+                     return true;
+                  }
+                  return false;
+               }
+
+               bool select( const Buffer& buffer, const Member& member, char* const target)
+               {
+                  switch( member.type)
+                  {
+                     case CASUAL_FIELD_SHORT: return select< short>( buffer, member, target);
+                     case CASUAL_FIELD_LONG: return select< long>( buffer, member, target);
+                     case CASUAL_FIELD_CHAR: return select< char>( buffer, member, target);
+                     case CASUAL_FIELD_FLOAT: return select< float>( buffer, member, target);
+                     case CASUAL_FIELD_DOUBLE: return select< double>( buffer, member, target);
+                     case CASUAL_FIELD_STRING:
+                     {
+                        const char* value = nullptr;
+                        if( buffer.select( member.id, member.occurrence, value))
+                        {
+                           //
+                           // Truncate (and terminate) to the member
+                           //
+                           const auto length = strnlen( value, member.size - 1);
+                           std::memcpy( target + member.offset, value, length);
+                           std::memset( target + member.offset + length, 0, member.size - length);
+                           return true;
+                        }
+                        return false;
+                     }
+                     case CASUAL_FIELD_BINARY:
+                     {
+                        Buffer::const_data_type value = nullptr;
+                        long count = 0;
+                        if( buffer.select( member.id, member.occurrence, value, count))
+                        {
+                           const auto length = std::min( static_cast< std::size_t>( count), member.size);
+                           std::memcpy( target + member.offset, value, length);
+                           std::memset( target + member.offset + length, 0, member.size - length);
+                           return true;
+                        }
+                        return false;
+                     }
+                     default: return false;
+                  }
+               }
+
+            } //
+         } // mapping
+      } // field
+   } // buffer
+} // casual
+
+int CasualFieldMappingCompile( const CasualFieldMember* const members, const long count, const void** const mapping)
+{
+   if( ! members || count < 0 || ! mapping)
+   {
+      return CASUAL_FIELD_INVALID_ARGUMENT;
+   }
+
+   try
+   {
+      using casual::buffer::field::mapping::Mapping;
+
+      std::unique_ptr< Mapping> result{ new Mapping};
+      result->members.reserve( count);
+
+      std::unordered_map< long, long> occurrences;
+
+      for( auto member = members; member != members + count; ++member)
+      {
+         if( member->type != (member->id / CASUAL_FIELD_TYPE_BASE))
+         {
+            return CASUAL_FIELD_INVALID_ID;
+         }
+
+         if( CasualFieldTypeOfId( member->id, nullptr) != CASUAL_FIELD_SUCCESS)
+         {
+            return CASUAL_FIELD_INVALID_ID;
+         }
+
+         //
+         // The member has to be exactly the native type, since we copy sizeof( native)
+         //
+         const auto native = casual::buffer::field::mapping::native( member->type);
+
+         if( member->size == 0 || ( native != 0 && member->size != native))
+         {
+            return CASUAL_FIELD_INVALID_ARGUMENT;
+         }
+
+         result->members.push_back( { member->id, member->type, member->offset, member->size, occurrences[ member->id]++});
+      }
+
+      *mapping = result.release();
+   }
+   catch( ...)
+   {
+      casual::common::error::handler();
+      return CASUAL_FIELD_INTERNAL_FAILURE;
+   }
+
+   return CASUAL_FIELD_SUCCESS;
+}
+
+int CasualFieldMappingAdd( char** const buffer, const void* const mapping, const void* const source)
+{
+   if( ! buffer || ! mapping || ! source)
+   {
+      return CASUAL_FIELD_INVALID_ARGUMENT;
+   }
+
+   using casual::buffer::field::Buffer;
+   using casual::buffer::field::mapping::Mapping;
+
+   const auto& members = static_cast< const Mapping*>( mapping)->members;
+   const auto data = static_cast< const char*>( source);
+
+   auto field = casual::buffer::field::find( *buffer);
+
+   if( ! field)
+   {
+      return CASUAL_FIELD_INVALID_BUFFER;
+   }
+
+   //
+   // Compute the total size up front so that we at most reallocate once
+   //
+   auto total = field->utilized();
+
+   for( const auto& member : members)
+   {
+      const auto size = casual::buffer::field::mapping::size( member, data);
+
+      if( size < 0)
+      {
+         return CASUAL_FIELD_INVALID_ARGUMENT;
+      }
+
+      total += Buffer::data_offset + size;
+   }
+
+   //
+   // Either all members are added, or none
+   //
+   const auto fields = field->index().size();
+
+   try
+   {
+      if( total > field->reserved())
+      {
+         *buffer = casual::common::buffer::pool::Holder::instance().reallocate( *buffer, total);
+         field = casual::buffer::field::find( *buffer);
+      }
+
+      for( const auto& member : members)
+      {
+         if( ! casual::buffer::field::mapping::append( *field, member, data))
+         {
+            field->truncate( fields);
+            return CASUAL_FIELD_INTERNAL_FAILURE;
+         }
+      }
+   }
+   catch( ...)
+   {
+      field->truncate( fields);
+      casual::common::error::handler();
+      return CASUAL_FIELD_SYSTEM_FAILURE;
+   }
+
+   return CASUAL_FIELD_SUCCESS;
+}
+
+int CasualFieldMappingGet( const char* const buffer, const void* const mapping, void* const target)
+{
+   if( ! mapping || ! target)
+   {
+      return CASUAL_FIELD_INVALID_ARGUMENT;
+   }
+
+   using casual::buffer::field::mapping::Mapping;
+
+   if( const auto field = casual::buffer::field::find( buffer))
+   {
+      const auto data = static_cast< char*>( target);
+
+      for( const auto& member : static_cast< const Mapping*>( mapping)->members)
+      {
+         if( ! casual::buffer::field::mapping::select( *field, member, data))
+         {
+            std::memset( data + member.offset, 0, member.size);
+         }
+      }
+
+      return CASUAL_FIELD_SUCCESS;
+   }
+
+   return CASUAL_FIELD_INVALID_BUFFER;
+}
+
+int CasualFieldMappingRelease( const void* const mapping)
+{
+   delete static_cast< const casual::buffer::field::mapping::Mapping*>( mapping);
+   return CASUAL_FIELD_SUCCESS;
+}
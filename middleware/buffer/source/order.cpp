@@ -274,10 +274,10 @@ namespace casual
 
                common::platform::raw_buffer_type allocate( const common::buffer::Type& type, const common::platform::binary_size_type size)
                {
-                  m_pool.emplace_back( type, 0);
+                  auto buffer = emplace( type, 0);
                   // GCC returns null for std::vector::data with size zero
-                  m_pool.back().payload.memory.reserve( size ? size : 1);
-                  return m_pool.back().payload.memory.data();
+                  buffer->payload.memory.reserve( size ? size : 1);
+                  return index( buffer);
                }
 
 
@@ -288,13 +288,7 @@ namespace casual
                   if( size < result->payload.memory.capacity()) result->payload.memory.shrink_to_fit();
                   // GCC returns null for std::vector::data with size zero
                   result->payload.memory.reserve( size ? size : 1);
-                  return result->handle();
-               }
-
-               common::platform::raw_buffer_type insert( common::buffer::Payload payload)
-               {
-                  m_pool.emplace_back( std::move( payload));
-                  return m_pool.back().payload.memory.data();
+                  return index( result, handle);
                }
 
             };
@@ -76,11 +76,11 @@ namespace casual
 
                common::platform::raw_buffer_type allocate( const common::buffer::Type& type, const common::platform::binary_size_type size)
                {
-                  m_pool.emplace_back( type, size > 0 ? size : 1);
+                  auto buffer = emplace( common::buffer::Payload{ type, common::buffer::Cache::instance().take( size > 0 ? size : 1)});
 
-                  m_pool.back().payload.memory.front() = '\0';
+                  buffer->payload.memory.front() = '\0';
 
-                  return m_pool.back().payload.memory.data();
+                  return index( buffer);
                }
 
                common::platform::raw_buffer_type reallocate( const common::platform::const_raw_buffer_type handle, const common::platform::binary_size_type size)
@@ -91,7 +91,7 @@ namespace casual
 
                   result->payload.memory.back() = '\0';
 
-                  return result->payload.memory.data();
+                  return index( result, handle);
                }
             };
 
@@ -0,0 +1,46 @@
+//
+// repository.cpp
+//
+//  Created on: 18 oct 2016
+//      Author: Kristone
+//
+
+#include "buffer/field/repository.h"
+
+#include "common/environment.h"
+
+#include <stdexcept>
+#include <iostream>
+
+
+int main( int argc, char* argv[])
+{
+   if( argc < 2)
+   {
+      std::cerr << "usage: " << argv[ 0] << " <image> [field-table]" << std::endl;
+      return -1;
+   }
+
+   if( argc > 2)
+   {
+      casual::common::environment::variable::set( "CASUAL_FIELD_TABLE", argv[2]);
+   }
+
+   try
+   {
+      const auto fields = casual::buffer::field::repository::name_to_id();
+
+      casual::buffer::field::repository::image::write( fields, argv[1]);
+
+      std::cout << fields.size() << " fields written to " << argv[1] << std::endl;
+
+      return 0;
+   }
+   catch( const std::exception& e)
+   {
+      std::cerr << e.what() << std::endl;
+   }
+
+   return -1;
+
+}
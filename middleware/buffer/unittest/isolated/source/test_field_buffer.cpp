@@ -9,6 +9,10 @@
 #include <gtest/gtest.h>
 
 #include "buffer/field.h"
+#include "buffer/field/repository.h"
+#include "buffer/field/mapping.h"
+#include "common/file.h"
+#include "common/exception.h"
 #include "common/environment.h"
 #include "common/buffer/type.h"
 #include "common/buffer/pool.h"
@@ -18,6 +22,7 @@
 
 #include <string>
 #include <array>
+#include <cstring>
 
 namespace casual
 {
@@ -748,6 +753,92 @@ namespace casual
          tpfree( buffer);
       }
 
+      TEST( casual_field_buffer, add_interleaved_occurrences_remove_some_and_iterate__expecting_correct_occurrences)
+      {
+         auto buffer = tpalloc( CASUAL_FIELD, "", 512);
+         ASSERT_TRUE( buffer != nullptr);
+
+         for( short value = 0; value < 4; ++value)
+         {
+            EXPECT_TRUE( CasualFieldAddShort( buffer, FLD_SHORT1, value) == CASUAL_FIELD_SUCCESS);
+            EXPECT_TRUE( CasualFieldAddLong( buffer, FLD_LONG1, value * 10) == CASUAL_FIELD_SUCCESS);
+         }
+
+         EXPECT_TRUE( CasualFieldRemoveOccurrence( buffer, FLD_SHORT1, 1) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( CasualFieldRemoveOccurrence( buffer, FLD_LONG1, 0) == CASUAL_FIELD_SUCCESS);
+
+         long occurrences = 0;
+         EXPECT_TRUE( CasualFieldOccurrencesOfId( buffer, FLD_SHORT1, &occurrences) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( occurrences == 3) << occurrences;
+         EXPECT_TRUE( CasualFieldOccurrencesOfId( buffer, FLD_LONG1, &occurrences) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( occurrences == 3) << occurrences;
+
+         short short_value;
+         EXPECT_TRUE( CasualFieldGetShort( buffer, FLD_SHORT1, 1, &short_value) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( short_value == 2) << short_value;
+
+         long long_value;
+         EXPECT_TRUE( CasualFieldGetLong( buffer, FLD_LONG1, 2, &long_value) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( long_value == 30) << long_value;
+
+         //
+         // Buffer is now: S0 L10 S2 L20 S3 L30
+         //
+         const std::vector< std::pair< long, long>> expected{
+            { FLD_SHORT1, 0}, { FLD_LONG1, 0}, { FLD_SHORT1, 1}, { FLD_LONG1, 1}, { FLD_SHORT1, 2}, { FLD_LONG1, 2}};
+
+         long id = CASUAL_FIELD_NO_ID;
+         long occurrence;
+
+         for( auto& field : expected)
+         {
+            EXPECT_TRUE( CasualFieldNext( buffer, &id, &occurrence) == CASUAL_FIELD_SUCCESS);
+            EXPECT_TRUE( id == field.first) << id;
+            EXPECT_TRUE( occurrence == field.second) << occurrence;
+         }
+
+         EXPECT_TRUE( CasualFieldNext( buffer, &id, &occurrence) == CASUAL_FIELD_NO_OCCURRENCE);
+
+         tpfree( buffer);
+      }
+
+      TEST( casual_field_buffer, add_250_occurrences_update_and_remove__expecting_each_found)
+      {
+         auto buffer = tpalloc( CASUAL_FIELD, "", 250 * 64);
+         ASSERT_TRUE( buffer != nullptr);
+
+         for( long value = 0; value < 250; ++value)
+         {
+            EXPECT_TRUE( CasualFieldAddLong( buffer, FLD_LONG1, value) == CASUAL_FIELD_SUCCESS);
+            EXPECT_TRUE( CasualFieldAddString( buffer, FLD_STRING1, std::to_string( value).c_str()) == CASUAL_FIELD_SUCCESS);
+         }
+
+         EXPECT_TRUE( CasualFieldUpdateString( buffer, FLD_STRING1, 100, "a much longer value than before") == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( CasualFieldRemoveOccurrence( buffer, FLD_LONG1, 0) == CASUAL_FIELD_SUCCESS);
+
+         for( long index = 0; index < 249; ++index)
+         {
+            long value;
+            EXPECT_TRUE( CasualFieldGetLong( buffer, FLD_LONG1, index, &value) == CASUAL_FIELD_SUCCESS);
+            EXPECT_TRUE( value == index + 1) << value;
+         }
+
+         for( long index = 0; index < 250; ++index)
+         {
+            const char* value;
+            EXPECT_TRUE( CasualFieldGetString( buffer, FLD_STRING1, index, &value) == CASUAL_FIELD_SUCCESS);
+
+            const auto expected = index == 100 ? std::string{ "a much longer value than before"} : std::to_string( index);
+            EXPECT_TRUE( value == expected) << value;
+         }
+
+         long value;
+         EXPECT_TRUE( CasualFieldGetLong( buffer, FLD_LONG1, 249, &value) == CASUAL_FIELD_NO_OCCURRENCE);
+
+         tpfree( buffer);
+      }
+
+
       TEST( casual_field_buffer, get_pod_size__expecting_correct_sizes)
       {
 
@@ -1076,6 +1167,347 @@ namespace casual
       }
 
 
+      TEST( casual_field_buffer, match_compile_invalid_expressions__expecting_failure)
+      {
+         const void* matcher = nullptr;
+
+         EXPECT_TRUE( CasualFieldMatchCompile( "", &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( "(", &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( "NO_SUCH_FIELD_NAME", &matcher) == CASUAL_FIELD_UNKNOWN_ID);
+
+         const auto string1 = std::to_string( FLD_STRING1);
+         const auto long1 = std::to_string( FLD_LONG1);
+
+         EXPECT_TRUE( CasualFieldMatchCompile( ( string1 + " == 42").c_str(), &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( ( long1 + " == 'abc'").c_str(), &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( ( string1 + " =~ '('").c_str(), &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( ( long1 + " == 1 &&").c_str(), &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( "12", &matcher) == CASUAL_FIELD_INVALID_ID);
+         EXPECT_TRUE( CasualFieldMatchCompile( ( string1 + "[1.5]").c_str(), &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( ( string1 + "[-1]").c_str(), &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( CasualFieldMatchCompile( ( string1 + " == 'a' && \xe9").c_str(), &matcher) == CASUAL_FIELD_INVALID_ARGUMENT);
+      }
+
+      TEST( casual_field_buffer, match_long_beyond_double_precision__expecting_exact_comparison)
+      {
+         auto buffer = tpalloc( CASUAL_FIELD, "", 64);
+         ASSERT_TRUE( buffer != nullptr);
+
+         ASSERT_FALSE( CasualFieldAddLong( buffer, FLD_LONG1, 9007199254740993L));
+
+         const auto long1 = std::to_string( FLD_LONG1);
+
+         const std::vector< std::pair< std::string, bool>> expressions{
+            { long1 + " == 9007199254740993", true},
+            { long1 + " == 9007199254740992", false},
+            { long1 + " > 9007199254740992", true},
+         };
+
+         for( auto& expression : expressions)
+         {
+            const void* matcher = nullptr;
+            ASSERT_TRUE( CasualFieldMatchCompile( expression.first.c_str(), &matcher) == CASUAL_FIELD_SUCCESS) << expression.first;
+
+            int match = -1;
+            EXPECT_TRUE( CasualFieldMatchExecute( buffer, matcher, &match) == CASUAL_FIELD_SUCCESS);
+            EXPECT_TRUE( match == expression.second) << expression.first;
+
+            EXPECT_TRUE( CasualFieldMatchRelease( matcher) == CASUAL_FIELD_SUCCESS);
+         }
+
+         tpfree( buffer);
+      }
+
+      TEST( casual_field_buffer, match_compile_and_execute__expecting_correct_matches)
+      {
+         auto buffer = tpalloc( CASUAL_FIELD, "", 512);
+         ASSERT_TRUE( buffer != nullptr);
+
+         ASSERT_FALSE( CasualFieldAddString( buffer, FLD_STRING1, "First string 1"));
+         ASSERT_FALSE( CasualFieldAddString( buffer, FLD_STRING2, "First string 2"));
+         ASSERT_FALSE( CasualFieldAddString( buffer, FLD_STRING1, "Other string 1"));
+         ASSERT_FALSE( CasualFieldAddFloat( buffer, FLD_FLOAT1, 3.14));
+         ASSERT_FALSE( CasualFieldAddLong( buffer, FLD_LONG1, 42));
+         ASSERT_FALSE( CasualFieldAddChar( buffer, FLD_CHAR1, 'x'));
+
+         const auto string1 = std::to_string( FLD_STRING1);
+         const auto string2 = std::to_string( FLD_STRING2);
+         const auto float1 = std::to_string( FLD_FLOAT1);
+         const auto long1 = std::to_string( FLD_LONG1);
+         const auto char1 = std::to_string( FLD_CHAR1);
+         const auto short1 = std::to_string( FLD_SHORT1);
+
+         const std::vector< std::pair< std::string, bool>> expressions{
+            { string1, true},
+            { short1, false},
+            { "!" + short1, true},
+            { string1 + "[1] == 'Other string 1'", true},
+            { string1 + "[0] == 'Other string 1'", false},
+            { string1 + " == 'Other string 1'", true},
+            { string1 + "[2]", false},
+            { string2 + " =~ \"First.*\"", true},
+            { string2 + " =~ 'string'", false},
+            { float1 + " > 3 && " + float1 + " < 3.2", true},
+            { long1 + " == 42 && " + char1 + " == 'x'", true},
+            { long1 + " != 42 || " + char1 + " == 'y'", false},
+            { "(" + long1 + " >= 43 || " + long1 + " <= 42) && !(" + string1 + " == 'nope')", true},
+         };
+
+         for( auto& expression : expressions)
+         {
+            const void* matcher = nullptr;
+            ASSERT_TRUE( CasualFieldMatchCompile( expression.first.c_str(), &matcher) == CASUAL_FIELD_SUCCESS) << expression.first;
+
+            int match = -1;
+            EXPECT_TRUE( CasualFieldMatchExecute( buffer, matcher, &match) == CASUAL_FIELD_SUCCESS);
+            EXPECT_TRUE( match == expression.second) << expression.first;
+
+            EXPECT_TRUE( CasualFieldMatchRelease( matcher) == CASUAL_FIELD_SUCCESS);
+         }
+
+         tpfree( buffer);
+      }
+
+      TEST( casual_field_buffer, match_execute_with_invalid_buffer__expecting_invalid_buffer)
+      {
+         const void* matcher = nullptr;
+         ASSERT_TRUE( CasualFieldMatchCompile( std::to_string( FLD_LONG1).c_str(), &matcher) == CASUAL_FIELD_SUCCESS);
+
+         int match;
+         EXPECT_TRUE( CasualFieldMatchExecute( nullptr, matcher, &match) == CASUAL_FIELD_INVALID_BUFFER);
+
+         CasualFieldMatchRelease( matcher);
+      }
+
+
+      TEST( casual_field_buffer_repository_image, write_and_map__expecting_all_found)
+      {
+         std::unordered_map< std::string, long> fields{
+            { "FLD_SHORT1", FLD_SHORT1},
+            { "FLD_DOUBLE2", FLD_DOUBLE2},
+         };
+
+         for( long index = 0; index < 10000; ++index)
+         {
+            fields.emplace( "FLD_GENERATED_" + std::to_string( index), CASUAL_FIELD_LONG * CASUAL_FIELD_TYPE_BASE + 10000 + index);
+         }
+
+         common::file::scoped::Path path{ common::file::name::unique( common::directory::temporary() + "/field_repository_", ".image")};
+
+         casual::buffer::field::repository::image::write( fields, path);
+
+         casual::buffer::field::repository::image::Mapping mapping{ path};
+
+         EXPECT_TRUE( mapping.size() == fields.size());
+
+         for( auto& field : fields)
+         {
+            EXPECT_TRUE( mapping.id( field.first.c_str()) == field.second) << field.first;
+            EXPECT_STREQ( mapping.name( field.second), field.first.c_str());
+         }
+
+         EXPECT_TRUE( mapping.id( "NON_EXISTING_NAME") == CASUAL_FIELD_NO_ID);
+         EXPECT_TRUE( mapping.name( 666) == nullptr);
+      }
+
+      TEST( casual_field_buffer_repository_image, write_empty_and_map__expecting_nothing_found)
+      {
+         common::file::scoped::Path path{ common::file::name::unique( common::directory::temporary() + "/field_repository_", ".image")};
+
+         casual::buffer::field::repository::image::write( {}, path);
+
+         casual::buffer::field::repository::image::Mapping mapping{ path};
+
+         EXPECT_TRUE( mapping.size() == 0);
+         EXPECT_TRUE( mapping.id( "FLD_SHORT1") == CASUAL_FIELD_NO_ID);
+         EXPECT_TRUE( mapping.name( FLD_SHORT1) == nullptr);
+      }
+
+      TEST( casual_field_buffer_repository_image, write_duplicated_ids__expecting_invalid_argument)
+      {
+         common::file::scoped::Path path{ common::file::name::unique( common::directory::temporary() + "/field_repository_", ".image")};
+
+         const std::unordered_map<std::string,long> fields{
+            { "FLD_DUPLICATE1", FLD_SHORT1},
+            { "FLD_DUPLICATE2", FLD_SHORT1},
+         };
+
+         EXPECT_THROW({
+            casual::buffer::field::repository::image::write( fields, path);
+         }, common::exception::invalid::Argument);
+      }
+
+      TEST( casual_field_buffer_repository_image, map_non_image__expecting_throw)
+      {
+         EXPECT_THROW({
+            casual::buffer::field::repository::image::Mapping mapping{ "CASUAL_FIELD_TABLE.json"};
+         }, common::exception::invalid::File);
+
+         EXPECT_THROW({
+            casual::buffer::field::repository::image::Mapping mapping{ "/non/existing/file"};
+         }, common::exception::invalid::File);
+      }
+
+
+      namespace
+      {
+         struct Person
+         {
+            char name[ 16];
+            short age;
+            long number;
+            double weight;
+            char grade;
+            char code[ 4];
+            long children[ 2];
+         };
+      }
+
+      TEST( casual_field_buffer_mapping, add_and_get__expecting_same_values_and_one_reallocation)
+      {
+         const CasualFieldMember members[] = {
+            CASUAL_FIELD_MEMBER( Person, name, FLD_STRING1, CASUAL_FIELD_STRING),
+            CASUAL_FIELD_MEMBER( Person, age, FLD_SHORT1, CASUAL_FIELD_SHORT),
+            CASUAL_FIELD_MEMBER( Person, number, FLD_LONG1, CASUAL_FIELD_LONG),
+            CASUAL_FIELD_MEMBER( Person, weight, FLD_DOUBLE1, CASUAL_FIELD_DOUBLE),
+            CASUAL_FIELD_MEMBER( Person, grade, FLD_CHAR1, CASUAL_FIELD_CHAR),
+            CASUAL_FIELD_MEMBER( Person, code, FLD_BINARY1, CASUAL_FIELD_BINARY)};
+
+         const void* mapping = nullptr;
+         ASSERT_TRUE( CasualFieldMappingCompile( members, 6, &mapping) == CASUAL_FIELD_SUCCESS);
+
+         const Person source{ "Charlie", 42, 123456, 78.5, 'B', { 'a', 'b', 'c', 'd'}, {}};
+
+         auto buffer = tpalloc( CASUAL_FIELD, "", 16);
+         ASSERT_TRUE( buffer != nullptr);
+
+         EXPECT_TRUE( CasualFieldMappingAdd( &buffer, mapping, &source) == CASUAL_FIELD_SUCCESS);
+
+         long occurrences = 0;
+         EXPECT_TRUE( CasualFieldOccurrencesInBuffer( buffer, &occurrences) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( occurrences == 6);
+
+         long size = 0, used = 0;
+         EXPECT_TRUE( CasualFieldExploreBuffer( buffer, &size, &used) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( size == used) << "size: " << size << " used: " << used;
+
+         const char* name = nullptr;
+         EXPECT_TRUE( CasualFieldGetString( buffer, FLD_STRING1, 0, &name) == CASUAL_FIELD_SUCCESS);
+         EXPECT_STREQ( name, "Charlie");
+
+         Person target;
+         std::memset( &target, 0xff, sizeof( target));
+         EXPECT_TRUE( CasualFieldMappingGet( buffer, mapping, &target) == CASUAL_FIELD_SUCCESS);
+
+         EXPECT_STREQ( target.name, "Charlie");
+         EXPECT_TRUE( target.age == 42);
+         EXPECT_TRUE( target.number == 123456);
+         EXPECT_TRUE( target.weight == 78.5);
+         EXPECT_TRUE( target.grade == 'B');
+         EXPECT_TRUE( std::memcmp( target.code, "abcd", 4) == 0);
+
+         tpfree( buffer);
+         EXPECT_TRUE( CasualFieldMappingRelease( mapping) == CASUAL_FIELD_SUCCESS);
+      }
+
+      TEST( casual_field_buffer_mapping, get_absent_and_truncated__expecting_zeroed_and_terminated)
+      {
+         struct Short
+         {
+            char name[ 4];
+            short age;
+         };
+
+         const CasualFieldMember members[] = {
+            CASUAL_FIELD_MEMBER( Short, name, FLD_STRING1, CASUAL_FIELD_STRING),
+            CASUAL_FIELD_MEMBER( Short, age, FLD_SHORT1, CASUAL_FIELD_SHORT)};
+
+         const void* mapping = nullptr;
+         ASSERT_TRUE( CasualFieldMappingCompile( members, 2, &mapping) == CASUAL_FIELD_SUCCESS);
+
+         auto buffer = tpalloc( CASUAL_FIELD, "", 128);
+         ASSERT_TRUE( buffer != nullptr);
+         ASSERT_TRUE( CasualFieldAddString( buffer, FLD_STRING1, "Charlie") == CASUAL_FIELD_SUCCESS);
+
+         Short target{ { 'x', 'x', 'x', 'x'}, 666};
+         EXPECT_TRUE( CasualFieldMappingGet( buffer, mapping, &target) == CASUAL_FIELD_SUCCESS);
+         EXPECT_STREQ( target.name, "Cha");
+         EXPECT_TRUE( target.age == 0);
+
+         //
+         // Not terminated within the member, nothing should be added
+         //
+         const Short source{ { 'a', 'b', 'c', 'd'}, 1};
+         EXPECT_TRUE( CasualFieldMappingAdd( &buffer, mapping, &source) == CASUAL_FIELD_INVALID_ARGUMENT);
+
+         long occurrences = 0;
+         EXPECT_TRUE( CasualFieldOccurrencesInBuffer( buffer, &occurrences) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( occurrences == 1);
+
+         tpfree( buffer);
+         CasualFieldMappingRelease( mapping);
+      }
+
+      TEST( casual_field_buffer_mapping, compile_with_mismatching_type__expecting_invalid_id)
+      {
+         const CasualFieldMember members[] = {
+            CASUAL_FIELD_MEMBER( Person, age, FLD_LONG1, CASUAL_FIELD_SHORT)};
+
+         const void* mapping = nullptr;
+         EXPECT_TRUE( CasualFieldMappingCompile( members, 1, &mapping) == CASUAL_FIELD_INVALID_ID);
+         EXPECT_TRUE( mapping == nullptr);
+      }
+
+      TEST( casual_field_buffer_mapping, compile_with_member_size_other_than_native__expecting_invalid_argument)
+      {
+         const CasualFieldMember members[] = {
+            CASUAL_FIELD_MEMBER( Person, age, FLD_LONG1, CASUAL_FIELD_LONG)};
+
+         const void* mapping = nullptr;
+         EXPECT_TRUE( CasualFieldMappingCompile( members, 1, &mapping) == CASUAL_FIELD_INVALID_ARGUMENT);
+         EXPECT_TRUE( mapping == nullptr);
+      }
+
+      TEST( casual_field_buffer_mapping, template_mapping_with_repeated_id__expecting_occurrences)
+      {
+         const CasualFieldMember members[] = {
+            CASUAL_FIELD_MAPPING_MEMBER( Person, name, FLD_STRING2),
+            CASUAL_FIELD_MAPPING_MEMBER( Person, weight, FLD_DOUBLE2),
+            casual::buffer::field::mapping::member< long>( FLD_LONG1, offsetof( Person, children)),
+            casual::buffer::field::mapping::member< long>( FLD_LONG1, offsetof( Person, children) + sizeof( long))};
+
+         const casual::buffer::field::mapping::Mapping< Person> mapping{ members};
+
+         Person source{};
+         std::strcpy( source.name, "Lucy");
+         source.weight = 3.25;
+         source.children[ 0] = 7;
+         source.children[ 1] = 9;
+
+         auto buffer = tpalloc( CASUAL_FIELD, "", 0);
+         ASSERT_TRUE( buffer != nullptr);
+         EXPECT_TRUE( mapping.add( buffer, source) == CASUAL_FIELD_SUCCESS);
+
+         long occurrences = 0;
+         EXPECT_TRUE( CasualFieldOccurrencesOfId( buffer, FLD_LONG1, &occurrences) == CASUAL_FIELD_SUCCESS);
+         EXPECT_TRUE( occurrences == 2);
+
+         Person target{};
+         EXPECT_TRUE( mapping.get( buffer, target) == CASUAL_FIELD_SUCCESS);
+         EXPECT_STREQ( target.name, "Lucy");
+         EXPECT_TRUE( target.weight == 3.25);
+         EXPECT_TRUE( target.children[ 0] == 7);
+         EXPECT_TRUE( target.children[ 1] == 9);
+
+         tpfree( buffer);
+
+         const CasualFieldMember invalid[] = { CASUAL_FIELD_MAPPING_MEMBER( Person, age, FLD_LONG1)};
+         EXPECT_THROW({
+            casual::buffer::field::mapping::Mapping< Person> mapping{ invalid};
+         }, std::invalid_argument);
+      }
+
+
       TEST( casual_field_buffer, performance__expecting_good_enough_speed)
       {
          for( long idx = 0; idx < 100000; ++idx)
@@ -0,0 +1,97 @@
+//!
+//! cache.h
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#ifndef CASUAL_COMMON_BUFFER_CACHE_H_
+#define CASUAL_COMMON_BUFFER_CACHE_H_
+
+#include "common/platform.h"
+
+#include <vector>
+#include <ostream>
+
+namespace casual
+{
+   namespace common
+   {
+      namespace buffer
+      {
+         //!
+         //! Per process cache of buffer memory, so tpalloc/tpfree cycles of similar sizes
+         //! don't hit the heap every time.
+         //!
+         //! Memory is kept in power of 2 size classes, from 64 bytes up to 1MB. Larger
+         //! memory is never cached.
+         //!
+         //! The number of bytes retained is capped, configured with environment variable
+         //! CASUAL_BUFFER_CACHE_LIMIT (bytes), default is 1MB. 0 turns the cache off.
+         //!
+         class Cache
+         {
+         public:
+
+            struct Statistics
+            {
+               //!
+               //! number of memory requests
+               //!
+               std::size_t allocations = 0;
+               std::size_t hits = 0;
+               std::size_t misses = 0;
+
+               //!
+               //! number of memory blocks handed back, and how many of those we did not keep
+               //!
+               std::size_t recycled = 0;
+               std::size_t discarded = 0;
+
+               //!
+               //! bytes currently retained
+               //!
+               std::size_t retained = 0;
+
+               friend std::ostream& operator << ( std::ostream& out, const Statistics& value);
+            };
+
+            static Cache& instance();
+
+            //!
+            //! @return zeroed memory with @p size, and at least the capacity of the size class
+            //!
+            platform::binary_type take( platform::binary_size_type size);
+
+            //!
+            //! Hands back @p memory to the cache, if it fits in a size class and the limit permits
+            //!
+            void recycle( platform::binary_type&& memory);
+
+            std::size_t limit() const;
+
+            //!
+            //! Sets the limit of retained bytes, and discard memory that does not fit
+            //!
+            void limit( std::size_t bytes);
+
+            //!
+            //! discard all retained memory
+            //!
+            void clear();
+
+            const Statistics& statistics() const;
+
+         private:
+            Cache();
+
+            std::vector< std::vector< platform::binary_type>> m_classes;
+            std::size_t m_limit;
+            Statistics m_statistics;
+         };
+
+      } // buffer
+   } // common
+} // casual
+
+#endif // CASUAL_COMMON_BUFFER_CACHE_H_
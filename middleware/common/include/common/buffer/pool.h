@@ -9,6 +9,7 @@
 #define CASUAL_COMMON_BUFFER_POOL_H_
 
 #include "common/buffer/type.h"
+#include "common/buffer/cache.h"
 #include "common/platform.h"
 #include "common/algorithm.h"
 #include "common/exception.h"
@@ -19,6 +20,8 @@
 
 #include <memory>
 #include <map>
+#include <list>
+#include <unordered_map>
 
 // TODO: temp
 #include <sstream>
@@ -170,6 +173,11 @@ namespace casual
                platform::raw_buffer_type m_inbound = nullptr;
                std::vector< std::unique_ptr< Base>> m_pools;
 
+               //!
+               //! Which pool owns the handle
+               //!
+               std::unordered_map< platform::const_raw_buffer_type, Base*> m_handles;
+
                template< typename P>
                friend class Registration;
 
@@ -209,6 +217,8 @@ namespace casual
                Base& find( const Type& type);
                Base& find( platform::const_raw_buffer_type handle);
 
+               platform::raw_buffer_type index( Base& pool, platform::raw_buffer_type handle);
+
                const Payload& null_payload() const;
 
             public:
@@ -233,6 +243,9 @@ namespace casual
                //! inbound buffer (which is 'special' in XATMI). Otherwise it's the same semantics
                //! as insert
                //!
+               //! Unmarshaled payloads already have their memory from the buffer::Cache, and
+               //! it goes back to the cache when deallocated, like all other buffers
+               //!
                platform::raw_buffer_type adopt( Payload&& payload);
 
                platform::raw_buffer_type insert( Payload&& payload);
@@ -249,18 +262,24 @@ namespace casual
             };
 
 
+            //!
+            //! Keeps the buffers in a list (stable positions) and indexes them on handle,
+            //! so all lookups are O(1).
+            //!
+            //! Specializations that adds or changes buffers need to use emplace, index and erase
+            //! so the index stays in sync with the handles.
+            //!
             template< typename B>
             struct basic_pool
             {
                using buffer_type = B;
-               using pool_type = std::vector< buffer_type>;
+               using pool_type = std::list< buffer_type>;
 
                using types_type = std::vector< Type>;
 
                platform::raw_buffer_type allocate( const Type& type, platform::binary_size_type size)
                {
-                  m_pool.emplace_back( type, size);
-                  return m_pool.back().payload.memory.data();
+                  return index( emplace( Payload{ type, Cache::instance().take( size)}));
                }
 
                platform::raw_buffer_type reallocate( platform::const_raw_buffer_type handle, platform::binary_size_type size)
@@ -269,8 +288,20 @@ namespace casual
 
                   if( buffer != std::end( m_pool))
                   {
-                     buffer->payload.memory.resize( size);
-                     return buffer->payload.memory.data();
+                     auto& memory = buffer->payload.memory;
+
+                     if( size > memory.capacity())
+                     {
+                        auto replacement = Cache::instance().take( size);
+                        std::copy( std::begin( memory), std::end( memory), std::begin( replacement));
+                        std::swap( memory, replacement);
+                        Cache::instance().recycle( std::move( replacement));
+                     }
+                     else
+                     {
+                        memory.resize( size);
+                     }
+                     return index( buffer, handle);
                   }
 
                   return nullptr;
@@ -289,15 +320,14 @@ namespace casual
 
                   if( buffer != std::end( m_pool))
                   {
-                     m_pool.erase( buffer);
+                     erase( buffer);
                   }
                }
 
 
                platform::raw_buffer_type insert( Payload payload)
                {
-                  m_pool.emplace_back( std::move( payload));
-                  return m_pool.back().payload.memory.data();
+                  return index( emplace( std::move( payload)));
                }
 
                buffer_type& get( platform::const_raw_buffer_type handle)
@@ -319,6 +349,7 @@ namespace casual
                   if( buffer != std::end( m_pool))
                   {
                      buffer_type result{ std::move( *buffer)};
+                     m_index.erase( handle);
                      m_pool.erase( buffer);
 
                      return result;
@@ -339,12 +370,65 @@ namespace casual
 
             protected:
 
-               typename pool_type::iterator find( platform::const_raw_buffer_type handle)
+               using iterator = typename pool_type::iterator;
+
+               //!
+               //! Adds a buffer to the pool, it's not found until it's indexed
+               //!
+               template< typename... Args>
+               iterator emplace( Args&&... args)
+               {
+                  return m_pool.emplace( std::end( m_pool), std::forward< Args>( args)...);
+               }
+
+               //!
+               //! (re)index the buffer with it's current handle
+               //!
+               //! @param previous the handle the buffer was indexed with before, if any
+               //! @return the current handle
+               //!
+               platform::raw_buffer_type index( iterator buffer, platform::const_raw_buffer_type previous = nullptr)
+               {
+                  if( previous)
+                  {
+                     m_index.erase( previous);
+                  }
+
+                  auto handle = buffer->payload.memory.data();
+
+                  //
+                  // A buffer without memory has no handle the user could use
+                  //
+                  if( handle)
+                  {
+                     m_index[ handle] = buffer;
+                  }
+                  return handle;
+               }
+
+               //!
+               //! Removes the buffer and hands back it's memory to the cache
+               //!
+               void erase( iterator buffer)
+               {
+                  m_index.erase( buffer->payload.memory.data());
+                  Cache::instance().recycle( std::move( buffer->payload.memory));
+                  m_pool.erase( buffer);
+               }
+
+               iterator find( platform::const_raw_buffer_type handle)
                {
-                  return std::find_if( std::begin( m_pool), std::end( m_pool),
-                        [&]( const buffer_type& b){ return b.payload.memory.data() == handle;});
+                  auto found = m_index.find( handle);
+
+                  if( found != std::end( m_index))
+                  {
+                     return found->second;
+                  }
+                  return std::end( m_pool);
                }
+
                pool_type m_pool;
+               std::unordered_map< platform::const_raw_buffer_type, iterator> m_index;
             };
 
             using default_pool = basic_pool< buffer::Buffer>;
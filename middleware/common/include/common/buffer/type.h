@@ -9,6 +9,7 @@
 #define CASUAL_COMMON_BUFFER_TYPE_H_
 
 #include "common/platform.h"
+#include "common/buffer/cache.h"
 
 #include "common/marshal/marshal.h"
 
@@ -81,15 +82,45 @@ namespace casual
             Type type;
             platform::binary_type memory;
 
-            CASUAL_CONST_CORRECT_MARSHAL(
-            {
-               archive & type;
-               archive & memory;
-            })
-
             friend std::ostream& operator << ( std::ostream& out, const Payload& value);
          };
 
+         //!
+         //! Payload is marshaled as any binary, but unmarshaled memory is taken from the
+         //! buffer::Cache, so inbound buffers that are adopted or inserted in the pool
+         //! reuse recycled capacity
+         //!
+         //! @{
+         template< typename M>
+         void casual_marshal_value( const Payload& value, M& marshler)
+         {
+            marshler << value.type;
+            marshler << value.memory;
+         }
+
+         template< typename M>
+         void casual_unmarshal_value( Payload& value, M& unmarshler)
+         {
+            unmarshler >> value.type;
+
+            platform::binary_type::size_type size;
+            unmarshler >> size;
+
+            if( value.null())
+            {
+               //
+               // null payloads never reach the pool, no point in taking cached memory
+               //
+               value.memory.resize( size);
+            }
+            else
+            {
+               value.memory = Cache::instance().take( size);
+            }
+            unmarshler.consume( std::begin( value.memory), size);
+         }
+         //! @}
+
          namespace payload
          {
             struct Send
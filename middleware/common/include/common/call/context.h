@@ -59,16 +59,50 @@ namespace casual
             //!
             bool pending() const;
 
+            //!
+            //! Broker wants a reserved instance back
+            //!
+            void revoke( const message::service::lookup::Revoke& message);
+
+            //!
+            //! Hands back our reservations to broker, the ones in use when their calls are done.
+            //!
+            //! Used when the process goes idle (back to its message pump), since we don't
+            //! know when, or if, we call again.
+            //!
+            void release();
+
          private:
 
 
             Context();
 
+            //!
+            //! Calls the reserved instance directly, without broker
+            //!
+            descriptor_type reserved( State::Reservations::Reservation& reservation, char* idata, long ilen, long flags);
+
             bool receive( message::service::call::Reply& reply, descriptor_type descriptor, long flags);
 
             State m_state;
 
          };
+
+         namespace handle
+         {
+            //!
+            //! Handles revokes of reserved instances, for processes that have a message pump
+            //!
+            struct Revoke
+            {
+               using message_type = message::service::lookup::Revoke;
+
+               void operator () ( message_type& message)
+               {
+                  Context::instance().revoke( message);
+               }
+            };
+         } // handle
       } // call
 	} // common
 } // casual
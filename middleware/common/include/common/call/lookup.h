@@ -25,6 +25,13 @@ namespace casual
             {
                Lookup( std::string service);
                Lookup( std::string service, message::service::lookup::Request::Context context);
+
+               //!
+               //! @param reserve if true, ask broker to reserve the instance for us
+               //! @param expire if true, we have our own deadline and broker may drop the request when it
+               //!   has been pending longer than the service timeout, otherwise broker keeps it until an instance is idle
+               //!
+               Lookup( std::string service, message::service::lookup::Request::Context context, bool reserve, bool expire = false);
                ~Lookup();
                message::service::lookup::Reply operator () () const;
             private:
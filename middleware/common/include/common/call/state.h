@@ -15,6 +15,11 @@
 #include "common/platform.h"
 #include "common/uuid.h"
 
+#include "common/message/service.h"
+
+#include <queue>
+#include <unordered_map>
+
 namespace casual
 {
    namespace common
@@ -46,7 +51,11 @@ namespace casual
                Pending();
 
                //!
-               //! Reserves a descriptor and associates it to message-correlation
+               //! Reserves a descriptor and associates it to message-correlation.
+               //!
+               //! Descriptors lives in a slab indexed by descriptor, and released descriptors
+               //! are reused lowest first, so get/active/deadline are constant time regardless
+               //! of the number of outstanding calls.
                //!
                Descriptor& reserve( const Uuid& correlation);
 
@@ -56,6 +65,11 @@ namespace casual
 
                const Descriptor& get( descriptor_type descriptor) const;
 
+               //!
+               //! @return the active descriptor that is associated with @p correlation, 0 if none
+               //!
+               descriptor_type descriptor( const Uuid& correlation) const;
+
                //!
                //! Tries to discard descriptor, throws if fail.
                //!
@@ -73,10 +87,102 @@ namespace casual
 
                Descriptor& reserve();
 
+               Descriptor* find( descriptor_type descriptor);
+               const Descriptor* find( descriptor_type descriptor) const;
+
+               //!
+               //! descriptor n is stored at index n - 1
+               //!
                std::vector< Descriptor> m_descriptors;
+               std::priority_queue< descriptor_type, std::vector< descriptor_type>, std::greater< descriptor_type>> m_free;
+               std::unordered_map< Uuid, descriptor_type> m_correlations;
+               std::size_t m_active = 0;
 
             } pending;
 
+            //!
+            //! Instances the broker has reserved for this caller. As long as a reservation
+            //! is not in use we call the instance directly, without asking the broker.
+            //!
+            struct Reservations
+            {
+               struct Reservation
+               {
+                  Reservation( message::Service service, process::Handle process)
+                    : service( std::move( service)), process( std::move( process)) {}
+
+                  message::Service service;
+                  process::Handle process;
+
+                  //!
+                  //! descriptor of the call in progress, 0 if free (and 0 is used for TPNOREPLY,
+                  //! which we never do with a reservation)
+                  //!
+                  descriptor_type descriptor = 0;
+
+                  std::uint64_t invoked = 0;
+
+                  //!
+                  //! broker wants the instance back, when the current call is done
+                  //!
+                  bool revoked = false;
+
+                  bool free() const { return descriptor == 0 && ! revoked;}
+               };
+
+               //!
+               //! @return true if we should ask broker for reservations
+               //!
+               //! Configured with environment variable CASUAL_CALL_RESERVATION (1 to reserve), default is 0.
+               //!
+               static bool active();
+               static void active( bool value);
+
+               //!
+               //! @return a free reservation for @p service, nullptr if there are none
+               //!
+               Reservation* find( const std::string& service);
+
+               Reservation& add( message::Service service, process::Handle process);
+
+               //!
+               //! Associate @p reservation with the call @p descriptor
+               //!
+               void use( Reservation& reservation, descriptor_type descriptor);
+
+               //!
+               //! The call with @p descriptor is done, releases the reservation to the broker if it's revoked
+               //!
+               void done( descriptor_type descriptor);
+
+               //!
+               //! The call with @p descriptor will not be replied to us (cancel, timeout), we can't
+               //! use the instance any more, releases the reservation to the broker
+               //!
+               void discard( descriptor_type descriptor);
+
+               //!
+               //! Consumes all revokes that the broker has sent to us
+               //!
+               void revoke();
+               void revoke( const message::service::lookup::Revoke& message);
+
+               //!
+               //! Releases all free reservations
+               //!
+               void release();
+
+               std::size_t size() const { return m_reservations.size();}
+               bool empty() const { return m_reservations.empty();}
+
+            private:
+
+               void release( std::vector< Reservation>::iterator found);
+
+               std::vector< Reservation> m_reservations;
+
+            } reservations;
+
             long user_code = 0;
          };
 
@@ -13,6 +13,11 @@
 
 #include "common/marshal/binary.h"
 
+#include <list>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
 namespace casual
 {
    namespace common
@@ -74,6 +79,168 @@ namespace casual
 
          namespace inbound
          {
+            //!
+            //! Holds received messages, complete or not, in arrival order.
+            //!
+            //! Indexed by correlation and by message type, so lookups and erase
+            //! does not depend on the number of cached messages.
+            //!
+            class Cache
+            {
+            public:
+               using complete_type = message::Complete;
+               using message_type = typename complete_type::message_type_type;
+
+               struct Statistics
+               {
+                  //!
+                  //! Number of messages in the cache
+                  //!
+                  std::size_t depth = 0;
+
+                  //!
+                  //! The highest depth the cache has had
+                  //!
+                  std::size_t high = 0;
+
+                  //!
+                  //! Number of transports that has been cached
+                  //!
+                  std::size_t transports = 0;
+
+                  //!
+                  //! Number of transports that did not arrive in order
+                  //!
+                  std::size_t out_of_order = 0;
+
+                  friend std::ostream& operator << ( std::ostream& out, const Statistics& value);
+               };
+
+               Cache();
+               ~Cache();
+
+               Cache( Cache&&);
+               Cache& operator = ( Cache&&);
+
+               //!
+               //! Adds the transport to the message it belongs to, or creates a new message
+               //!
+               //! @return the message the transport was added to
+               //!
+               template< typename T>
+               const complete_type& add( T& transport)
+               {
+                  ++m_statistics.transports;
+
+                  auto& header = transport.message.header;
+
+                  auto found = m_correlations.find( Uuid{ header.correlation});
+
+                  //
+                  // The transport belongs to the latest message with the correlation, unless
+                  // that one is complete already
+                  //
+                  if( found == std::end( m_correlations) || found->second.back()->message.complete())
+                  {
+                     if( header.offset != 0)
+                     {
+                        ++m_statistics.out_of_order;
+                     }
+
+                     auto& entry = insert( complete_type{ transport});
+                     entry.offset = header.offset + header.count;
+                     return entry.message;
+                  }
+
+                  auto& entry = *found->second.back();
+
+                  if( header.offset != entry.offset)
+                  {
+                     ++m_statistics.out_of_order;
+                  }
+                  entry.offset = header.offset + header.count;
+                  entry.message.add( transport);
+
+                  return entry.message;
+               }
+
+               //!
+               //! Push a message (complete) to the cache
+               //!
+               void push( complete_type&& message);
+
+               //!
+               //! Extracts the first complete message
+               //!
+               //! @return the message if found, otherwise the message has absent_message as type
+               //! @{
+               complete_type extract();
+               complete_type extract( message_type type);
+               complete_type extract( const std::vector< message_type>& types);
+               complete_type extract( const Uuid& correlation);
+               //! @}
+
+               //!
+               //! @return the latest message, complete or not, with @p correlation. nullptr if absent
+               //!
+               const complete_type* find( const Uuid& correlation) const;
+
+               //!
+               //! Erase all messages, complete or not, with @p correlation
+               //!
+               void erase( const Uuid& correlation);
+
+               const Statistics& statistics() const { return m_statistics;}
+
+               std::size_t size() const { return m_statistics.depth;}
+               bool empty() const { return m_statistics.depth == 0;}
+
+            private:
+
+               struct Entry;
+               using entries_type = std::list< Entry>;
+               using position_type = typename entries_type::iterator;
+               using positions_type = std::list< position_type>;
+
+               struct Entry
+               {
+                  Entry( complete_type&& message, std::uint64_t sequence);
+
+                  complete_type message;
+
+                  //!
+                  //! arrival order
+                  //!
+                  std::uint64_t sequence;
+
+                  //!
+                  //! next expected offset, to detect out of order transports
+                  //!
+                  std::uint64_t offset = 0;
+
+                  typename positions_type::iterator type;
+                  typename positions_type::iterator correlation;
+               };
+
+               struct Hash
+               {
+                  std::size_t operator() ( message_type type) const { return static_cast< std::size_t>( type);}
+               };
+
+               Entry& insert( complete_type&& message);
+               complete_type extract( position_type position);
+
+               entries_type m_entries;
+               //!
+               //! Several messages can have the same correlation, in arrival order
+               //!
+               std::unordered_map< Uuid, positions_type> m_correlations;
+               std::unordered_map< message_type, positions_type, Hash> m_types;
+
+               std::uint64_t m_sequence = 0;
+               Statistics m_statistics;
+            };
+
 
             template< typename Connector, typename Unmarshal = marshal::binary::create::Input>
             struct Device
@@ -109,7 +276,9 @@ namespace casual
                {
                   return find_complete(
                         std::forward< P>( policy),
-                        handler);
+                        handler,
+                        [&](){ return m_cache.extract();},
+                        []( const complete_type& m){ return true;});
                }
 
                //!
@@ -124,6 +293,7 @@ namespace casual
                   return find_complete(
                         std::forward< P>( policy),
                         handler,
+                        [&](){ return m_cache.extract( type);},
                         [=]( const complete_type& m){ return m.type == type;});
                }
 
@@ -139,6 +309,7 @@ namespace casual
                   return find_complete(
                         std::forward< P>( policy),
                         handler,
+                        [&](){ return m_cache.extract( types);},
                         [&]( const complete_type& m){ return ! range::find( types, m.type).empty();});
                }
 
@@ -154,6 +325,7 @@ namespace casual
                   return find_complete(
                         std::forward< P>( policy),
                         handler,
+                        [&](){ return m_cache.extract( correlation);},
                         [&]( const complete_type& m){ return m.correlation == correlation;});
                }
 
@@ -203,24 +375,19 @@ namespace casual
                //!
                void discard( const Uuid& correlation)
                {
-                  auto complete = range::find_if( m_cache, [&]( const complete_type& m){ return m.correlation == correlation;});
+                  auto complete = m_cache.find( correlation);
 
                   if( complete)
                   {
                      if( ! complete->complete())
                      {
-                        m_discarded.push_back( correlation);
+                        m_discarded.insert( correlation);
                      }
-                     m_cache.erase( complete.begin());
+                     m_cache.erase( correlation);
                   }
                   else
                   {
-                     auto found = range::find( m_discarded, correlation);
-
-                     if( ! found)
-                     {
-                        m_discarded.push_back( correlation);
-                     }
+                     m_discarded.insert( correlation);
                   }
                }
 
@@ -233,8 +400,9 @@ namespace casual
                //!
                inline Uuid put( message::Complete&& message)
                {
-                  m_cache.push_back( std::move( message));
-                  return message.correlation;
+                  auto correlation = message.correlation;
+                  m_cache.push( std::move( message));
+                  return correlation;
                }
 
                template< typename M>
@@ -252,10 +420,12 @@ namespace casual
                connector_type& connector() { return m_connector;}
                const connector_type& connector() const { return m_connector;}
 
-            private:
+               //!
+               //! @return the cache of received messages, mostly to get hold of statistics
+               //!
+               const Cache& cache() const { return m_cache;}
 
-               using cache_type = std::vector< complete_type>;
-               using range_type = decltype( range::make( cache_type::iterator(), 0));
+            private:
 
                template< typename C, typename M>
                bool unmarshal( C&& complete, M& message)
@@ -295,68 +465,49 @@ namespace casual
                }
 
 
-               template< typename Policy, typename Predicate>
-               range_type find( Policy&& policy, const error_type& handler, Predicate&& predicate)
+               //!
+               //! @param extract extracts a matching complete message from the cache
+               //! @param predicate checks if a new complete message matches
+               //!
+               template< typename Policy, typename Extract, typename Predicate>
+               complete_type find_complete( Policy&& policy, const error_type& handler, Extract&& extract, Predicate&& predicate)
                {
-                  transport_type transport;
+                  auto result = extract();
 
-                  auto found = range::find_if( m_cache, predicate);
+                  transport_type transport;
 
-                  while( ! found && apply( std::forward< Policy>( policy), transport, handler))
+                  while( ! result && apply( std::forward< Policy>( policy), transport, handler))
                   {
                      //
                      // Check if the message should be discarded
                      //
                      if( ! discard( transport))
                      {
-                        cache( transport);
-                        found = range::find_if( m_cache, predicate);
-                     }
-                  }
-                  return found;
-               }
-
-               template< typename Policy, typename... Predicates>
-               complete_type find_complete( Policy&& policy, const error_type& handler, Predicates&&... predicates)
-               {
-                  auto found = find(
-                        std::forward< Policy>( policy),
-                        handler,
-                        chain::And::link(
-                              []( const message::Complete& m){ return m.complete();},
-                              std::forward< Predicates>( predicates)...));
-
-                  if( found)
-                  {
-                     auto result = std::move( *found);
-                     m_cache.erase( found.begin());
-                     return result;
-                  }
-                  return {};
-               }
-
-
-               void cache( transport_type& transport)
-               {
-                  auto found = range::find_if( m_cache,
-                        [&]( const complete_type& m){ return transport.message.header.correlation == m.correlation;});
+                        //
+                        // Only the message that the transport belongs to can be a new match
+                        //
+                        auto& message = m_cache.add( transport);
 
-                  if( found)
-                  {
-                     found->add( transport);
-                  }
-                  else
-                  {
-                     m_cache.emplace_back( transport);
+                        if( message.complete() && predicate( message))
+                        {
+                           result = m_cache.extract( message.correlation);
+                        }
+                     }
                   }
+                  return result;
                }
 
                bool discard( transport_type& transport)
                {
-                  auto found = range::find( m_discarded, transport.message.header.correlation);
+                  auto found = m_discarded.find( Uuid{ transport.message.header.correlation});
 
-                  if( found)
+                  if( found != std::end( m_discarded))
                   {
+                     if( transport.segment())
+                     {
+                        message::segment::remove( transport.descriptor());
+                     }
+
                      //
                      // If transport is the last part in the message, we don't need to
                      // discard any more transports...
@@ -367,15 +518,15 @@ namespace casual
                      //
                      if( transport.last())
                      {
-                        m_discarded.erase( std::begin( found));
+                        m_discarded.erase( found);
                      }
                      return true;
                   }
                   return false;
                }
 
-               cache_type m_cache;
-               std::vector< Uuid> m_discarded;
+               Cache m_cache;
+               std::unordered_set< Uuid> m_discarded;
                connector_type m_connector;
             };
 
@@ -383,6 +534,24 @@ namespace casual
 
          namespace outbound
          {
+            namespace connector
+            {
+               //!
+               //! @return the ipc-queue that owns the segments sent through @p connector, -1 if
+               //!   the connector is not an ipc-queue
+               //!
+               //! @{
+               template< typename C>
+               auto owner( const C& connector, int) -> decltype( platform::queue_id_type{ connector.id()})
+               {
+                  return connector.id();
+               }
+
+               template< typename C>
+               platform::queue_id_type owner( const C&, long) { return -1;}
+               //! @}
+
+            } // connector
 
             //!
             //! Doesn't do much. More for symmetry with inbound
@@ -417,6 +586,13 @@ namespace casual
                   message.correlation.copy( transport.message.header.correlation);
                   transport.message.header.complete_size = message.payload.size();
 
+                  auto threshold = message::segment::threshold();
+
+                  if( threshold > 0 && message.payload.size() > threshold)
+                  {
+                     return put_segment( message, transport, policy, handler);
+                  }
+
                   auto part_begin = std::begin( message.payload);
 
                   do
@@ -450,24 +626,90 @@ namespace casual
                //!
                template< typename M, typename P>
                Uuid send( M& message, P&& policy, const error_type& handler = nullptr)
+               {
+                  using archive_type = decltype( marshal_type{}( std::declval< platform::binary_type&>()));
+                  return send( message, std::forward< P>( policy), handler, static_cast< archive_type*>( nullptr));
+               }
+
+            private:
+
+               //!
+               //! We don't know how the archive writes, marshal to a complete message and send it
+               //!
+               template< typename M, typename P, typename A>
+               Uuid send( M& message, P&& policy, const error_type& handler, A*)
+               {
+                  return put(
+                        marshal::complete( message, marshal_type{}),
+                        std::forward< P>( policy),
+                        handler);
+               }
+
+               //!
+               //! Marshal straight into the transports, unless the message is
+               //! large enough to go through a segment
+               //!
+               template< typename M, typename P, typename MP>
+               Uuid send( M& message, P&& policy, const error_type& handler, marshal::binary::basic_output< MP>*)
                {
                   if( ! message.execution)
                   {
                      message.execution = execution::id();
                   }
 
-                  message::Complete complete( message.type(), message.correlation ? message.correlation : uuid::make());
+                  const auto size = marshal::binary::size< MP>( message);
 
-                  auto marshal = marshal_type()( complete.payload);
-                  marshal << message;
+                  auto threshold = message::segment::threshold();
 
-                  return put(
-                        complete,
-                        std::forward< P>( policy),
-                        handler);
+                  if( threshold > 0 && size > threshold)
+                  {
+                     return put(
+                           marshal::complete( message, marshal_type{}),
+                           std::forward< P>( policy),
+                           handler);
+                  }
+
+                  const auto correlation = message.correlation ? message.correlation : uuid::make();
+
+                  transport_type transport;
+                  transport.type( message.type());
+                  correlation.copy( transport.message.header.correlation);
+                  transport.message.header.complete_size = size;
+
+                  auto output = marshal::binary::transport::output< MP>( transport, [&]( const transport_type& transport){
+                     return apply( policy, transport, handler);
+                  });
+
+                  output << message;
+
+                  if( ! output.flush())
+                  {
+                     return uuid::empty();
+                  }
+
+                  return correlation;
                }
 
-            private:
+               template< typename Policy>
+               Uuid put_segment( const message::Complete& message, transport_type& transport, Policy&& policy, const error_type& handler)
+               {
+                  auto descriptor = message::segment::create( message.payload, connector::owner( m_connector, 0));
+
+                  //
+                  // If we fail to send, no one will consume the segment
+                  //
+                  scope::Execute remove{ [&](){ message::segment::remove( descriptor);}};
+
+                  transport.segment( descriptor);
+
+                  if( ! apply( policy, transport, handler))
+                  {
+                     return uuid::empty();
+                  }
+
+                  remove.release();
+                  return message.correlation;
+               }
 
                template< typename Policy>
                bool apply( Policy&& policy, const transport_type& transport, const error_type& handler)
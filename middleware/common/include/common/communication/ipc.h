@@ -12,6 +12,8 @@
 #include "common/communication/message.h"
 #include "common/communication/device.h"
 
+#include <memory>
+
 namespace casual
 {
    namespace common
@@ -49,6 +51,8 @@ namespace casual
 
             namespace inbound
             {
+               struct Notify;
+
                struct Connector
                {
                   using handle_type = ipc::handle_type;
@@ -66,6 +70,26 @@ namespace casual
 
                   handle_type id() const { return m_id;}
 
+                  //!
+                  //! Enables (if not already) a descriptor that is readable when there are transports
+                  //! queued for this connector, so the connector can be used with select/poll/epoll.
+                  //!
+                  //! When enabled, a worker thread moves transports from the ipc-queue to the connector,
+                  //! up to platform::notify_transports, after that the ipc-queue fills up as usual.
+                  //!
+                  //! The descriptor is edge-triggered, it's signaled when new transports arrive and
+                  //! drained when they're received. Messages the device already has cached does not
+                  //! signal it, hence the owner shall fetch all it's waiting for when woken up.
+                  //!
+                  //! @return the descriptor
+                  //!
+                  int descriptor();
+
+                  //!
+                  //! Receives a transport, from the ipc-queue or from the worker if descriptor is enabled
+                  //!
+                  bool receive( message::Transport& transport, long flags);
+
                   friend void swap( Connector& lhs, Connector& rhs);
 
                   friend std::ostream& operator << ( std::ostream& out, const Connector& rhs) { return out << "{ id: " << rhs.m_id << '}';}
@@ -78,6 +102,7 @@ namespace casual
                   };
 
                   handle_type m_id = cInvalid;
+                  std::unique_ptr< Notify> m_notify;
                };
 
 
@@ -289,6 +314,9 @@ namespace casual
 
             bool exists( handle_type id);
 
+            //!
+            //! Removes the ipc-queue, and the segments it owns
+            //!
             bool remove( handle_type id);
             bool remove( const process::Handle& owner);
 
@@ -16,6 +16,7 @@
 
 #include <cstdint>
 #include <array>
+#include <vector>
 
 namespace casual
 {
@@ -27,6 +28,66 @@ namespace casual
 
          namespace message
          {
+            //!
+            //! Payloads larger than the threshold is not split into transports, instead
+            //! the payload is written to a shared memory segment and only a descriptor
+            //! is sent in one transport.
+            //!
+            //! The payload is copied twice, written to the segment by the sender and copied
+            //! out of the mapping by the receiver. That's deliberate, Complete::payload is a vector
+            //! that the message (and later the buffer pool) owns, and it can't be backed by a
+            //! mapping. Still fewer copies and system calls than one transport per 8KB.
+            //!
+            //! A segment is owned by the ipc-queue it's sent to, and is removed together with
+            //! the queue, see ipc::remove. A domain removes segments of queues that are gone
+            //! when it starts, in case the owner died before the queue was removed.
+            //!
+            namespace segment
+            {
+               //!
+               //! @return the size where payloads is transported out-of-band, 0 if disabled.
+               //!
+               //! defaults to environment variable CASUAL_TRANSPORT_SEGMENT_THRESHOLD, or 256KB if not set
+               //!
+               std::size_t threshold();
+               void threshold( std::size_t size);
+
+               struct Descriptor
+               {
+                  Uuid::uuid_type id;
+                  std::uint64_t size;
+                  platform::queue_id_type owner;
+               };
+
+               //!
+               //! Creates a segment, owned by @p owner, and writes @p payload to it
+               //!
+               //! @param owner the ipc-queue the segment is sent to, -1 if there is none
+               //!
+               Descriptor create( const platform::binary_type& payload, platform::queue_id_type owner);
+
+               //!
+               //! Reads the segment into @p payload and removes the segment
+               //!
+               void consume( const Descriptor& descriptor, platform::binary_type& payload);
+
+               //!
+               //! Removes the segment without reading it
+               //!
+               void remove( const Descriptor& descriptor);
+
+               //!
+               //! Removes all segments owned by @p owner
+               //!
+               void clear( platform::queue_id_type owner);
+
+               //!
+               //! @return the owners of all existing segments
+               //!
+               std::vector< platform::queue_id_type> owners();
+
+            } // segment
+
             // common::platform::message_size
 
             template< std::size_t message_size>
@@ -55,6 +116,16 @@ namespace casual
                   //! size of the logical complete message
                   //!
                   std::uint64_t complete_size;
+
+                  //!
+                  //! Flags, ie. if the payload is a segment descriptor
+                  //!
+                  std::uint64_t flags;
+               };
+
+               enum Flag : std::uint64_t
+               {
+                  c_segment = 1
                };
 
                enum
@@ -87,7 +158,11 @@ namespace casual
                static_assert( sizeof( message_t) - sizeof( message_type_type) == message_max_size, "something is wrong with padding");
 
 
-               basic_transport() { memory::set( message);}
+               //!
+               //! Only the header is cleared, the payload is written before it's used
+               //! and only header_size + count is sent
+               //!
+               basic_transport() { message.type = 0; memory::set( message.header);}
                basic_transport( common::message::Type type) : basic_transport() { basic_transport::type( type);}
 
 
@@ -123,7 +198,36 @@ namespace casual
                //!
                //! @attention this gives not any guarantees that no more transport messages will arrive...
                //!
-               bool last() const { return message.header.offset + message.header.count == message.header.complete_size;}
+               bool last() const { return segment() || message.header.offset + message.header.count == message.header.complete_size;}
+
+               //!
+               //! @return true if the payload of this transport message is a segment::Descriptor
+               //!
+               bool segment() const { return message.header.flags & c_segment;}
+
+               //!
+               //! Sets a segment descriptor as the payload, that represent the whole logical message
+               //!
+               void segment( const segment::Descriptor& descriptor)
+               {
+                  message.header.flags |= c_segment;
+                  message.header.offset = 0;
+                  message.header.complete_size = descriptor.size;
+                  message.header.count = sizeof( segment::Descriptor);
+                  memory::copy( range::make( reinterpret_cast< const char*>( &descriptor), sizeof( segment::Descriptor)),
+                        range::make( std::begin( message.payload), sizeof( segment::Descriptor)));
+               }
+
+               //!
+               //! @return the segment descriptor, only valid if segment() is true
+               //!
+               segment::Descriptor descriptor() const
+               {
+                  segment::Descriptor result;
+                  memory::copy( range::make( std::begin( message.payload), sizeof( segment::Descriptor)),
+                        range::make( reinterpret_cast< char*>( &result), sizeof( segment::Descriptor)));
+                  return result;
+               }
 
 
                template< typename Iter>
@@ -163,6 +267,7 @@ namespace casual
                      << ", offset: " << value.message.header.offset
                      << ", count: " << value.message.header.count
                      << ", complete_size: " << value.message.header.complete_size
+                     << ", flags: " << value.message.header.flags
                      << ", header-size: " << transport_type::header_size
                      << ", max-size: " << transport_type::message_max_size << "}";
             }
@@ -211,6 +316,16 @@ namespace casual
                {
                   assert( payload.size() == transport.message.header.complete_size);
 
+                  if( transport.segment())
+                  {
+                     //
+                     // The whole payload is in the segment
+                     //
+                     segment::consume( transport.descriptor(), payload);
+                     m_unhandled.clear();
+                     return;
+                  }
+
                   auto source = transport.payload();
                   auto destination = range::make( std::begin( payload) + transport.message.header.offset, source.size());
 
@@ -0,0 +1,244 @@
+//!
+//! shared.h
+//!
+//! Created on: Oct 17, 2016
+//!     Author: Lazan
+//!
+
+#ifndef CASUAL_MIDDLEWARE_COMMON_INCLUDE_COMMON_COMMUNICATION_SHARED_H_
+#define CASUAL_MIDDLEWARE_COMMON_INCLUDE_COMMON_COMMUNICATION_SHARED_H_
+
+
+#include "common/communication/ipc.h"
+
+#include <memory>
+
+namespace casual
+{
+   namespace common
+   {
+
+      namespace communication
+      {
+         //!
+         //! Connectors that use a shared memory ring buffer instead of SysV ipc-queues.
+         //!
+         //! Each inbound connector owns one ring (many producers, one consumer) and
+         //! waiting is done with futexes, hence no syscall is needed as long as
+         //! neither side has to wait.
+         //!
+         //! Uses the same transport as ipc, so the devices semantics is the same.
+         //!
+         namespace shared
+         {
+            namespace message
+            {
+               using Transport = ipc::message::Transport;
+            } // message
+
+            using handle_type = Uuid;
+
+            namespace ring
+            {
+               //!
+               //! Default number of transports a ring can hold
+               //!
+               constexpr std::size_t capacity = 64;
+
+               struct Segment;
+            } // ring
+
+            namespace inbound
+            {
+               struct Connector;
+            } // inbound
+
+            namespace outbound
+            {
+               struct Connector;
+            } // outbound
+
+            namespace native
+            {
+               enum Flags
+               {
+                  c_non_blocking = platform::cIPC_NO_WAIT
+               };
+
+               bool send( const outbound::Connector& ring, const message::Transport& transport, long flags);
+               bool receive( inbound::Connector& ring, message::Transport& transport, long flags);
+
+            } // native
+
+            namespace inbound
+            {
+               struct Connector
+               {
+                  using handle_type = shared::handle_type;
+                  using transport_type = shared::message::Transport;
+
+                  Connector();
+
+                  //!
+                  //! @param capacity number of transports the ring can hold, rounded up to the nearest power of 2
+                  //!
+                  explicit Connector( std::size_t capacity);
+                  ~Connector();
+
+                  Connector( const Connector&) = delete;
+                  Connector& operator = ( const Connector&) = delete;
+
+                  Connector( Connector&& rhs) noexcept;
+                  Connector& operator = ( Connector&& rhs) noexcept;
+
+                  const handle_type& id() const { return m_id;}
+
+                  friend void swap( Connector& lhs, Connector& rhs);
+
+                  friend std::ostream& operator << ( std::ostream& out, const Connector& rhs) { return out << "{ id: " << rhs.m_id << '}';}
+
+               private:
+                  friend bool native::receive( Connector& ring, message::Transport& transport, long flags);
+
+                  handle_type m_id;
+                  std::unique_ptr< ring::Segment> m_segment;
+               };
+
+               using Device = communication::inbound::Device< Connector>;
+
+            } // inbound
+
+            namespace outbound
+            {
+               //!
+               //! Maps the ring of the inbound connector with @p id. Copies share the same mapping,
+               //! so it's cheap to pass the connector (and device) by value
+               //!
+               struct Connector
+               {
+                  using handle_type = shared::handle_type;
+                  using transport_type = shared::message::Transport;
+
+                  Connector( const handle_type& id);
+
+                  const handle_type& id() const { return m_id;}
+
+                  friend std::ostream& operator << ( std::ostream& out, const Connector& rhs) { return out << "{ id: " << rhs.m_id << '}';}
+
+               private:
+                  friend bool native::send( const Connector& ring, const message::Transport& transport, long flags);
+
+                  handle_type m_id;
+                  std::shared_ptr< ring::Segment> m_segment;
+               };
+
+               using Device = communication::outbound::Device< Connector>;
+            } // outbound
+
+            namespace policy
+            {
+               struct basic_blocking
+               {
+                  bool operator() ( inbound::Connector& ring, message::Transport& transport);
+                  bool operator() ( const outbound::Connector& ring, const message::Transport& transport);
+               };
+
+               using Blocking = ipc::policy::basic_prefix< ipc::policy::prefix::Signal, basic_blocking>;
+
+               namespace non
+               {
+                  struct basic_blocking
+                  {
+                     bool operator() ( inbound::Connector& ring, message::Transport& transport);
+                     bool operator() ( const outbound::Connector& ring, const message::Transport& transport);
+                  };
+
+                  using Blocking = ipc::policy::basic_prefix< ipc::policy::prefix::Signal, basic_blocking>;
+               } // non
+
+               namespace ignore
+               {
+                  namespace signal
+                  {
+                     using Blocking = ipc::policy::basic_prefix< ipc::policy::prefix::ignore::Signal, basic_blocking>;
+
+                     namespace non
+                     {
+                        using Blocking = ipc::policy::basic_prefix< ipc::policy::prefix::ignore::Signal, policy::non::basic_blocking>;
+                     } // non
+
+                  } // signal
+               } // ignore
+
+            } // policy
+
+            namespace blocking
+            {
+               using error_type = typename inbound::Device::error_type;
+
+               template< typename M>
+               void receive( inbound::Device& ring, M& message, const error_type& handler = nullptr)
+               {
+                  ring.receive( message, policy::Blocking{}, handler);
+               }
+
+               template< typename M>
+               bool receive( inbound::Device& ring, M& message, const Uuid& correlation, const error_type& handler = nullptr)
+               {
+                  return ring.receive( message, correlation, policy::Blocking{}, handler);
+               }
+
+               inline communication::message::Complete next( inbound::Device& ring, const error_type& handler = nullptr)
+               {
+                  return ring.next( policy::Blocking{}, handler);
+               }
+
+               template< typename M>
+               Uuid send( outbound::Device& ring, M&& message, const error_type& handler = nullptr)
+               {
+                  return ring.send( message, policy::Blocking{}, handler);
+               }
+
+            } // blocking
+
+            namespace non
+            {
+               namespace blocking
+               {
+                  using error_type = typename inbound::Device::error_type;
+
+                  template< typename M>
+                  bool receive( inbound::Device& ring, M& message, const error_type& handler = nullptr)
+                  {
+                     return ring.receive( message, policy::non::Blocking{}, handler);
+                  }
+
+                  template< typename M>
+                  bool receive( inbound::Device& ring, M& message, const Uuid& correlation, const error_type& handler = nullptr)
+                  {
+                     return ring.receive( message, correlation, policy::non::Blocking{}, handler);
+                  }
+
+                  inline communication::message::Complete next( inbound::Device& ring, const error_type& handler = nullptr)
+                  {
+                     return ring.next( policy::non::Blocking{}, handler);
+                  }
+
+                  template< typename M>
+                  Uuid send( outbound::Device& ring, M&& message, const error_type& handler = nullptr)
+                  {
+                     return ring.send( message, policy::non::Blocking{}, handler);
+                  }
+
+               } // blocking
+            } // non
+
+            bool exists( const handle_type& id);
+
+         } // shared
+
+      } // communication
+   } // common
+} // casual
+
+#endif // CASUAL_MIDDLEWARE_COMMON_INCLUDE_COMMON_COMMUNICATION_SHARED_H_
@@ -17,6 +17,7 @@
 #include "common/execution.h"
 
 #include <vector>
+#include <cstring>
 #include <cassert>
 
 
@@ -38,6 +39,13 @@ namespace casual
                      ( std::is_array<T>::value && sizeof( typename std::remove_all_extents<T>::type) == 1 ) ||
                      std::is_enum< T>::value>;
 
+               //!
+               //! vectors of these are marshaled as one contiguous range
+               //!
+               template< typename T>
+               using is_range_marshable = std::integral_constant<bool,
+                     std::is_arithmetic<T>::value && ! std::is_same< T, bool>::value>;
+
             } // detail
 
             struct Policy
@@ -55,6 +63,43 @@ namespace casual
                   return memory::copy( buffer, offset, value);
                }
 
+               //!
+               //! Contiguous values is written and read with one copy
+               //!
+               //! @{
+               template< typename T>
+               static void write( const T* values, std::size_t count, platform::binary_type& buffer)
+               {
+                  auto first = reinterpret_cast< const char*>( values);
+                  buffer.insert( std::end( buffer), first, first + count * sizeof( T));
+               }
+
+               template< typename T>
+               static std::size_t read( const platform::binary_type& buffer, std::size_t offset, T* values, std::size_t count)
+               {
+                  const auto size = count * sizeof( T);
+                  assert( offset + size <= buffer.size());
+
+                  std::memcpy( values, buffer.data() + offset, size);
+                  return offset + size;
+               }
+               //! @}
+
+               template< typename T>
+               static constexpr std::size_t size( const T& value)
+               {
+                  return memory::size( value);
+               }
+
+               //!
+               //! @return the representation that is written
+               //!
+               template< typename T>
+               static const T& encode( const T& value)
+               {
+                  return value;
+               }
+
             };
 
             template< typename P>
@@ -122,7 +167,8 @@ namespace casual
                }
 
                template< typename T>
-               void write( const std::vector< T>& value)
+               typename std::enable_if< ! detail::is_range_marshable< T>::value>::type
+               write( const std::vector< T>& value)
                {
                   write_pod( value.size());
 
@@ -132,6 +178,14 @@ namespace casual
                   }
                }
 
+               template< typename T>
+               typename std::enable_if< detail::is_range_marshable< T>::value>::type
+               write( const std::vector< T>& value)
+               {
+                  write_pod( value.size());
+                  policy_type::write( value.data(), value.size(), m_buffer);
+               }
+
                void write( const std::string& value)
                {
                   write_pod( value.size());
@@ -156,6 +210,297 @@ namespace casual
 
             using Output = basic_output< Policy>;
 
+            //!
+            //! Computes the size basic_output< P> will produce, with the same marshal
+            //! functions, so the buffer can be allocated once.
+            //!
+            template< typename P>
+            struct basic_sizer
+            {
+               using policy_type = P;
+
+               template< typename T>
+               basic_sizer& operator & ( T& value)
+               {
+                  return *this << value;
+               }
+
+               template< typename T>
+               basic_sizer& operator << ( const T& value)
+               {
+                  write( value);
+                  return *this;
+               }
+
+               template< typename Iter>
+               void append( Iter first, Iter last)
+               {
+                  m_size += std::distance( first, last);
+               }
+
+               template< typename C>
+               void append( C&& range)
+               {
+                  append( std::begin( range), std::end( range));
+               }
+
+               std::size_t size() const { return m_size;}
+
+            private:
+
+               template< typename T>
+               typename std::enable_if< ! detail::is_native_marshable< T>::value>::type
+               write( T& value)
+               {
+                  casual_marshal_value( value, *this);
+               }
+
+               template< typename T>
+               typename std::enable_if< detail::is_native_marshable< T>::value>::type
+               write( T& value)
+               {
+                  write_pod( value);
+               }
+
+               template< typename T>
+               void write_pod( const T& value)
+               {
+                  m_size += policy_type::size( value);
+               }
+
+               template< typename T>
+               typename std::enable_if< ! detail::is_native_marshable< T>::value>::type
+               write( const std::vector< T>& value)
+               {
+                  write_pod( value.size());
+
+                  for( auto& current : value)
+                  {
+                     *this << current;
+                  }
+               }
+
+               template< typename T>
+               typename std::enable_if< detail::is_native_marshable< T>::value>::type
+               write( const std::vector< T>& value)
+               {
+                  write_pod( value.size());
+
+                  m_size += value.size() * policy_type::size( T{});
+               }
+
+               void write( const std::string& value)
+               {
+                  write_pod( value.size());
+                  m_size += value.size();
+               }
+
+               void write( const platform::binary_type& value)
+               {
+                  write_pod( value.size());
+                  m_size += value.size();
+               }
+
+               std::size_t m_size = 0;
+            };
+
+            using Sizer = basic_sizer< Policy>;
+
+            namespace transport
+            {
+               //!
+               //! Marshals straight into the payload of transport messages, so the payload is
+               //! only copied once on the way to the transport.
+               //!
+               //! The caller sets type, correlation and complete_size (binary::size) in the header,
+               //! the output maintains offset and count. A transport is handed to the sender when it's
+               //! full and there is more to write, and on flush. If the sender fails (returns false)
+               //! the rest is discarded.
+               //!
+               template< typename P, typename T, typename S>
+               struct basic_output
+               {
+                  using policy_type = P;
+                  using transport_type = T;
+                  using sender_type = S;
+
+                  basic_output( transport_type& transport, sender_type sender)
+                     : m_transport( transport), m_sender( std::move( sender))
+                  {
+                     m_transport.message.header.offset = 0;
+                     m_transport.message.header.count = 0;
+                  }
+
+                  template< typename T2>
+                  basic_output& operator & ( T2& value)
+                  {
+                     return *this << value;
+                  }
+
+                  template< typename T2>
+                  basic_output& operator << ( const T2& value)
+                  {
+                     write( value);
+                     return *this;
+                  }
+
+                  template< typename Iter>
+                  void append( Iter first, Iter last)
+                  {
+                     auto& header = m_transport.message.header;
+
+                     while( first != last && m_sent)
+                     {
+                        if( header.count == transport_type::payload_max_size)
+                        {
+                           next();
+                           continue;
+                        }
+
+                        auto count = std::min< std::size_t>(
+                              std::distance( first, last),
+                              transport_type::payload_max_size - header.count);
+
+                        auto part = std::next( first, count);
+                        std::copy( first, part, std::begin( m_transport.message.payload) + header.count);
+
+                        header.count += count;
+                        first = part;
+                     }
+                  }
+
+                  template< typename C>
+                  void append( C&& range)
+                  {
+                     append( std::begin( range), std::end( range));
+                  }
+
+                  //!
+                  //! Sends the current transport, even if it's empty since a message
+                  //! is at least one transport.
+                  //!
+                  //! @return true if all transports has been sent
+                  //!
+                  bool flush()
+                  {
+                     if( m_sent)
+                     {
+                        m_sent = m_sender( m_transport);
+                     }
+                     return m_sent;
+                  }
+
+               private:
+
+                  void next()
+                  {
+                     if( flush())
+                     {
+                        m_transport.message.header.offset += m_transport.message.header.count;
+                        m_transport.message.header.count = 0;
+                     }
+                  }
+
+                  template< typename T2>
+                  typename std::enable_if< ! detail::is_native_marshable< T2>::value>::type
+                  write( T2& value)
+                  {
+                     casual_marshal_value( value, *this);
+                  }
+
+                  template< typename T2>
+                  typename std::enable_if< detail::is_native_marshable< T2>::value>::type
+                  write( T2& value)
+                  {
+                     write_pod( value);
+                  }
+
+                  template< typename T2>
+                  void write_pod( const T2& value)
+                  {
+                     auto&& encoded = policy_type::encode( value);
+                     auto first = reinterpret_cast< const char*>( &encoded);
+                     append( first, first + memory::size( encoded));
+                  }
+
+                  template< typename T2>
+                  void write( const std::vector< T2>& value)
+                  {
+                     write_pod( value.size());
+
+                     for( auto& current : value)
+                     {
+                        *this << current;
+                     }
+                  }
+
+                  void write( const std::string& value)
+                  {
+                     write_pod( value.size());
+                     append( std::begin( value), std::end( value));
+                  }
+
+                  void write( const platform::binary_type& value)
+                  {
+                     write_pod( value.size());
+                     append( std::begin( value), std::end( value));
+                  }
+
+                  transport_type& m_transport;
+                  sender_type m_sender;
+                  bool m_sent = true;
+               };
+
+               template< typename P, typename T, typename S>
+               basic_output< P, T, typename std::decay< S>::type> output( T& transport, S&& sender)
+               {
+                  return { transport, std::forward< S>( sender)};
+               }
+
+            } // transport
+
+            namespace detail
+            {
+               //!
+               //! Reserves the exact size if we know how the archive writes,
+               //! otherwise we let the archive grow the buffer
+               //!
+               template< typename A>
+               struct reserve
+               {
+                  template< typename M>
+                  static void buffer( platform::binary_type&, const M&) {}
+               };
+
+               template< typename P>
+               struct reserve< basic_output< P>>
+               {
+                  template< typename M>
+                  static void buffer( platform::binary_type& buffer, const M& message)
+                  {
+                     basic_sizer< P> sizer;
+                     sizer << message;
+
+                     //
+                     // basic_output reserves at least 128 bytes, no point in doing it twice
+                     //
+                     buffer.reserve( std::max< std::size_t>( sizer.size(), 128));
+                  }
+               };
+
+            } // detail
+
+            //!
+            //! @return the number of bytes @p value occupies when marshaled with the policy P
+            //!
+            template< typename P = Policy, typename T>
+            std::size_t size( const T& value)
+            {
+               basic_sizer< P> sizer;
+               sizer << value;
+               return sizer.size();
+            }
+
             template< typename P>
             struct basic_input
             {
@@ -215,7 +560,8 @@ namespace casual
 
 
                template< typename T>
-               void read( std::vector< T>& value)
+               typename std::enable_if< ! detail::is_range_marshable< T>::value>::type
+               read( std::vector< T>& value)
                {
                   decltype( value.size()) size;
                   *this >> size;
@@ -228,6 +574,18 @@ namespace casual
                   }
                }
 
+               template< typename T>
+               typename std::enable_if< detail::is_range_marshable< T>::value>::type
+               read( std::vector< T>& value)
+               {
+                  decltype( value.size()) size;
+                  *this >> size;
+
+                  value.resize( size);
+
+                  m_offset = policy_type::read( m_buffer, m_offset, value.data(), size);
+               }
+
                void read( std::string& value)
                {
                   std::string::size_type size;
@@ -339,6 +697,9 @@ namespace casual
 
             communication::message::Complete complete( message.type(), message.correlation ? message.correlation : uuid::make());
 
+            using archive_type = decltype( creator( complete.payload));
+            binary::detail::reserve< archive_type>::buffer( complete.payload, message);
+
             auto marshal = creator( complete.payload);
             marshal << message;
 
@@ -71,12 +71,65 @@ namespace casual
                   {
                      return memory::copy( buffer, offset, value);
                   }
+
+                  //!
+                  //! Contiguous values is transcoded in one pass
+                  //!
+                  //! @{
+                  template< typename T>
+                  static void write( const T* values, std::size_t count, platform::binary_type& buffer)
+                  {
+                     const auto offset = buffer.size();
+                     buffer.resize( offset + count * common::network::byteorder::bytes< T>());
+                     common::network::byteorder::encode( values, count, buffer.data() + offset);
+                  }
+
+                  template< typename T>
+                  static std::size_t read( const platform::binary_type& buffer, std::size_t offset, T* values, std::size_t count)
+                  {
+                     const auto size = count * common::network::byteorder::bytes< T>();
+                     assert( offset + size <= buffer.size());
+
+                     common::network::byteorder::decode( buffer.data() + offset, count, values);
+                     return offset + size;
+                  }
+                  //! @}
+
+                  template< typename T>
+                  static constexpr typename std::enable_if< ! detail::is_network_array< T>::value, std::size_t>::type
+                  size( const T&)
+                  {
+                     return sizeof( common::network::byteorder::type< T>);
+                  }
+
+                  template< typename T>
+                  static constexpr typename std::enable_if< detail::is_network_array< T>::value, std::size_t>::type
+                  size( const T& value)
+                  {
+                     return memory::size( value);
+                  }
+
+                  template< typename T>
+                  static auto encode( const T& value)
+                     -> typename std::enable_if< ! detail::is_network_array< T>::value, decltype( common::network::byteorder::encode( value))>::type
+                  {
+                     return common::network::byteorder::encode( value);
+                  }
+
+                  template< typename T>
+                  static typename std::enable_if< detail::is_network_array< T>::value, const T&>::type
+                  encode( const T& value)
+                  {
+                     return value;
+                  }
                };
 
                using Input = basic_input< Policy>;
 
                using Output = basic_output< Policy>;
 
+               using Sizer = basic_sizer< Policy>;
+
                namespace create
                {
                   struct Output
@@ -118,6 +118,50 @@ namespace casual
                   })
                };
 
+               namespace batch
+               {
+                  //!
+                  //! Enqueues all messages to the same queue in one exchange, the group
+                  //! inserts them in one transaction
+                  //!
+                  struct Request : basic_message< Type::queue_enqueue_batch_request>
+                  {
+                     using Message = base_message;
+
+                     process::Handle process;
+                     common::transaction::ID trid;
+                     std::size_t queue;
+
+                     std::vector< Message> messages;
+
+                     CASUAL_CONST_CORRECT_MARSHAL(
+                     {
+                        base_type::marshal( archive);
+                        archive & process;
+                        archive & trid;
+                        archive & queue;
+                        archive & messages;
+                     })
+
+                     friend std::ostream& operator << ( std::ostream& out, const Request& value);
+                  };
+
+                  //!
+                  //! ids in the same order as the messages in the request
+                  //!
+                  struct Reply : basic_message< Type::queue_enqueue_batch_reply>
+                  {
+                     std::vector< common::Uuid> ids;
+
+                     CASUAL_CONST_CORRECT_MARSHAL(
+                     {
+                        base_type::marshal( archive);
+                        archive & ids;
+                     })
+                  };
+
+               } // batch
+
             } // enqueue
 
             namespace dequeue
@@ -143,6 +187,11 @@ namespace casual
                   Selector selector;
                   bool block = false;
 
+                  //!
+                  //! max number of messages to dequeue
+                  //!
+                  std::size_t count = 1;
+
                   CASUAL_CONST_CORRECT_MARSHAL(
                   {
                      base_type::marshal( archive);
@@ -151,6 +200,7 @@ namespace casual
                      archive & queue;
                      archive & selector;
                      archive & block;
+                     archive & count;
                   })
 
                   friend std::ostream& operator << ( std::ostream& out, const Request& value);
@@ -237,6 +287,10 @@ namespace casual
                id_type error = 0;
                int type;
 
+               //!
+               //! false if the messages are held in memory in the group, and lost if the group goes down
+               //!
+               bool persistent = true;
 
 
                CASUAL_CONST_CORRECT_MARSHAL(
@@ -246,6 +300,7 @@ namespace casual
                   archive & retries;
                   archive & error;
                   archive & type;
+                  archive & persistent;
                })
 
                friend std::ostream& operator << ( std::ostream& out, const Queue& value);
@@ -421,6 +476,44 @@ namespace casual
 
             } // group
 
+            namespace forward
+            {
+               //!
+               //! Sent from a forwarder to the queue-broker, so the statistics can be listed
+               //!
+               struct Statistics : basic_message< Type::queue_forward_statistics>
+               {
+                  process::Handle process;
+                  std::string queue;
+
+                  std::size_t forwarded = 0;
+                  std::size_t rolledback = 0;
+                  std::size_t errored = 0;
+                  std::size_t transactions = 0;
+                  std::size_t in_flight = 0;
+                  std::size_t high = 0;
+
+                  platform::time_point start;
+                  platform::time_point timestamp;
+
+                  CASUAL_CONST_CORRECT_MARSHAL(
+                  {
+                     base_type::marshal( archive);
+                     archive & process;
+                     archive & queue;
+                     archive & forwarded;
+                     archive & rolledback;
+                     archive & errored;
+                     archive & transactions;
+                     archive & in_flight;
+                     archive & high;
+                     archive & start;
+                     archive & timestamp;
+                  })
+               };
+
+            } // forward
+
 
          } // queue
       } // message
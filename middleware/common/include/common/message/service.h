@@ -82,17 +82,36 @@ namespace casual
                   Request() = default;
                   Request( Request&&) = default;
                   Request& operator = ( Request&&) = default;
+                  Request( const Request&) = default;
+                  Request& operator = ( const Request&) = default;
 
                   std::string requested;
                   process::Handle process;
                   Context context = Context::regular;
 
+                  //!
+                  //! true if caller wants to reserve the idle instance, and call it
+                  //! directly until the broker revokes the reservation
+                  //!
+                  bool reserve = false;
+
+                  //!
+                  //! true if the caller has its own deadline and gives up on it's own, hence broker
+                  //! can drop the request when it has been pending longer than the service timeout.
+                  //!
+                  //! Other callers (TPNOTIME, forward cache, ...) waits until an instance is idle, and
+                  //! the request is kept until then
+                  //!
+                  bool expire = false;
+
                   CASUAL_CONST_CORRECT_MARSHAL(
                   {
                      base_type::marshal( archive);
                      archive & requested;
                      archive & process;
                      archive & context;
+                     archive & reserve;
+                     archive & expire;
                   })
                };
 
@@ -114,17 +133,82 @@ namespace casual
 
                   State state = State::idle;
 
+                  //!
+                  //! true if the instance is reserved for the caller
+                  //!
+                  bool reserved = false;
+
                   CASUAL_CONST_CORRECT_MARSHAL(
                   {
                      base_type::marshal( archive);
                      archive & service;
                      archive & process;
                      archive & state;
+                     archive & reserved;
                   })
 
                   friend std::ostream& operator << ( std::ostream& out, const Reply& value);
 
                };
+
+               //!
+               //! Sent from broker to a caller that holds a reservation of an instance.
+               //!
+               //! pending:      other callers are waiting for the instance, release it when the current call is done
+               //! unadvertised: the instance has removed services, release it when the current call is done
+               //! changed:      the service information has changed (traffic monitors and such), release it when the current call is done
+               //! deceased:     the instance is gone, and the reservation with it. Don't release
+               //!
+               struct Revoke : basic_message< Type::service_name_lookup_revoke>
+               {
+                  enum class Reason : char
+                  {
+                     pending,
+                     unadvertised,
+                     changed,
+                     deceased
+                  };
+
+                  process::Handle process;
+                  Reason reason = Reason::pending;
+
+                  CASUAL_CONST_CORRECT_MARSHAL(
+                  {
+                     base_type::marshal( archive);
+                     archive & process;
+                     archive & reason;
+                  })
+               };
+
+               //!
+               //! Sent from caller to broker to hand back a reserved instance.
+               //!
+               struct Release : basic_message< Type::service_name_lookup_release>
+               {
+                  //!
+                  //! the caller
+                  //!
+                  process::Handle process;
+
+                  //!
+                  //! the reserved instance
+                  //!
+                  process::Handle instance;
+
+                  //!
+                  //! number of calls done to the instance during the reservation (informational,
+                  //! the instance ACK:s every call to broker)
+                  //!
+                  std::uint64_t invoked = 0;
+
+                  CASUAL_CONST_CORRECT_MARSHAL(
+                  {
+                     base_type::marshal( archive);
+                     archive & process;
+                     archive & instance;
+                     archive & invoked;
+                  })
+               };
             } // lookup
 
 
@@ -151,6 +235,12 @@ namespace casual
                   common::transaction::ID trid;
                   std::int64_t flags = 0;
 
+                  //!
+                  //! true if the caller has reserved the instance, and calls it directly
+                  //! should be sent to the broker
+                  //!
+                  bool reserved = false;
+
                   CASUAL_CONST_CORRECT_MARSHAL(
                   {
                      base_type::marshal( archive);
@@ -161,6 +251,7 @@ namespace casual
                      archive & execution;
                      archive & trid;
                      archive & flags;
+                     archive & reserved;
                   })
 
                   friend std::ostream& operator << ( std::ostream& out, const base_call& value);
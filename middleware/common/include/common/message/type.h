@@ -58,6 +58,8 @@ namespace casual
             service_call,
             service_reply,
             service_acknowledge,
+            service_name_lookup_revoke,
+            service_name_lookup_release,
 
             // Monitor
             TRAFFICMONITOR_BASE = 3000,
@@ -108,6 +110,8 @@ namespace casual
             queue_connect_reply,
             queue_enqueue_request = QUEUE_BASE + 100,
             queue_enqueue_reply,
+            queue_enqueue_batch_request,
+            queue_enqueue_batch_reply,
             queue_dequeue_request = QUEUE_BASE + 200,
             queue_dequeue_reply,
             queue_dequeue_forget_request,
@@ -120,6 +124,7 @@ namespace casual
             queue_lookup_request = QUEUE_BASE + 400,
             queue_lookup_reply,
             queue_group_involved = QUEUE_BASE + 500,
+            queue_forward_statistics = QUEUE_BASE + 600,
 
 
             GATEWAY_BASE = 6000,
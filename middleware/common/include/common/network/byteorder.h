@@ -10,6 +10,8 @@
 
 #include <type_traits>
 #include <cstdint>
+#include <cstddef>
+#include <cstring>
 
 namespace casual
 {
@@ -191,6 +193,77 @@ namespace casual
                return sizeof( decltype( encode( T())));
             }
 
+
+            namespace detail
+            {
+               //!
+               //! Transcodes @p count values of @p size bytes between host and network byteorder
+               //! (it's the same operation both ways). @p first and @p out does not need to be aligned
+               //!
+               template< std::size_t size>
+               void transcode_range( const char* first, std::size_t count, char* out) noexcept;
+
+               template<> void transcode_range< 1>( const char* first, std::size_t count, char* out) noexcept;
+               template<> void transcode_range< 2>( const char* first, std::size_t count, char* out) noexcept;
+               template<> void transcode_range< 4>( const char* first, std::size_t count, char* out) noexcept;
+               template<> void transcode_range< 8>( const char* first, std::size_t count, char* out) noexcept;
+
+               //!
+               //! integers that has the same size on the wire can be transcoded as a range
+               //!
+               template< typename T>
+               using is_range_transcodable = std::integral_constant< bool,
+                  std::is_integral< T>::value && sizeof( T) == sizeof( type< T>)>;
+
+            } // detail
+
+            //!
+            //! Encodes @p count values from @p first to @p out, that has to hold count * bytes< T>()
+            //!
+            //! @{
+            template< typename T>
+            typename std::enable_if< detail::is_range_transcodable< T>::value>::type
+            encode( const T* first, std::size_t count, char* out) noexcept
+            {
+               detail::transcode_range< sizeof( T)>( reinterpret_cast< const char*>( first), count, out);
+            }
+
+            template< typename T>
+            typename std::enable_if< ! detail::is_range_transcodable< T>::value>::type
+            encode( const T* first, std::size_t count, char* out) noexcept
+            {
+               for( auto last = first + count; first != last; ++first, out += bytes< T>())
+               {
+                  const auto value = encode( *first);
+                  std::memcpy( out, &value, sizeof( value));
+               }
+            }
+            //! @}
+
+            //!
+            //! Decodes @p count values from @p first, that holds count * bytes< T>(), to @p out
+            //!
+            //! @{
+            template< typename T>
+            typename std::enable_if< detail::is_range_transcodable< T>::value>::type
+            decode( const char* first, std::size_t count, T* out) noexcept
+            {
+               detail::transcode_range< sizeof( T)>( first, count, reinterpret_cast< char*>( out));
+            }
+
+            template< typename T>
+            typename std::enable_if< ! detail::is_range_transcodable< T>::value>::type
+            decode( const char* first, std::size_t count, T* out) noexcept
+            {
+               for( auto last = out + count; out != last; ++out, first += bytes< T>())
+               {
+                  type< T> value;
+                  std::memcpy( &value, first, sizeof( value));
+                  *out = decode< T>( value);
+               }
+            }
+            //! @}
+
          } // byteorder
 
       }
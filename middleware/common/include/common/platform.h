@@ -126,6 +126,12 @@ namespace casual
 			constexpr std::size_t message_size = 1024 * 8;
 #endif
 
+			//
+			// Max transports the descriptor worker holds in memory before it stops
+			// reading the ipc-queue, so senders still get back-pressure
+			//
+			constexpr std::size_t notify_transports = 1024;
+
 			//
 			// uuid
 			//
@@ -238,9 +238,16 @@ namespace casual
                   scope::Execute execute_finalize{ [](){ server::Context::instance().finalize();}};
 
                   //
-                  // Make sure we'll always send ACK to broker
+                  // We go back to the message pump after this, and we don't know when we call
+                  // again. Hand back the reservations we've got during the service, if any
                   //
-                  scope::Execute execute_ack{ [&](){ m_policy.ack( message); } };
+                  scope::Execute execute_release{ [](){ call::Context::instance().release();}};
+
+                  //
+                  // Make sure we'll always send ACK to broker, even if the caller has reserved
+                  // us, so broker knows we're done if it has to take us back from the caller
+                  //
+                  scope::Execute execute_ack{ [&](){ m_policy.ack( message);}};
 
 
                   //
@@ -14,6 +14,7 @@
 //#include "common/marshal.h"
 
 #include <string>
+#include <functional>
 
 namespace casual
 {
@@ -98,6 +99,23 @@ namespace casual
 
 } // casaul
 
+namespace std
+{
+   template<>
+   struct hash< casual::common::Uuid>
+   {
+      //!
+      //! uuid is (pseudo) random, so the first bytes is a good enough hash
+      //!
+      std::size_t operator() ( const casual::common::Uuid& value) const
+      {
+         std::size_t result;
+         memcpy( &result, value.get(), sizeof( result));
+         return result;
+      }
+   };
+} // std
+
 
 
 
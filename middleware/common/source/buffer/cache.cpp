@@ -0,0 +1,194 @@
+//!
+//! cache.cpp
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#include "common/buffer/cache.h"
+
+#include "common/environment.h"
+
+
+namespace casual
+{
+   namespace common
+   {
+      namespace buffer
+      {
+         namespace local
+         {
+            namespace
+            {
+               namespace size
+               {
+                  //!
+                  //! smallest class is 2^6 = 64 bytes, largest is 2^20 = 1MB
+                  //!
+                  constexpr std::size_t smallest = 6;
+                  constexpr std::size_t largest = 20;
+                  constexpr std::size_t classes = largest - smallest + 1;
+
+                  constexpr std::size_t bytes( std::size_t index) { return std::size_t{ 1} << ( index + smallest);}
+
+                  //!
+                  //! @return the smallest class that can hold @p size, classes if none
+                  //!
+                  std::size_t upper( std::size_t size)
+                  {
+                     std::size_t index = 0;
+                     while( index < classes && bytes( index) < size)
+                     {
+                        ++index;
+                     }
+                     return index;
+                  }
+
+                  //!
+                  //! @return the largest class that @p capacity can serve, classes if none
+                  //!
+                  std::size_t lower( std::size_t capacity)
+                  {
+                     if( capacity < bytes( 0) || capacity >= bytes( classes))
+                     {
+                        return classes;
+                     }
+
+                     std::size_t index = 0;
+                     while( index + 1 < classes && bytes( index + 1) <= capacity)
+                     {
+                        ++index;
+                     }
+                     return index;
+                  }
+               } // size
+
+               std::size_t limit()
+               {
+                  if( environment::variable::exists( "CASUAL_BUFFER_CACHE_LIMIT"))
+                  {
+                     return environment::variable::get< std::size_t>( "CASUAL_BUFFER_CACHE_LIMIT");
+                  }
+                  return 1024 * 1024;
+               }
+
+            } // <unnamed>
+         } // local
+
+         Cache::Cache() : m_classes( local::size::classes), m_limit( local::limit())
+         {
+
+         }
+
+         Cache& Cache::instance()
+         {
+            static Cache singleton;
+            return singleton;
+         }
+
+         platform::binary_type Cache::take( platform::binary_size_type size)
+         {
+            ++m_statistics.allocations;
+
+            platform::binary_type result;
+
+            auto index = local::size::upper( size);
+
+            if( index < local::size::classes && ! m_classes[ index].empty())
+            {
+               ++m_statistics.hits;
+
+               result = std::move( m_classes[ index].back());
+               m_classes[ index].pop_back();
+               m_statistics.retained -= result.capacity();
+            }
+            else
+            {
+               ++m_statistics.misses;
+
+               if( index < local::size::classes)
+               {
+                  //
+                  // Make sure we fit in the class when we're recycled
+                  //
+                  result.reserve( local::size::bytes( index));
+               }
+            }
+
+            result.resize( size);
+            return result;
+         }
+
+         void Cache::recycle( platform::binary_type&& memory)
+         {
+            ++m_statistics.recycled;
+
+            auto index = local::size::lower( memory.capacity());
+
+            if( index == local::size::classes || m_statistics.retained + memory.capacity() > m_limit)
+            {
+               ++m_statistics.discarded;
+               return;
+            }
+
+            m_statistics.retained += memory.capacity();
+
+            //
+            // We keep the capacity, take will zero what is used.
+            //
+            memory.clear();
+            m_classes[ index].push_back( std::move( memory));
+         }
+
+         std::size_t Cache::limit() const
+         {
+            return m_limit;
+         }
+
+         void Cache::limit( std::size_t bytes)
+         {
+            m_limit = bytes;
+
+            //
+            // Discard from the largest classes until we're within the limit
+            //
+            for( auto index = local::size::classes; index > 0 && m_statistics.retained > m_limit; --index)
+            {
+               auto& memories = m_classes[ index - 1];
+
+               while( ! memories.empty() && m_statistics.retained > m_limit)
+               {
+                  m_statistics.retained -= memories.back().capacity();
+                  memories.pop_back();
+               }
+            }
+         }
+
+         void Cache::clear()
+         {
+            for( auto& memories : m_classes)
+            {
+               memories.clear();
+            }
+            m_statistics.retained = 0;
+         }
+
+         const Cache::Statistics& Cache::statistics() const
+         {
+            return m_statistics;
+         }
+
+         std::ostream& operator << ( std::ostream& out, const Cache::Statistics& value)
+         {
+            return out << "{ allocations: " << value.allocations
+                  << ", hits: " << value.hits
+                  << ", misses: " << value.misses
+                  << ", recycled: " << value.recycled
+                  << ", discarded: " << value.discarded
+                  << ", retained: " << value.retained
+                  << '}';
+         }
+
+      } // buffer
+   } // common
+} // casual
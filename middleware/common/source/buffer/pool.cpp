@@ -37,15 +37,22 @@ namespace casual
 
             Holder::Base& Holder::find( platform::const_raw_buffer_type handle)
             {
-               auto pool = range::find_if( m_pools, [&]( std::unique_ptr< Base>& b){
-                  return b->manage( handle);
-               });
+               auto found = m_handles.find( handle);
 
-               if( ! pool)
+               if( found == std::end( m_handles))
                {
                   throw exception::xatmi::invalid::Argument{ "buffer not valid"};
                }
-               return **pool;
+               return *found->second;
+            }
+
+            platform::raw_buffer_type Holder::index( Base& pool, platform::raw_buffer_type handle)
+            {
+               if( handle)
+               {
+                  m_handles[ handle] = &pool;
+               }
+               return handle;
             }
 
             const Payload& Holder::null_payload() const
@@ -58,7 +65,8 @@ namespace casual
 
             platform::raw_buffer_type Holder::allocate( const Type& type, platform::binary_size_type size)
             {
-               auto buffer = find( type).allocate( type, size);
+               auto& pool = find( type);
+               auto buffer = index( pool, pool.allocate( type, size));
 
                if( log::internal::buffer)
                {
@@ -69,7 +77,14 @@ namespace casual
 
             platform::raw_buffer_type Holder::reallocate( platform::const_raw_buffer_type handle, platform::binary_size_type size)
             {
-               auto buffer = find( handle).reallocate( handle, size);
+               auto& pool = find( handle);
+               auto buffer = pool.reallocate( handle, size);
+
+               if( buffer != handle)
+               {
+                  m_handles.erase( handle);
+                  index( pool, buffer);
+               }
 
                if( log::internal::buffer)
                {
@@ -98,6 +113,7 @@ namespace casual
                if( handle != m_inbound && handle != nullptr)
                {
                   find( handle).deallocate( handle);
+                  m_handles.erase( handle);
 
                   log::internal::buffer << "deallocate @" << static_cast< const void*>( handle) << '\n';
                }
@@ -128,7 +144,8 @@ namespace casual
                   return nullptr;
                }
 
-               return find( payload.type).insert( std::move( payload));
+               auto& pool = find( payload.type);
+               return index( pool, pool.insert( std::move( payload)));
             }
 
             payload::Send Holder::get( platform::const_raw_buffer_type handle, platform::binary_size_type user_size)
@@ -159,6 +176,7 @@ namespace casual
                }
 
                auto result = find( handle).release( handle);
+               m_handles.erase( handle);
 
                if( m_inbound == handle) m_inbound = nullptr;
 
@@ -175,6 +193,7 @@ namespace casual
                }
 
                auto result = find( handle).release( handle, size);
+               m_handles.erase( handle);
 
                if( m_inbound == handle) m_inbound = nullptr;
 
@@ -191,6 +210,7 @@ namespace casual
                   try
                   {
                      find( m_inbound).deallocate( m_inbound);
+                     m_handles.erase( m_inbound);
                      m_inbound = nullptr;
                   }
                   catch( const exception::base& exception)
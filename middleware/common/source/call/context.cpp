@@ -177,6 +177,36 @@ namespace casual
          } // local
 
 
+         descriptor_type Context::reserved( State::Reservations::Reservation& reservation, char* idata, long ilen, long flags)
+         {
+            trace::internal::Scope trace( "calling::Context::reserved");
+
+            auto start = platform::clock_type::now();
+
+            buffer::transport::Context::instance().dispatch( idata, ilen, reservation.service.name, buffer::transport::Lifecycle::pre_call);
+
+            auto message = local::prepare::message( m_state, start, idata, ilen, flags, reservation.service);
+            message.reserved = true;
+
+            common::scope::Execute unreserve{ [&](){ m_state.pending.unreserve( message.descriptor);}};
+
+            auto deadline = m_state.pending.deadline( message.descriptor, start);
+
+            log::internal::debug << "reserved - instance: " << reservation.process << " message: " << message << std::endl;
+
+            //
+            // If we fail to send, we can't trust the instance any more. We hand it back to broker
+            //
+            m_state.reservations.use( reservation, message.descriptor);
+            common::scope::Execute discard{ [&](){ m_state.reservations.discard( message.descriptor);}};
+
+            communication::ipc::blocking::send( reservation.process.queue, message);
+
+            discard.release();
+            unreserve.release();
+            return message.descriptor;
+         }
+
          descriptor_type Context::async( const std::string& service, char* idata, long ilen, long flags)
          {
             trace::internal::Scope trace( "calling::Context::async");
@@ -185,7 +215,31 @@ namespace casual
 
             auto context = local::validate::input( idata, ilen, flags);
 
-            service::Lookup lookup( service, context);
+            //
+            // Take care of revokes from broker before we use our reservations
+            //
+            m_state.reservations.revoke();
+
+            auto reserve = context == message::service::lookup::Request::Context::regular && State::Reservations::active();
+
+            if( reserve)
+            {
+               auto reservation = m_state.reservations.find( service);
+
+               if( reservation)
+               {
+                  return reserved( *reservation, idata, ilen, flags);
+               }
+            }
+
+            //
+            // Only a regular caller with a deadline times out by itself, hence can let
+            // broker expire the pending lookup. TPNOREPLY has no descriptor and no timer,
+            // and would wait forever for a reply that never comes
+            //
+            auto expire = context == message::service::lookup::Request::Context::regular && ! flag< TPNOTIME>( flags);
+
+            service::Lookup lookup( service, context, reserve, expire);
 
             //
             // We do as much as possible while we wait for the broker reply
@@ -227,6 +281,11 @@ namespace casual
             //
             common::scope::Execute send_ack{ [&]()
                {
+                  if( target.reserved)
+                  {
+                     m_state.reservations.discard( message.descriptor);
+                     return;
+                  }
                   message::service::call::ACK ack;
                   ack.process = target.process;
                   ack.service = target.service.name;
@@ -253,6 +312,15 @@ namespace casual
             //
             message.service = target.service;
 
+            if( target.reserved)
+            {
+               //
+               // The instance is ours until broker revokes it
+               //
+               m_state.reservations.use( m_state.reservations.add( target.service, target.process), message.descriptor);
+               message.reserved = true;
+            }
+
             log::internal::debug << "async - message: " << message << std::endl;
 
 
@@ -293,12 +361,38 @@ namespace casual
             //
             message::service::call::Reply reply;
 
+            //
+            // If we don't get the reply (timeout and such) the reserved instance could still be busy
+            // with our call, we hand it back to broker
+            //
+            common::scope::Execute discard_reservation{ [&](){ m_state.reservations.discard( descriptor);}};
+
             if( ! receive( reply, descriptor, flags))
             {
+               discard_reservation.release();
                throw common::exception::xatmi::no::Message();
             }
 
-            descriptor = reply.descriptor;
+            discard_reservation.release();
+
+            if( descriptor == 0)
+            {
+               //
+               // TPGETANY, we use the correlation to find out which of our calls the reply belongs to
+               //
+               descriptor = m_state.pending.descriptor( reply.correlation);
+            }
+
+            if( descriptor == 0)
+            {
+               descriptor = reply.descriptor;
+            }
+
+            //
+            // The reserved instance is done with our call, and ready for the next
+            //
+            m_state.reservations.done( descriptor);
+            m_state.reservations.revoke();
 
             user_code( reply.code);
 
@@ -374,6 +468,7 @@ namespace casual
          void Context::cancel( descriptor_type descriptor)
          {
             m_state.pending.discard( descriptor);
+            m_state.reservations.discard( descriptor);
          }
 
 
@@ -405,6 +500,17 @@ namespace casual
             return ! m_state.pending.empty();
          }
 
+         void Context::revoke( const message::service::lookup::Revoke& message)
+         {
+            m_state.reservations.revoke( message);
+         }
+
+         void Context::release()
+         {
+            m_state.reservations.revoke();
+            m_state.reservations.release();
+         }
+
          namespace local
          {
             namespace
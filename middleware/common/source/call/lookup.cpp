@@ -17,16 +17,22 @@ namespace casual
       {
          namespace service
          {
-            Lookup::Lookup( std::string service, message::service::lookup::Request::Context context) : m_service( std::move( service))
+            Lookup::Lookup( std::string service, message::service::lookup::Request::Context context, bool reserve, bool expire)
+               : m_service( std::move( service))
             {
                message::service::lookup::Request request;
                request.requested = m_service;
                request.process = process::handle();
                request.context = context;
+               request.reserve = reserve;
+               request.expire = expire;
 
                m_correlation = communication::ipc::blocking::send( communication::ipc::broker::id(), request);
             }
 
+            Lookup::Lookup( std::string service, message::service::lookup::Request::Context context)
+               : Lookup( std::move( service), context, false) {}
+
             Lookup::Lookup( std::string service) : Lookup( std::move( service), message::service::lookup::Request::Context::regular) {}
 
             Lookup::~Lookup()
@@ -10,6 +10,8 @@
 #include "common/transaction/context.h"
 
 #include "common/communication/ipc.h"
+#include "common/environment.h"
+#include "common/internal/log.h"
 
 
 namespace casual
@@ -20,17 +22,15 @@ namespace casual
       {
 
          State::Pending::Pending()
-          : m_descriptors{
-            { 1, false },
-            { 2, false },
-            { 3, false },
-            { 4, false },
-            { 5, false },
-            { 6, false },
-            { 7, false },
-            { 8, false }}
          {
-
+            //
+            // Preallocate the first descriptors
+            //
+            for( descriptor_type descriptor = 1; descriptor <= 8; ++descriptor)
+            {
+               m_descriptors.emplace_back( descriptor, false);
+               m_free.push( descriptor);
+            }
          }
 
 
@@ -39,44 +39,59 @@ namespace casual
             auto& descriptor = reserve();
 
             descriptor.correlation = correlation;
+            m_correlations[ correlation] = descriptor.descriptor;
 
             return descriptor;
          }
 
          State::Pending::Descriptor& State::Pending::reserve()
          {
-            auto found = range::find_if( m_descriptors, negate( std::mem_fn( &Descriptor::active)));
+            ++m_active;
 
-            if( found)
+            if( ! m_free.empty())
             {
-               found->active = true;
-               found->timeout.timeout = std::chrono::microseconds{ 0};
-               return *found;
+               auto& found = m_descriptors[ m_free.top() - 1];
+               m_free.pop();
+
+               found.active = true;
+               found.timeout.timeout = std::chrono::microseconds{ 0};
+               return found;
             }
             else
             {
-               m_descriptors.emplace_back( m_descriptors.back().descriptor + 1, true);
+               m_descriptors.emplace_back( m_descriptors.size() + 1, true);
                return m_descriptors.back();
             }
          }
 
          void State::Pending::unreserve( descriptor_type descriptor)
          {
-            auto found = range::find( m_descriptors, descriptor);
+            auto found = find( descriptor);
 
-            if( found)
+            if( ! found)
             {
-               found->active = false;
+               throw exception::xatmi::invalid::Descriptor{ "invalid call descriptor: " + std::to_string( descriptor)};
             }
-            else
+
+            if( found->active)
             {
-               throw exception::xatmi::invalid::Descriptor{ "invalid call descriptor: " + std::to_string( descriptor)};
+               found->active = false;
+
+               auto correlation = m_correlations.find( found->correlation);
+
+               if( correlation != std::end( m_correlations) && correlation->second == descriptor)
+               {
+                  m_correlations.erase( correlation);
+               }
+
+               m_free.push( descriptor);
+               --m_active;
             }
          }
 
          bool State::Pending::active( descriptor_type descriptor) const
          {
-            auto found = range::find( m_descriptors, descriptor);
+            auto found = find( descriptor);
 
             if( found)
             {
@@ -87,7 +102,7 @@ namespace casual
 
          const State::Pending::Descriptor& State::Pending::get( descriptor_type descriptor) const
          {
-            auto found = range::find( m_descriptors, descriptor);
+            auto found = find( descriptor);
             if( found && found->active)
             {
                return *found;
@@ -95,6 +110,17 @@ namespace casual
             throw exception::xatmi::invalid::Descriptor{ "invalid call descriptor: " + std::to_string( descriptor)};
          }
 
+         descriptor_type State::Pending::descriptor( const Uuid& correlation) const
+         {
+            auto found = m_correlations.find( correlation);
+
+            if( found != std::end( m_correlations))
+            {
+               return found->second;
+            }
+            return 0;
+         }
+
          signal::timer::Deadline State::Pending::deadline( descriptor_type descriptor, const platform::time_point& now) const
          {
             if( descriptor == 0)
@@ -110,6 +136,24 @@ namespace casual
             return { platform::time_point::max(), now};
          }
 
+         State::Pending::Descriptor* State::Pending::find( descriptor_type descriptor)
+         {
+            if( descriptor > 0 && static_cast< std::size_t>( descriptor) <= m_descriptors.size())
+            {
+               return &m_descriptors[ descriptor - 1];
+            }
+            return nullptr;
+         }
+
+         const State::Pending::Descriptor* State::Pending::find( descriptor_type descriptor) const
+         {
+            if( descriptor > 0 && static_cast< std::size_t>( descriptor) <= m_descriptors.size())
+            {
+               return &m_descriptors[ descriptor - 1];
+            }
+            return nullptr;
+         }
+
          void State::Pending::discard( descriptor_type descriptor)
          {
             //
@@ -130,7 +174,193 @@ namespace casual
 
          bool State::Pending::empty() const
          {
-            return range::all_of( m_descriptors, negate( std::mem_fn( &Descriptor::active)));
+            return m_active == 0;
+         }
+
+         namespace local
+         {
+            namespace
+            {
+               namespace reservation
+               {
+                  bool initialize_active()
+                  {
+                     if( environment::variable::exists( "CASUAL_CALL_RESERVATION"))
+                     {
+                        return environment::variable::get< int>( "CASUAL_CALL_RESERVATION") != 0;
+                     }
+                     return false;
+                  }
+
+                  bool& active()
+                  {
+                     static bool value = initialize_active();
+                     return value;
+                  }
+
+                  struct Descriptor
+                  {
+                     Descriptor( descriptor_type descriptor) : m_descriptor( descriptor) {}
+
+                     bool operator () ( const State::Reservations::Reservation& r) const { return r.descriptor == m_descriptor;}
+
+                  private:
+                     descriptor_type m_descriptor;
+                  };
+
+               } // reservation
+            } // <unnamed>
+         } // local
+
+         bool State::Reservations::active()
+         {
+            return local::reservation::active();
+         }
+
+         void State::Reservations::active( bool value)
+         {
+            local::reservation::active() = value;
+         }
+
+         State::Reservations::Reservation* State::Reservations::find( const std::string& service)
+         {
+            auto found = range::find_if( m_reservations, [&]( const Reservation& r){
+               return r.free() && r.service.name == service;
+            });
+
+            if( found)
+            {
+               return &( *found);
+            }
+            return nullptr;
+         }
+
+         State::Reservations::Reservation& State::Reservations::add( message::Service service, process::Handle process)
+         {
+            m_reservations.emplace_back( std::move( service), std::move( process));
+
+            log::internal::debug << "reservation added - service: " << m_reservations.back().service.name
+                  << " instance: " << m_reservations.back().process << '\n';
+
+            return m_reservations.back();
+         }
+
+         void State::Reservations::use( Reservation& reservation, descriptor_type descriptor)
+         {
+            reservation.descriptor = descriptor;
+            ++reservation.invoked;
+         }
+
+         void State::Reservations::done( descriptor_type descriptor)
+         {
+            if( descriptor == 0)
+            {
+               return;
+            }
+
+            auto found = range::find_if( m_reservations, local::reservation::Descriptor{ descriptor});
+
+            if( found)
+            {
+               found->descriptor = 0;
+
+               if( found->revoked)
+               {
+                  release( std::begin( found));
+               }
+            }
+         }
+
+         void State::Reservations::discard( descriptor_type descriptor)
+         {
+            if( descriptor == 0)
+            {
+               return;
+            }
+
+            auto found = range::find_if( m_reservations, local::reservation::Descriptor{ descriptor});
+
+            if( found)
+            {
+               release( std::begin( found));
+            }
+         }
+
+         void State::Reservations::revoke()
+         {
+            if( m_reservations.empty())
+            {
+               return;
+            }
+
+            message::service::lookup::Revoke message;
+
+            while( communication::ipc::non::blocking::receive( communication::ipc::inbound::device(), message))
+            {
+               revoke( message);
+            }
+         }
+
+         void State::Reservations::revoke( const message::service::lookup::Revoke& message)
+         {
+            auto found = range::find_if( m_reservations, [&]( const Reservation& r){
+               return r.process.pid == message.process.pid;
+            });
+
+            if( ! found)
+            {
+               //
+               // We've already released it
+               //
+               return;
+            }
+
+            if( message.reason == message::service::lookup::Revoke::Reason::deceased)
+            {
+               //
+               // Broker has already removed the instance, nothing to release
+               //
+               m_reservations.erase( std::begin( found));
+            }
+            else if( found->descriptor == 0)
+            {
+               release( std::begin( found));
+            }
+            else
+            {
+               found->revoked = true;
+            }
+         }
+
+         void State::Reservations::release()
+         {
+            for( auto& reservation : m_reservations)
+            {
+               reservation.revoked = true;
+            }
+
+            auto found = range::find_if( m_reservations, local::reservation::Descriptor{ 0});
+
+            while( found)
+            {
+               release( std::begin( found));
+               found = range::find_if( m_reservations, local::reservation::Descriptor{ 0});
+            }
+         }
+
+         void State::Reservations::release( std::vector< Reservation>::iterator found)
+         {
+            message::service::lookup::Release message;
+            message.process = process::handle();
+            message.instance = found->process;
+            message.invoked = found->invoked;
+
+            log::internal::debug << "reservation released - service: " << found->service.name
+                  << " instance: " << found->process << '\n';
+
+            m_reservations.erase( found);
+
+            communication::ipc::blocking::send( communication::ipc::broker::id(), message);
          }
 
       } // call
@@ -0,0 +1,208 @@
+//!
+//! device.cpp
+//!
+//! Created on: Oct 17, 2016
+//!     Author: Lazan
+//!
+
+#include "common/communication/device.h"
+
+namespace casual
+{
+   namespace common
+   {
+      namespace communication
+      {
+         namespace inbound
+         {
+
+            Cache::Entry::Entry( complete_type&& message, std::uint64_t sequence)
+               : message{ std::move( message)}, sequence{ sequence} {}
+
+            Cache::Cache() = default;
+            Cache::~Cache() = default;
+
+            Cache::Cache( Cache&&) = default;
+            Cache& Cache::operator = ( Cache&&) = default;
+
+
+            void Cache::push( complete_type&& message)
+            {
+               insert( std::move( message));
+            }
+
+            Cache::complete_type Cache::extract()
+            {
+               auto found = std::find_if( std::begin( m_entries), std::end( m_entries), []( const Entry& e){
+                  return e.message.complete();
+               });
+
+               if( found != std::end( m_entries))
+               {
+                  return extract( found);
+               }
+               return {};
+            }
+
+            Cache::complete_type Cache::extract( message_type type)
+            {
+               auto found = m_types.find( type);
+
+               if( found != std::end( m_types))
+               {
+                  for( auto& position : found->second)
+                  {
+                     if( position->message.complete())
+                     {
+                        return extract( position);
+                     }
+                  }
+               }
+               return {};
+            }
+
+            Cache::complete_type Cache::extract( const std::vector< message_type>& types)
+            {
+               //
+               // Find the first complete message, for each type, and take the one that arrived first
+               //
+               position_type result = std::end( m_entries);
+
+               for( auto type : types)
+               {
+                  auto found = m_types.find( type);
+
+                  if( found != std::end( m_types))
+                  {
+                     for( auto& position : found->second)
+                     {
+                        if( position->message.complete())
+                        {
+                           if( result == std::end( m_entries) || position->sequence < result->sequence)
+                           {
+                              result = position;
+                           }
+                           break;
+                        }
+                     }
+                  }
+               }
+
+               if( result != std::end( m_entries))
+               {
+                  return extract( result);
+               }
+               return {};
+            }
+
+            Cache::complete_type Cache::extract( const Uuid& correlation)
+            {
+               auto found = m_correlations.find( correlation);
+
+               if( found != std::end( m_correlations))
+               {
+                  for( auto& position : found->second)
+                  {
+                     if( position->message.complete())
+                     {
+                        return extract( position);
+                     }
+                  }
+               }
+               return {};
+            }
+
+            const Cache::complete_type* Cache::find( const Uuid& correlation) const
+            {
+               auto found = m_correlations.find( correlation);
+
+               if( found != std::end( m_correlations))
+               {
+                  return &found->second.back()->message;
+               }
+               return nullptr;
+            }
+
+            void Cache::erase( const Uuid& correlation)
+            {
+               auto found = m_correlations.find( correlation);
+
+               if( found != std::end( m_correlations))
+               {
+                  //
+                  // extract removes the index when the last one is gone
+                  //
+                  auto positions = found->second;
+
+                  for( auto& position : positions)
+                  {
+                     extract( position);
+                  }
+               }
+            }
+
+            Cache::Entry& Cache::insert( complete_type&& message)
+            {
+               auto type = message.type;
+
+               m_entries.emplace_back( std::move( message), m_sequence++);
+               auto position = std::prev( std::end( m_entries));
+
+               auto& types = m_types[ type];
+               position->type = types.insert( std::end( types), position);
+
+               auto& correlations = m_correlations[ position->message.correlation];
+               position->correlation = correlations.insert( std::end( correlations), position);
+
+               ++m_statistics.depth;
+               m_statistics.high = std::max( m_statistics.high, m_statistics.depth);
+
+               return *position;
+            }
+
+            Cache::complete_type Cache::extract( position_type position)
+            {
+               //
+               // Remove the indexes before we move the message, since they refer to
+               // the message
+               //
+               {
+                  auto found = m_correlations.find( position->message.correlation);
+                  found->second.erase( position->correlation);
+
+                  if( found->second.empty())
+                  {
+                     m_correlations.erase( found);
+                  }
+               }
+
+               {
+                  auto found = m_types.find( position->message.type);
+                  found->second.erase( position->type);
+
+                  if( found->second.empty())
+                  {
+                     m_types.erase( found);
+                  }
+               }
+
+               auto result = std::move( position->message);
+               m_entries.erase( position);
+               --m_statistics.depth;
+
+               return result;
+            }
+
+            std::ostream& operator << ( std::ostream& out, const Cache::Statistics& value)
+            {
+               return out << "{ depth: " << value.depth
+                     << ", high: " << value.high
+                     << ", transports: " << value.transports
+                     << ", out_of_order: " << value.out_of_order
+                     << '}';
+            }
+
+         } // inbound
+      } // communication
+   } // common
+} // casual
@@ -11,8 +11,15 @@
 
 
 #include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <array>
 
 #include <sys/msg.h>
+#include <poll.h>
+#include <fcntl.h>
 
 namespace casual
 {
@@ -137,6 +144,171 @@ namespace casual
 
             namespace inbound
             {
+               //!
+               //! Moves transports from the ipc-queue to an in-memory queue, and signals
+               //! a pipe, so the owner can poll
+               //!
+               //! The pipe is signaled when a transport arrives, and drained when the owner has
+               //! received all that has arrived. The worker stops reading the ipc-queue when
+               //! platform::notify_transports are held in memory.
+               //!
+               struct Notify
+               {
+                  Notify( handle_type id) : m_id{ id}
+                  {
+                     if( pipe( m_pipe.data()) == -1)
+                     {
+                        throw exception::invalid::Argument( "failed to create notification pipe - " + common::error::string(), __FILE__, __LINE__);
+                     }
+
+                     for( auto fd : m_pipe)
+                     {
+                        fcntl( fd, F_SETFL, fcntl( fd, F_GETFL) | O_NONBLOCK);
+                        fcntl( fd, F_SETFD, FD_CLOEXEC);
+                     }
+
+                     //
+                     // The worker should not get any signals, the owner shall handle them
+                     //
+                     common::signal::thread::scope::Block block;
+                     m_thread = std::thread{ &Notify::worker, this};
+                  }
+
+                  ~Notify()
+                  {
+                     //
+                     // The worker exits when the ipc-queue is removed, which the owner has done.
+                     // Wake it up if it waits for room
+                     //
+                     {
+                        std::lock_guard< std::mutex> lock{ m_mutex};
+                        m_removed = true;
+                     }
+                     m_room.notify_one();
+
+                     if( m_thread.joinable())
+                     {
+                        m_thread.join();
+                     }
+
+                     for( auto fd : m_pipe)
+                     {
+                        close( fd);
+                     }
+                  }
+
+                  int descriptor() const { return m_pipe[ 0];}
+
+                  bool receive( message::Transport& transport, long flags)
+                  {
+                     while( true)
+                     {
+                        {
+                           std::lock_guard< std::mutex> lock{ m_mutex};
+
+                           if( ! m_transports.empty())
+                           {
+                              transport = m_transports.front();
+                              m_transports.pop_front();
+
+                              if( m_transports.empty())
+                              {
+                                 drain();
+                              }
+                              m_room.notify_one();
+                              return true;
+                           }
+
+                           if( m_done)
+                           {
+                              throw exception::queue::Unavailable{ "queue removed - id: " + std::to_string( m_id)};
+                           }
+                        }
+
+                        if( flags & platform::cIPC_NO_WAIT)
+                        {
+                           return false;
+                        }
+
+                        struct pollfd descriptor{ m_pipe[ 0], POLLIN, 0};
+
+                        if( poll( &descriptor, 1, -1) == -1)
+                        {
+                           if( errno != EINTR)
+                           {
+                              throw exception::invalid::Argument( "notification poll failed - " + common::error::string(), __FILE__, __LINE__);
+                           }
+                           log::internal::ipc << "ipc::inbound::Notify::receive - signal received\n";
+                           common::signal::handle();
+                        }
+                     }
+                  }
+
+               private:
+
+                  void worker()
+                  {
+                     try
+                     {
+                        while( true)
+                        {
+                           {
+                              std::unique_lock< std::mutex> lock{ m_mutex};
+                              m_room.wait( lock, [&](){ return m_removed || m_transports.size() < platform::notify_transports;});
+                           }
+
+                           message::Transport transport;
+
+                           if( native::receive( m_id, transport, 0))
+                           {
+                              std::lock_guard< std::mutex> lock{ m_mutex};
+                              m_transports.push_back( transport);
+                              notify();
+                           }
+                        }
+                     }
+                     catch( ...)
+                     {
+                        //
+                        // The queue is removed (or something worse), either way we're done
+                        //
+                        std::lock_guard< std::mutex> lock{ m_mutex};
+                        m_done = true;
+                        notify();
+                     }
+                  }
+
+                  void notify()
+                  {
+                     if( m_signaled)
+                     {
+                        return;
+                     }
+
+                     char value = 1;
+                     while( write( m_pipe[ 1], &value, 1) == -1 && errno == EINTR)
+                        ;
+                     m_signaled = true;
+                  }
+
+                  void drain()
+                  {
+                     std::array< char, 64> buffer;
+                     while( read( m_pipe[ 0], buffer.data(), buffer.size()) > 0)
+                        ;
+                     m_signaled = false;
+                  }
+
+                  handle_type m_id;
+                  std::array< int, 2> m_pipe;
+                  std::mutex m_mutex;
+                  std::condition_variable m_room;
+                  std::deque< message::Transport> m_transports;
+                  bool m_signaled = false;
+                  bool m_removed = false;
+                  bool m_done = false;
+                  std::thread m_thread;
+               };
 
                Connector::Connector()
                 : m_id( msgget( IPC_PRIVATE, IPC_CREAT | 0660))
@@ -151,6 +323,29 @@ namespace casual
                Connector::~Connector()
                {
                   remove( m_id);
+
+                  //
+                  // Make sure we wait for the worker to see that the queue is removed
+                  //
+                  m_notify.reset();
+               }
+
+               int Connector::descriptor()
+               {
+                  if( ! m_notify)
+                  {
+                     m_notify.reset( new Notify{ m_id});
+                  }
+                  return m_notify->descriptor();
+               }
+
+               bool Connector::receive( message::Transport& transport, long flags)
+               {
+                  if( m_notify)
+                  {
+                     return m_notify->receive( transport, flags);
+                  }
+                  return native::receive( m_id, transport, flags);
                }
 
                Connector::Connector( Connector&& rhs) noexcept
@@ -169,6 +364,7 @@ namespace casual
                {
                   using std::swap;
                   swap( lhs.m_id, rhs.m_id);
+                  swap( lhs.m_notify, rhs.m_notify);
                }
 
 
@@ -205,7 +401,7 @@ namespace casual
 
                bool basic_blocking::operator() ( inbound::Connector& ipc, message::Transport& transport)
                {
-                  return native::receive( ipc.id(), transport, 0);
+                  return ipc.receive( transport, 0);
                }
 
                bool basic_blocking::operator() ( const outbound::Connector& ipc, const message::Transport& transport)
@@ -218,7 +414,7 @@ namespace casual
                {
                   bool basic_blocking::operator() ( inbound::Connector& ipc, message::Transport& transport)
                   {
-                     return native::receive( ipc.id(), transport, platform::cIPC_NO_WAIT);
+                     return ipc.receive( transport, platform::cIPC_NO_WAIT);
                   }
 
                   bool basic_blocking::operator() ( const outbound::Connector& ipc, const message::Transport& transport)
@@ -283,6 +479,11 @@ namespace casual
                   if( msgctl( id, IPC_RMID, nullptr) == 0)
                   {
                      log::internal::ipc << "queue id: " << id << " removed\n";
+
+                     //
+                     // Segments sent to the queue will never be consumed
+                     //
+                     communication::message::segment::clear( id);
                      return true;
                   }
                   else
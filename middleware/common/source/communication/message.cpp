@@ -7,6 +7,18 @@
 
 
 #include "common/communication/message.h"
+#include "common/environment.h"
+#include "common/exception.h"
+#include "common/error.h"
+#include "common/internal/log.h"
+#include "common/algorithm.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <dirent.h>
+
+#include <memory>
 
 namespace casual
 {
@@ -19,6 +31,210 @@ namespace casual
 
          namespace message
          {
+            namespace segment
+            {
+               namespace local
+               {
+                  namespace
+                  {
+                     std::size_t initialize_threshold()
+                     {
+                        if( environment::variable::exists( "CASUAL_TRANSPORT_SEGMENT_THRESHOLD"))
+                        {
+                           return environment::variable::get< std::size_t>( "CASUAL_TRANSPORT_SEGMENT_THRESHOLD");
+                        }
+                        return 256 * 1024;
+                     }
+
+                     std::size_t& threshold()
+                     {
+                        static std::size_t size = initialize_threshold();
+                        return size;
+                     }
+
+                     const std::string prefix{ "casual-segment-"};
+
+                     std::string name( const Descriptor& descriptor)
+                     {
+                        return "/" + prefix + std::to_string( descriptor.owner) + "-" + uuid::string( descriptor.id);
+                     }
+
+                     //!
+                     //! Calls @p functor with the name (without the leading '/') and the owner of each segment
+                     //!
+                     template< typename F>
+                     void segments( F&& functor)
+                     {
+                        //
+                        // shm_open names lives in /dev/shm
+                        //
+                        std::unique_ptr< DIR, int(*)( DIR*)> directory{ opendir( "/dev/shm"), &closedir};
+
+                        if( ! directory)
+                        {
+                           return;
+                        }
+
+                        while( auto entry = readdir( directory.get()))
+                        {
+                           std::string name = entry->d_name;
+
+                           if( name.compare( 0, prefix.size(), prefix) != 0)
+                           {
+                              continue;
+                           }
+
+                           auto separator = name.rfind( '-');
+
+                           if( separator < prefix.size())
+                           {
+                              continue;
+                           }
+
+                           auto owner = name.substr( prefix.size(), separator - prefix.size());
+
+                           try
+                           {
+                              std::size_t parsed = 0;
+                              auto value = std::stoi( owner, &parsed);
+
+                              if( parsed == owner.size())
+                              {
+                                 functor( name, value);
+                              }
+                           }
+                           catch( const std::logic_error&)
+                           {
+                              // not one of ours
+                           }
+                        }
+                     }
+
+                  } // <unnamed>
+               } // local
+
+               std::size_t threshold()
+               {
+                  return local::threshold();
+               }
+
+               void threshold( std::size_t size)
+               {
+                  local::threshold() = size;
+               }
+
+               Descriptor create( const platform::binary_type& payload, platform::queue_id_type owner)
+               {
+                  Descriptor result;
+                  uuid::make().copy( result.id);
+                  result.size = payload.size();
+                  result.owner = owner;
+
+                  auto name = local::name( result);
+
+                  auto fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+
+                  if( fd == -1)
+                  {
+                     throw exception::invalid::Argument( "segment create failed - " + name + " - " + common::error::string(), __FILE__, __LINE__);
+                  }
+
+                  scope::Execute close{ [=](){ ::close( fd);}};
+                  scope::Execute unlink{ [&](){ shm_unlink( name.c_str());}};
+
+                  auto current = payload.data();
+                  auto left = payload.size();
+
+                  while( left > 0)
+                  {
+                     auto written = ::write( fd, current, left);
+
+                     if( written == -1)
+                     {
+                        if( errno == EINTR)
+                        {
+                           continue;
+                        }
+                        throw exception::limit::Memory{ "segment write failed - " + name + " - " + common::error::string()};
+                     }
+                     current += written;
+                     left -= written;
+                  }
+
+                  unlink.release();
+
+                  log::internal::ipc << "segment: " << name << " created - size: " << result.size << '\n';
+
+                  return result;
+               }
+
+               void consume( const Descriptor& descriptor, platform::binary_type& payload)
+               {
+                  auto name = local::name( descriptor);
+
+                  auto fd = shm_open( name.c_str(), O_RDONLY, 0);
+
+                  if( fd == -1)
+                  {
+                     throw exception::invalid::Argument( "segment open failed - " + name + " - " + common::error::string(), __FILE__, __LINE__);
+                  }
+
+                  //
+                  // We own the segment from now on
+                  //
+                  shm_unlink( name.c_str());
+                  scope::Execute close{ [=](){ ::close( fd);}};
+
+                  payload.resize( descriptor.size);
+
+                  if( descriptor.size > 0)
+                  {
+                     auto address = mmap( nullptr, descriptor.size, PROT_READ, MAP_SHARED, fd, 0);
+
+                     if( address == MAP_FAILED)
+                     {
+                        throw exception::limit::Memory{ "segment mmap failed - " + name + " - " + common::error::string()};
+                     }
+
+                     memory::copy( range::make( static_cast< const char*>( address), descriptor.size), range::make( payload));
+                     munmap( address, descriptor.size);
+                  }
+
+                  log::internal::ipc << "segment: " << name << " consumed - size: " << descriptor.size << '\n';
+               }
+
+               void remove( const Descriptor& descriptor)
+               {
+                  auto name = local::name( descriptor);
+
+                  if( shm_unlink( name.c_str()) == 0)
+                  {
+                     log::internal::ipc << "segment: " << name << " removed\n";
+                  }
+               }
+
+               void clear( platform::queue_id_type owner)
+               {
+                  local::segments( [&]( const std::string& name, platform::queue_id_type current){
+                     if( current == owner && shm_unlink( ( "/" + name).c_str()) == 0)
+                     {
+                        log::internal::ipc << "segment: " << name << " removed - owner: " << owner << '\n';
+                     }
+                  });
+               }
+
+               std::vector< platform::queue_id_type> owners()
+               {
+                  std::vector< platform::queue_id_type> result;
+
+                  local::segments( [&]( const std::string&, platform::queue_id_type owner){
+                     result.push_back( owner);
+                  });
+
+                  return range::to_vector( range::unique( range::sort( result)));
+               }
+
+            } // segment
 
             Complete::Complete( Complete&& rhs) noexcept
             {
@@ -0,0 +1,576 @@
+//!
+//! shared.cpp
+//!
+//! Created on: Oct 17, 2016
+//!     Author: Lazan
+//!
+
+#include "common/communication/shared.h"
+#include "common/exception.h"
+#include "common/error.h"
+#include "common/internal/log.h"
+
+
+#include <atomic>
+#include <climits>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <signal.h>
+
+#ifdef __APPLE__
+#include <thread>
+#else
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+namespace casual
+{
+   namespace common
+   {
+
+      namespace communication
+      {
+         namespace shared
+         {
+            namespace ring
+            {
+               static_assert( ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2, "shared ring needs lock free atomics");
+
+               struct Header
+               {
+                  //!
+                  //! Tells if the segment is initialized
+                  //!
+                  std::uint64_t magic;
+                  std::uint64_t capacity;
+                  platform::pid_type owner;
+
+                  //!
+                  //! next position to write, shared by all producers
+                  //!
+                  alignas( 64) std::atomic< std::uint64_t> head;
+
+                  //!
+                  //! next position to read, only the owner reads
+                  //!
+                  alignas( 64) std::atomic< std::uint64_t> tail;
+
+                  //!
+                  //! futex words that is bumped when a transport has been written/read,
+                  //! and the number of waiters on each.
+                  //!
+                  alignas( 64) std::atomic< std::uint32_t> readable;
+                  std::atomic< std::uint32_t> readers;
+
+                  alignas( 64) std::atomic< std::uint32_t> writable;
+                  std::atomic< std::uint32_t> writers;
+               };
+
+               struct Slot
+               {
+                  std::atomic< std::uint64_t> sequence;
+                  message::Transport::message_t message;
+               };
+
+               namespace local
+               {
+                  namespace
+                  {
+                     constexpr std::uint64_t magic = 0x63617375616c7368;
+
+                     std::string name( const handle_type& id)
+                     {
+                        return "/casual-" + uuid::string( id);
+                     }
+
+                     std::size_t size( std::size_t capacity)
+                     {
+                        return sizeof( Header) + sizeof( Slot) * capacity;
+                     }
+
+                     std::size_t power_of_two( std::size_t value)
+                     {
+                        std::size_t result = 1;
+                        while( result < value)
+                        {
+                           result <<= 1;
+                        }
+                        return result;
+                     }
+
+                     namespace futex
+                     {
+                        //!
+                        //! Waits until @p word is changed from @p expected, or until timeout.
+                        //!
+                        //! @return false if timeout, true otherwise
+                        //!
+                        bool wait( std::atomic< std::uint32_t>& word, std::uint32_t expected, const std::chrono::microseconds& timeout)
+                        {
+#ifdef __APPLE__
+                           //
+                           // No futex on OSX, we just poll
+                           //
+                           std::this_thread::sleep_for( std::min( timeout, std::chrono::microseconds{ 1000}));
+                           return word.load() != expected;
+#else
+                           auto seconds = std::chrono::duration_cast< std::chrono::seconds>( timeout);
+                           struct timespec time;
+                           time.tv_sec = seconds.count();
+                           time.tv_nsec = std::chrono::duration_cast< std::chrono::nanoseconds>( timeout - seconds).count();
+
+                           if( syscall( SYS_futex, reinterpret_cast< std::uint32_t*>( &word), FUTEX_WAIT, expected, &time, nullptr, 0) == -1)
+                           {
+                              switch( errno)
+                              {
+                                 case EINTR:
+                                 {
+                                    log::internal::ipc << "shared::futex::wait - signal received\n";
+                                    common::signal::handle();
+                                    return true;
+                                 }
+                                 case EAGAIN:
+                                 {
+                                    return true;
+                                 }
+                                 case ETIMEDOUT:
+                                 {
+                                    return false;
+                                 }
+                                 default:
+                                 {
+                                    throw exception::invalid::Argument( "futex wait failed - " + common::error::string(), __FILE__, __LINE__);
+                                 }
+                              }
+                           }
+                           return true;
+#endif
+                        }
+
+                        void wake( std::atomic< std::uint32_t>& word, int count)
+                        {
+#ifndef __APPLE__
+                           syscall( SYS_futex, reinterpret_cast< std::uint32_t*>( &word), FUTEX_WAKE, count, nullptr, nullptr, 0);
+#endif
+                        }
+
+                     } // futex
+
+                  } // <unnamed>
+               } // local
+
+
+               struct Segment
+               {
+                  Segment( const handle_type& id, std::size_t capacity) : m_owner{ true}
+                  {
+                     capacity = local::power_of_two( capacity);
+
+                     auto name = local::name( id);
+
+                     auto fd = shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+
+                     if( fd == -1)
+                     {
+                        throw exception::invalid::Argument( "shared ring create failed - " + name + " - " + common::error::string(), __FILE__, __LINE__);
+                     }
+
+                     scope::Execute close{ [=](){ ::close( fd);}};
+
+                     //
+                     // Don't leave the name behind if we fail to set up the segment
+                     //
+                     scope::Execute unlink{ [&](){ shm_unlink( name.c_str());}};
+
+                     m_size = local::size( capacity);
+
+                     if( ftruncate( fd, m_size) == -1)
+                     {
+                        throw exception::limit::Memory{ "shared ring " + name + " - " + common::error::string()};
+                     }
+
+                     map( fd);
+                     unlink.release();
+
+                     m_header = new ( m_address) Header{};
+                     m_header->capacity = capacity;
+                     m_header->owner = process::id();
+
+                     m_slots = reinterpret_cast< Slot*>( m_header + 1);
+
+                     for( std::uint64_t index = 0; index < capacity; ++index)
+                     {
+                        new ( m_slots + index) Slot{};
+                        m_slots[ index].sequence.store( index, std::memory_order_relaxed);
+                     }
+
+                     //
+                     // Publish the segment to producers
+                     //
+                     std::atomic_thread_fence( std::memory_order_release);
+                     m_header->magic = local::magic;
+
+                     log::internal::ipc << "shared ring: " << id << " created - capacity: " << capacity << '\n';
+                  }
+
+                  Segment( const handle_type& id) : m_owner{ false}
+                  {
+                     auto name = local::name( id);
+
+                     auto fd = shm_open( name.c_str(), O_RDWR, 0);
+
+                     if( fd == -1)
+                     {
+                        throw exception::queue::Unavailable{ "shared ring unavailable - id: " + uuid::string( id) + " - " + common::error::string()};
+                     }
+
+                     scope::Execute close{ [=](){ ::close( fd);}};
+
+                     struct stat information;
+
+                     if( fstat( fd, &information) == -1 || information.st_size < static_cast< off_t>( sizeof( Header)))
+                     {
+                        throw exception::queue::Unavailable{ "shared ring not initialized - id: " + uuid::string( id)};
+                     }
+                     m_size = information.st_size;
+
+                     map( fd);
+
+                     m_header = reinterpret_cast< Header*>( m_address);
+                     m_slots = reinterpret_cast< Slot*>( m_header + 1);
+
+                     if( m_header->magic != local::magic || local::size( m_header->capacity) != m_size)
+                     {
+                        //
+                        // dtor is not invoked when we throw from the ctor
+                        //
+                        munmap( m_address, m_size);
+                        throw exception::queue::Unavailable{ "shared ring not initialized - id: " + uuid::string( id)};
+                     }
+                     std::atomic_thread_fence( std::memory_order_acquire);
+                  }
+
+                  ~Segment()
+                  {
+                     if( m_address)
+                     {
+                        munmap( m_address, m_size);
+                     }
+                  }
+
+                  Segment( const Segment&) = delete;
+                  Segment& operator = ( const Segment&) = delete;
+
+                  //!
+                  //! Called only by the producers
+                  //!
+                  bool push( const message::Transport& transport)
+                  {
+                     auto position = m_header->head.load( std::memory_order_relaxed);
+                     Slot* slot = nullptr;
+
+                     while( true)
+                     {
+                        slot = m_slots + ( position & ( m_header->capacity - 1));
+                        auto sequence = slot->sequence.load( std::memory_order_acquire);
+                        auto difference = static_cast< std::int64_t>( sequence - position);
+
+                        if( difference == 0)
+                        {
+                           if( m_header->head.compare_exchange_weak( position, position + 1, std::memory_order_relaxed))
+                           {
+                              break;
+                           }
+                        }
+                        else if( difference < 0)
+                        {
+                           //
+                           // full
+                           //
+                           return false;
+                        }
+                        else
+                        {
+                           position = m_header->head.load( std::memory_order_relaxed);
+                        }
+                     }
+
+                     auto size = message::Transport::header_size + transport.size() + sizeof( message::Transport::message_type_type);
+                     memory::copy( range::make( reinterpret_cast< const char*>( &transport.message), size),
+                           range::make( reinterpret_cast< char*>( &slot->message), size));
+
+                     slot->sequence.store( position + 1, std::memory_order_release);
+
+                     m_header->readable.fetch_add( 1);
+
+                     if( m_header->readers.load() > 0)
+                     {
+                        local::futex::wake( m_header->readable, 1);
+                     }
+                     return true;
+                  }
+
+                  //!
+                  //! Called only by the owner
+                  //!
+                  bool pop( message::Transport& transport)
+                  {
+                     auto position = m_header->tail.load( std::memory_order_relaxed);
+                     auto& slot = m_slots[ position & ( m_header->capacity - 1)];
+
+                     if( slot.sequence.load( std::memory_order_acquire) != position + 1)
+                     {
+                        //
+                        // empty
+                        //
+                        return false;
+                     }
+
+                     auto size = message::Transport::header_size + slot.message.header.count + sizeof( message::Transport::message_type_type);
+                     memory::copy( range::make( reinterpret_cast< const char*>( &slot.message), size),
+                           range::make( reinterpret_cast< char*>( &transport.message), size));
+
+                     slot.sequence.store( position + m_header->capacity, std::memory_order_release);
+                     m_header->tail.store( position + 1, std::memory_order_relaxed);
+
+                     m_header->writable.fetch_add( 1);
+
+                     if( m_header->writers.load() > 0)
+                     {
+                        local::futex::wake( m_header->writable, INT_MAX);
+                     }
+                     return true;
+                  }
+
+                  bool empty() const
+                  {
+                     auto position = m_header->tail.load( std::memory_order_relaxed);
+                     return m_slots[ position & ( m_header->capacity - 1)].sequence.load( std::memory_order_acquire) != position + 1;
+                  }
+
+                  bool full() const
+                  {
+                     auto position = m_header->head.load( std::memory_order_relaxed);
+                     return m_slots[ position & ( m_header->capacity - 1)].sequence.load( std::memory_order_acquire) < position;
+                  }
+
+                  //!
+                  //! Blocks until a transport is pushed to the ring (or a signal or timeout)
+                  //!
+                  void wait_readable()
+                  {
+                     wait( m_header->readable, m_header->readers, [&](){ return ! empty();}, std::chrono::seconds{ 1});
+                  }
+
+                  //!
+                  //! Blocks until a transport is popped from the ring (or a signal or timeout)
+                  //!
+                  //! @return false if timeout
+                  //!
+                  bool wait_writable()
+                  {
+                     return wait( m_header->writable, m_header->writers, [&](){ return ! full();}, std::chrono::seconds{ 1});
+                  }
+
+                  bool alive() const
+                  {
+                     return ! ( kill( m_header->owner, 0) == -1 && errno == ESRCH);
+                  }
+
+                  std::size_t capacity() const { return m_header->capacity;}
+
+               private:
+
+                  template< typename P>
+                  bool wait( std::atomic< std::uint32_t>& word, std::atomic< std::uint32_t>& waiters, P&& ready, const std::chrono::microseconds& timeout)
+                  {
+                     ++waiters;
+                     scope::Execute decrement{ [&](){ --waiters;}};
+
+                     auto value = word.load();
+
+                     //
+                     // We need to check again, after we've registered us as a waiter,
+                     // the other side could have done it's thing before it saw us waiting.
+                     //
+                     if( ready())
+                     {
+                        return true;
+                     }
+
+                     return local::futex::wait( word, value, timeout);
+                  }
+
+                  void map( int fd)
+                  {
+                     auto address = mmap( nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+                     if( address == MAP_FAILED)
+                     {
+                        throw exception::limit::Memory{ "shared ring mmap failed - " + common::error::string()};
+                     }
+                     m_address = address;
+                  }
+
+                  bool m_owner = false;
+                  void* m_address = nullptr;
+                  std::size_t m_size = 0;
+                  Header* m_header = nullptr;
+                  Slot* m_slots = nullptr;
+               };
+
+            } // ring
+
+
+            namespace native
+            {
+               bool send( const outbound::Connector& ring, const message::Transport& transport, long flags)
+               {
+                  auto& segment = *ring.m_segment;
+
+                  while( ! segment.push( transport))
+                  {
+                     if( flags & c_non_blocking)
+                     {
+                        return false;
+                     }
+
+                     if( ! segment.wait_writable() && ! segment.alive())
+                     {
+                        //
+                        // Owner is gone, and no one will ever consume the ring
+                        //
+                        throw exception::queue::Unavailable{ "shared ring unavailable - id: " + uuid::string( ring.id()) + " - owner is dead"};
+                     }
+                  }
+
+                  log::internal::ipc << "---> [" << ring.id() << "] send transport: " << transport << " - flags: " << flags << '\n';
+
+                  return true;
+               }
+
+               bool receive( inbound::Connector& ring, message::Transport& transport, long flags)
+               {
+                  auto& segment = *ring.m_segment;
+
+                  while( ! segment.pop( transport))
+                  {
+                     if( flags & c_non_blocking)
+                     {
+                        return false;
+                     }
+                     segment.wait_readable();
+                  }
+
+                  log::internal::ipc << "<--- [" << ring.id() << "] receive transport: " << transport << " - flags: " << flags << '\n';
+
+                  return true;
+               }
+
+            } // native
+
+            namespace inbound
+            {
+               Connector::Connector() : Connector( ring::capacity) {}
+
+               Connector::Connector( std::size_t capacity)
+                  : m_id( uuid::make()), m_segment{ new ring::Segment{ m_id, capacity}}
+               {
+               }
+
+               Connector::~Connector()
+               {
+                  if( m_segment)
+                  {
+                     //
+                     // Unlink the name, producers that has the ring mapped will keep it alive until
+                     // they unmap, but no one will be able to open it
+                     //
+                     if( shm_unlink( ring::local::name( m_id).c_str()) == 0)
+                     {
+                        log::internal::ipc << "shared ring: " << m_id << " removed\n";
+                     }
+                     else
+                     {
+                        log::error << "failed to remove shared ring with id: " << m_id << " - " << common::error::string() << "\n";
+                     }
+                  }
+               }
+
+               Connector::Connector( Connector&& rhs) noexcept
+               {
+                  swap( *this, rhs);
+               }
+
+               Connector& Connector::operator = ( Connector&& rhs) noexcept
+               {
+                  Connector temp{ std::move( rhs)};
+                  swap( *this, temp);
+                  return *this;
+               }
+
+               void swap( Connector& lhs, Connector& rhs)
+               {
+                  using std::swap;
+                  swap( lhs.m_id, rhs.m_id);
+                  swap( lhs.m_segment, rhs.m_segment);
+               }
+
+            } // inbound
+
+            namespace outbound
+            {
+               Connector::Connector( const handle_type& id)
+                  : m_id( id), m_segment{ std::make_shared< ring::Segment>( id)}
+               {
+               }
+
+            } // outbound
+
+            namespace policy
+            {
+               bool basic_blocking::operator() ( inbound::Connector& ring, message::Transport& transport)
+               {
+                  return native::receive( ring, transport, 0);
+               }
+
+               bool basic_blocking::operator() ( const outbound::Connector& ring, const message::Transport& transport)
+               {
+                  return native::send( ring, transport, 0);
+               }
+
+               namespace non
+               {
+                  bool basic_blocking::operator() ( inbound::Connector& ring, message::Transport& transport)
+                  {
+                     return native::receive( ring, transport, native::c_non_blocking);
+                  }
+
+                  bool basic_blocking::operator() ( const outbound::Connector& ring, const message::Transport& transport)
+                  {
+                     return native::send( ring, transport, native::c_non_blocking);
+                  }
+
+               } // non
+            } // policy
+
+            bool exists( const handle_type& id)
+            {
+               auto fd = shm_open( ring::local::name( id).c_str(), O_RDONLY, 0);
+
+               if( fd == -1)
+               {
+                  return false;
+               }
+               close( fd);
+               return true;
+            }
+
+         } // shared
+
+      } // communication
+   } // common
+} // casual
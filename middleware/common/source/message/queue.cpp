@@ -8,6 +8,7 @@
 #include "common/message/queue.h"
 
 #include "common/chronology.h"
+#include "common/algorithm.h"
 
 
 namespace casual
@@ -43,6 +44,19 @@ namespace casual
                         << '}';
                }
 
+               namespace batch
+               {
+                  std::ostream& operator << ( std::ostream& out, const Request& value)
+                  {
+                     return out << "{ correlation: " << value.correlation
+                           << ", process: " << value.process
+                           << ", trid: " << value.trid
+                           << ", queue: " << value.queue
+                           << ", messages: " << range::make( value.messages)
+                           << '}';
+                  }
+               } // batch
+
             } // enqueue
 
             namespace dequeue
@@ -58,6 +72,7 @@ namespace casual
                {
                   return out << "{ qid: " << value.queue
                      << ", block: " << std::boolalpha << value.block
+                     << ", count: " << value.count
                      << ", selector: " << value.selector
                      << ", process: " << value.process
                      << ", trid: " << value.trid << '}';
@@ -91,6 +106,7 @@ namespace casual
                      << ", type: " << value.type
                      << ", retries: " << value.retries
                      << ", error: " << value.error
+                     << ", persistent: " << std::boolalpha << value.persistent
                      << '}';
 
             }
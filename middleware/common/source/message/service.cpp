@@ -29,7 +29,7 @@ namespace casual
                      case Reply::State::busy: out << "busy"; break;
                   }
 
-                  return out << '}';
+                  return out << ", reserved: " << std::boolalpha << value.reserved << '}';
                }
 
             } // lookup
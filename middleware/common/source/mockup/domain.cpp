@@ -323,6 +323,7 @@ namespace casual
                   {
                      reply = found->second;
                      reply.state = message::service::lookup::Reply::State::idle;
+                     reply.reserved = request.reserve;
                   }
                   else
                   {
@@ -478,6 +479,7 @@ namespace casual
                      {
                         auto reply = found->second;
                         reply.correlation = r.correlation;
+                        reply.reserved = r.reserve && reply.state == decltype( reply)::State::idle;
                         return local::result_set( r.process, reply);
                      }
 
@@ -486,6 +488,11 @@ namespace casual
 
                      return local::result_set( r.process, reply);
                   },
+                  []( message::service::lookup::Release r)
+                  {
+                     Trace trace{ "mockup service::lookup::Release", log::internal::debug};
+                     return std::vector< reply::result_t>{};
+                  },
                   []( common::message::transaction::manager::Ready r)
                   {
                      Trace trace{ "mockup common::message::transaction::manager::Ready", log::internal::debug};
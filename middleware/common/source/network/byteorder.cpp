@@ -8,6 +8,7 @@
 #include "common/network/byteorder.h"
 
 #include <memory>
+#include <cstring>
 
 #include <unistd.h>
 
@@ -200,7 +201,51 @@ namespace casual
                }
 
 
+               namespace local
+               {
+                  namespace
+                  {
+                     //
+                     // memcpy to and from the (possible unaligned) memory, which lets the
+                     // compiler vectorize the loop
+                     //
+                     template< typename T, typename F>
+                     void transcode( const char* first, std::size_t count, char* out, F&& function) noexcept
+                     {
+                        for( auto last = first + count * sizeof( T); first != last; first += sizeof( T), out += sizeof( T))
+                        {
+                           T value;
+                           std::memcpy( &value, first, sizeof( T));
+                           value = function( value);
+                           std::memcpy( out, &value, sizeof( T));
+                        }
+                     }
+                  } // <unnamed>
+               } // local
+
+               template<>
+               void transcode_range< 1>( const char* first, std::size_t count, char* out) noexcept
+               {
+                  std::memcpy( out, first, count);
+               }
+
+               template<>
+               void transcode_range< 2>( const char* first, std::size_t count, char* out) noexcept
+               {
+                  local::transcode< std::uint16_t>( first, count, out, []( std::uint16_t value){ return HTOBE16( value);});
+               }
 
+               template<>
+               void transcode_range< 4>( const char* first, std::size_t count, char* out) noexcept
+               {
+                  local::transcode< std::uint32_t>( first, count, out, []( std::uint32_t value){ return HTOBE32( value);});
+               }
+
+               template<>
+               void transcode_range< 8>( const char* first, std::size_t count, char* out) noexcept
+               {
+                  local::transcode< std::uint64_t>( first, count, out, []( std::uint64_t value){ return HTOBE64( value);});
+               }
 
             } // detail
          } // byteorder
@@ -161,6 +161,167 @@ namespace casual
             buffer::pool::Holder::instance().deallocate( handle);
          }
 
+         TEST( casual_common_buffer, pool_deallocate__get__throws)
+         {
+            auto handle = pool::Holder::instance().allocate( buffer::type::binary(), 64);
+
+            pool::Holder::instance().deallocate( handle);
+
+            EXPECT_THROW({
+               pool::Holder::instance().get( handle);
+            }, exception::xatmi::invalid::Argument);
+         }
+
+         TEST( casual_common_buffer, pool_release__insert__expect_same_payload)
+         {
+            const auto type = buffer::type::binary();
+            auto handle = pool::Holder::instance().allocate( type, 64);
+
+            auto payload = pool::Holder::instance().release( handle);
+            EXPECT_THROW({
+               pool::Holder::instance().get( handle);
+            }, exception::xatmi::invalid::Argument);
+
+            handle = pool::Holder::instance().insert( std::move( payload));
+
+            EXPECT_TRUE( pool::Holder::instance().type( handle) == type);
+            EXPECT_TRUE( pool::Holder::instance().get( handle).reserved == 64);
+
+            pool::Holder::instance().deallocate( handle);
+         }
+
+         TEST( casual_common_buffer, pool_allocate_1000__expect_each_found)
+         {
+            std::vector< platform::raw_buffer_type> handles;
+
+            for( auto size = 1; size <= 1000; ++size)
+            {
+               handles.push_back( pool::Holder::instance().allocate( buffer::type::binary(), size));
+            }
+
+            for( platform::binary_size_type size = 1; size <= 1000; ++size)
+            {
+               EXPECT_TRUE( pool::Holder::instance().get( handles[ size - 1]).reserved == size);
+            }
+
+            for( auto& handle : handles)
+            {
+               pool::Holder::instance().deallocate( handle);
+            }
+         }
+
+         TEST( casual_common_buffer, cache_take__recycle__take__expect_hit_and_same_memory)
+         {
+            auto& cache = Cache::instance();
+            cache.clear();
+
+            auto memory = cache.take( 100);
+            EXPECT_TRUE( memory.size() == 100);
+            EXPECT_TRUE( memory.capacity() >= 128);
+
+            auto data = memory.data();
+            cache.recycle( std::move( memory));
+
+            auto hits = cache.statistics().hits;
+
+            auto again = cache.take( 120);
+            EXPECT_TRUE( cache.statistics().hits == hits + 1);
+            EXPECT_TRUE( again.data() == data);
+            EXPECT_TRUE( again.size() == 120);
+            EXPECT_TRUE( range::all_of( again, []( char c){ return c == 0;}));
+         }
+
+         TEST( casual_common_buffer, cache_take_larger_class__expect_miss)
+         {
+            auto& cache = Cache::instance();
+            cache.clear();
+
+            cache.recycle( cache.take( 100));
+
+            auto misses = cache.statistics().misses;
+            cache.take( 1000);
+            EXPECT_TRUE( cache.statistics().misses == misses + 1);
+         }
+
+         TEST( casual_common_buffer, cache_limit__expect_discarded_when_exceeded)
+         {
+            auto& cache = Cache::instance();
+            cache.clear();
+
+            auto limit = cache.limit();
+            cache.limit( 1024);
+
+            auto discarded = cache.statistics().discarded;
+
+            auto first = cache.take( 1000);
+            auto second = cache.take( 1000);
+
+            cache.recycle( std::move( first));
+            EXPECT_TRUE( cache.statistics().retained == 1024);
+
+            cache.recycle( std::move( second));
+            EXPECT_TRUE( cache.statistics().discarded == discarded + 1);
+            EXPECT_TRUE( cache.statistics().retained == 1024);
+
+            cache.limit( 0);
+            EXPECT_TRUE( cache.statistics().retained == 0);
+
+            cache.limit( limit);
+         }
+
+         TEST( casual_common_buffer, cache_pool_allocate_deallocate__expect_memory_reused)
+         {
+            auto& cache = Cache::instance();
+            cache.clear();
+
+            auto handle = pool::Holder::instance().allocate( buffer::type::binary(), 500);
+            pool::Holder::instance().deallocate( handle);
+
+            auto hits = cache.statistics().hits;
+
+            auto again = pool::Holder::instance().allocate( buffer::type::binary(), 400);
+            EXPECT_TRUE( cache.statistics().hits == hits + 1);
+            EXPECT_TRUE( again == handle);
+            EXPECT_TRUE( pool::Holder::instance().get( again).reserved == 400);
+
+            pool::Holder::instance().deallocate( again);
+         }
+
+         TEST( casual_common_buffer, cache_unmarshal_payload__insert__expect_cached_memory)
+         {
+            auto& cache = Cache::instance();
+            cache.clear();
+
+            platform::binary_type marshal_buffer;
+            {
+               marshal::binary::Output output( marshal_buffer);
+               output << Payload{ buffer::type::binary(), platform::binary_type( 300, 'a')};
+            }
+
+            auto memory = cache.take( 300);
+            auto data = memory.data();
+            cache.recycle( std::move( memory));
+
+            auto hits = cache.statistics().hits;
+
+            Payload payload;
+            {
+               marshal::binary::Input input( marshal_buffer);
+               input >> payload;
+            }
+
+            EXPECT_TRUE( cache.statistics().hits == hits + 1);
+            EXPECT_TRUE( payload.memory.data() == data);
+            EXPECT_TRUE( payload.memory.size() == 300);
+            EXPECT_TRUE( range::all_of( payload.memory, []( char c){ return c == 'a';}));
+
+            auto handle = pool::Holder::instance().insert( std::move( payload));
+            EXPECT_TRUE( handle == data);
+
+            pool::Holder::instance().deallocate( handle);
+            EXPECT_TRUE( cache.statistics().retained == 512);
+         }
+
          TEST( casual_common_buffer, message_call)
          {
 
@@ -0,0 +1,344 @@
+//!
+//! test_call.cpp
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#include <gtest/gtest.h>
+
+#include "common/call/state.h"
+
+#include "common/mockup/ipc.h"
+#include "common/communication/ipc.h"
+#include "common/uuid.h"
+#include "common/exception.h"
+
+#include <vector>
+#include <chrono>
+
+
+namespace casual
+{
+   namespace common
+   {
+      namespace local
+      {
+         namespace
+         {
+            process::Handle instance( platform::pid_type pid)
+            {
+               process::Handle result;
+               result.pid = pid;
+               result.queue = pid;
+               return result;
+            }
+
+            message::service::lookup::Revoke revoke( platform::pid_type pid, message::service::lookup::Revoke::Reason reason)
+            {
+               message::service::lookup::Revoke result;
+               result.process = instance( pid);
+               result.reason = reason;
+               return result;
+            }
+
+            namespace pending
+            {
+               //!
+               //! Fills pending with @p outstanding calls
+               //!
+               void fill( call::State::Pending& pending, std::size_t outstanding)
+               {
+                  while( outstanding-- > 0)
+                  {
+                     pending.reserve( uuid::make());
+                  }
+               }
+
+               //!
+               //! @return the best of a few rounds of @p count invocations of @p functor, in nanoseconds per invocation
+               //!
+               template< typename F>
+               long measure( std::size_t count, F&& functor)
+               {
+                  auto best = std::chrono::steady_clock::duration::max();
+
+                  for( auto round = 0; round < 3; ++round)
+                  {
+                     auto start = std::chrono::steady_clock::now();
+
+                     for( std::size_t index = 0; index < count; ++index)
+                     {
+                        functor();
+                     }
+
+                     best = std::min( best, std::chrono::steady_clock::now() - start);
+                  }
+                  return std::chrono::duration_cast< std::chrono::nanoseconds>( best).count() / count;
+               }
+
+            } // pending
+
+         } // <unnamed>
+      } // local
+
+      TEST( casual_common_call_reservation, add__find_service__expect_reservation)
+      {
+         call::State::Reservations reservations;
+
+         reservations.add( message::Service{ "a"}, local::instance( 10));
+
+         auto found = reservations.find( "a");
+         ASSERT_TRUE( found != nullptr);
+         EXPECT_TRUE( found->process.pid == 10);
+         EXPECT_TRUE( reservations.find( "b") == nullptr);
+      }
+
+      TEST( casual_common_call_reservation, use__expect_not_free__done__expect_free)
+      {
+         call::State::Reservations reservations;
+
+         auto& reservation = reservations.add( message::Service{ "a"}, local::instance( 10));
+         reservations.use( reservation, 3);
+
+         EXPECT_TRUE( reservations.find( "a") == nullptr);
+
+         reservations.done( 3);
+
+         auto found = reservations.find( "a");
+         ASSERT_TRUE( found != nullptr);
+         EXPECT_TRUE( found->invoked == 1);
+      }
+
+      TEST( casual_common_call_reservation, revoke_deceased__expect_removed__no_release)
+      {
+         mockup::ipc::clear();
+
+         call::State::Reservations reservations;
+
+         auto& reservation = reservations.add( message::Service{ "a"}, local::instance( 10));
+         reservations.use( reservation, 3);
+
+         reservations.revoke( local::revoke( 10, message::service::lookup::Revoke::Reason::deceased));
+
+         EXPECT_TRUE( reservations.empty());
+
+         message::service::lookup::Release release;
+         EXPECT_FALSE( communication::ipc::non::blocking::receive( mockup::ipc::broker::queue().output(), release));
+      }
+
+      TEST( casual_common_call_reservation, revoke_pending__in_use__expect_release_when_done)
+      {
+         mockup::ipc::clear();
+
+         call::State::Reservations reservations;
+
+         auto& reservation = reservations.add( message::Service{ "a"}, local::instance( 10));
+         reservations.use( reservation, 3);
+
+         reservations.revoke( local::revoke( 10, message::service::lookup::Revoke::Reason::pending));
+
+         EXPECT_TRUE( reservations.size() == 1);
+         EXPECT_TRUE( reservations.find( "a") == nullptr);
+
+         message::service::lookup::Release release;
+         EXPECT_FALSE( communication::ipc::non::blocking::receive( mockup::ipc::broker::queue().output(), release));
+
+         reservations.done( 3);
+         EXPECT_TRUE( reservations.empty());
+
+         communication::ipc::blocking::receive( mockup::ipc::broker::queue().output(), release);
+         EXPECT_TRUE( release.instance.pid == 10);
+         EXPECT_TRUE( release.invoked == 1);
+         EXPECT_TRUE( release.process == process::handle());
+      }
+
+      TEST( casual_common_call_reservation, discard__expect_release)
+      {
+         mockup::ipc::clear();
+
+         call::State::Reservations reservations;
+
+         auto& reservation = reservations.add( message::Service{ "a"}, local::instance( 10));
+         reservations.use( reservation, 3);
+
+         reservations.discard( 3);
+         EXPECT_TRUE( reservations.empty());
+
+         message::service::lookup::Release release;
+         communication::ipc::blocking::receive( mockup::ipc::broker::queue().output(), release);
+         EXPECT_TRUE( release.instance.pid == 10);
+      }
+
+      TEST( casual_common_call_pending, reserve__expect_lowest_free_descriptor)
+      {
+         call::State::Pending pending;
+
+         EXPECT_TRUE( pending.empty());
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 1);
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 2);
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 3);
+
+         pending.unreserve( 2);
+         pending.unreserve( 1);
+
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 1);
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 2);
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 4);
+         EXPECT_FALSE( pending.empty());
+      }
+
+      TEST( casual_common_call_pending, reserve_20__expect_descriptors_beyond_preallocated)
+      {
+         call::State::Pending pending;
+         local::pending::fill( pending, 20);
+
+         EXPECT_TRUE( pending.active( 20));
+         EXPECT_FALSE( pending.active( 21));
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 21);
+      }
+
+      TEST( casual_common_call_pending, unreserve__expect_inactive__get_throws)
+      {
+         call::State::Pending pending;
+         auto descriptor = pending.reserve( uuid::make()).descriptor;
+
+         pending.unreserve( descriptor);
+
+         EXPECT_FALSE( pending.active( descriptor));
+         EXPECT_TRUE( pending.empty());
+         EXPECT_THROW( pending.get( descriptor), exception::xatmi::invalid::Descriptor);
+      }
+
+      TEST( casual_common_call_pending, unreserve_twice__expect_descriptor_handed_out_once)
+      {
+         call::State::Pending pending;
+         auto descriptor = pending.reserve( uuid::make()).descriptor;
+
+         pending.unreserve( descriptor);
+         pending.unreserve( descriptor);
+
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == descriptor);
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor != descriptor);
+      }
+
+      TEST( casual_common_call_pending, unreserve_unknown__expect_throw)
+      {
+         call::State::Pending pending;
+
+         EXPECT_THROW( pending.unreserve( 0), exception::xatmi::invalid::Descriptor);
+         EXPECT_THROW( pending.unreserve( 42), exception::xatmi::invalid::Descriptor);
+      }
+
+      TEST( casual_common_call_pending, correlation__expect_descriptor__unreserve__expect_0)
+      {
+         call::State::Pending pending;
+         local::pending::fill( pending, 5);
+
+         auto correlation = uuid::make();
+         auto descriptor = pending.reserve( correlation).descriptor;
+
+         EXPECT_TRUE( pending.descriptor( correlation) == descriptor);
+         EXPECT_TRUE( pending.get( descriptor).correlation == correlation);
+
+         pending.unreserve( descriptor);
+         EXPECT_TRUE( pending.descriptor( correlation) == 0);
+      }
+
+      TEST( casual_common_call_pending, outstanding_10k__expect_all_reachable_by_descriptor_and_correlation)
+      {
+         call::State::Pending pending;
+
+         std::vector< Uuid> correlations;
+
+         for( auto count = 0; count < 10000; ++count)
+         {
+            correlations.push_back( uuid::make());
+            EXPECT_TRUE( pending.reserve( correlations.back()).descriptor == count + 1);
+         }
+
+         for( auto descriptor = 1; descriptor <= 10000; ++descriptor)
+         {
+            auto& correlation = correlations[ descriptor - 1];
+
+            EXPECT_TRUE( pending.get( descriptor).correlation == correlation);
+            EXPECT_TRUE( pending.descriptor( correlation) == descriptor);
+         }
+      }
+
+      TEST( casual_common_call_pending, outstanding_10k__unreserve_in_the_middle__expect_descriptor_reused)
+      {
+         call::State::Pending pending;
+         local::pending::fill( pending, 10000);
+
+         auto correlation = uuid::make();
+         pending.unreserve( 5000);
+
+         EXPECT_FALSE( pending.active( 5000));
+         EXPECT_TRUE( pending.reserve( correlation).descriptor == 5000);
+         EXPECT_TRUE( pending.descriptor( correlation) == 5000);
+         EXPECT_TRUE( pending.reserve( uuid::make()).descriptor == 10001);
+      }
+
+      //
+      // Benchmark, run with --gtest_also_run_disabled_tests. The timings (ns per operation) are
+      // recorded as properties of the test, see --gtest_output=xml
+      //
+      TEST( casual_common_call_pending, DISABLED_benchmark__reserve_get_unreserve__100_vs_10k_outstanding)
+      {
+         const std::size_t count = 100000;
+         const std::size_t batch = 100;
+
+         for( auto outstanding : { 100, 10000})
+         {
+            call::State::Pending pending;
+            local::pending::fill( pending, outstanding);
+
+            std::vector< Uuid> correlations( batch);
+            for( auto& correlation : correlations)
+            {
+               correlation = uuid::make();
+            }
+            std::vector< platform::descriptor_type> descriptors;
+
+            //
+            // Reserve and unreserve a batch at the time, so the number outstanding stays close to
+            // what we want to measure
+            //
+            std::chrono::steady_clock::duration reserve{};
+            std::chrono::steady_clock::duration unreserve{};
+
+            for( std::size_t round = 0; round < count / batch; ++round)
+            {
+               auto start = std::chrono::steady_clock::now();
+               for( auto& correlation : correlations)
+               {
+                  descriptors.push_back( pending.reserve( correlation).descriptor);
+               }
+               auto middle = std::chrono::steady_clock::now();
+               for( auto descriptor : descriptors)
+               {
+                  pending.unreserve( descriptor);
+               }
+               unreserve += std::chrono::steady_clock::now() - middle;
+               reserve += middle - start;
+
+               descriptors.clear();
+            }
+
+            auto active = true;
+            auto get = local::pending::measure( count, [&](){
+               active = pending.get( outstanding).active && active;
+            });
+
+            EXPECT_TRUE( active);
+
+            auto name = std::to_string( outstanding);
+            RecordProperty( "reserve_ns_" + name, std::chrono::duration_cast< std::chrono::nanoseconds>( reserve).count() / count);
+            RecordProperty( "get_ns_" + name, get);
+            RecordProperty( "unreserve_ns_" + name, std::chrono::duration_cast< std::chrono::nanoseconds>( unreserve).count() / count);
+         }
+      }
+
+   } // common
+} // casual
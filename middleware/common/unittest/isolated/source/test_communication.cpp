@@ -8,9 +8,14 @@
 #include <gtest/gtest.h>
 
 #include "common/communication/ipc.h"
+#include "common/communication/shared.h"
 #include "common/message/type.h"
+#include "common/message/service.h"
 
 #include <random>
+#include <thread>
+
+#include <poll.h>
 
 namespace casual
 {
@@ -161,6 +166,397 @@ namespace casual
 
          }
 
+         TEST( casual_common_communication_shared, instanciate)
+         {
+            shared::inbound::Device device;
+         }
+
+         TEST( casual_common_communication_shared, exists)
+         {
+            shared::handle_type id;
+            {
+               shared::inbound::Device device;
+               id = device.connector().id();
+               EXPECT_TRUE( shared::exists( id));
+            }
+            EXPECT_FALSE( shared::exists( id));
+         }
+
+         TEST( casual_common_communication_shared, outbound_absent_ring__expect_throw)
+         {
+            EXPECT_THROW({
+               shared::outbound::Device device{ uuid::make()};
+            }, exception::queue::Unavailable);
+         }
+
+         TEST( casual_common_communication_shared, non_blocking_receive__expect_no_messages)
+         {
+            shared::inbound::Device device;
+
+            common::message::lookup::process::Reply message;
+            EXPECT_FALSE( ( device.receive( message, shared::policy::non::Blocking{})));
+         }
+
+         TEST( casual_common_communication_shared, send_receive__small_message)
+         {
+            shared::inbound::Device destination;
+            shared::outbound::Device source{ destination.connector().id()};
+
+            common::message::lookup::process::Reply message;
+            message.domain = "charlie";
+            auto correlation = shared::non::blocking::send( source, message);
+
+            common::message::lookup::process::Reply reply;
+            EXPECT_TRUE( ( shared::non::blocking::receive( destination, reply, correlation)));
+            EXPECT_TRUE( reply.domain == "charlie");
+         }
+
+         TEST( casual_common_communication_shared, non_blocking_send__full_ring__expect_false)
+         {
+            shared::inbound::Device destination{ std::size_t{ 2}};
+            shared::outbound::Device source{ destination.connector().id()};
+
+            common::message::lookup::process::Reply message;
+
+            EXPECT_TRUE( static_cast< bool>( shared::non::blocking::send( source, message)));
+            EXPECT_TRUE( static_cast< bool>( shared::non::blocking::send( source, message)));
+            EXPECT_FALSE( static_cast< bool>( shared::non::blocking::send( source, message)));
+
+            common::message::lookup::process::Reply reply;
+            EXPECT_TRUE( ( shared::non::blocking::receive( destination, reply)));
+
+            EXPECT_TRUE( static_cast< bool>( shared::non::blocking::send( source, message)));
+         }
+
+         TEST( casual_common_communication_shared, blocking_send_receive__large_message__small_ring)
+         {
+            shared::inbound::Device destination{ std::size_t{ 2}};
+
+            common::message::service::call::callee::Request message;
+            message.buffer.memory = local::payload::get();
+            while( message.buffer.memory.size() < 100 * shared::message::Transport::payload_max_size)
+            {
+               range::copy( local::payload::get(), std::back_inserter( message.buffer.memory));
+            }
+
+            auto id = destination.connector().id();
+
+            //
+            // The message is bigger than the ring, so the sender has to block until we consume
+            //
+            Uuid correlation;
+            std::thread sender{ [&](){
+               shared::outbound::Device source{ id};
+               correlation = shared::blocking::send( source, message);
+            }};
+
+            common::message::service::call::callee::Request reply;
+            shared::blocking::receive( destination, reply);
+            sender.join();
+
+            EXPECT_TRUE( static_cast< bool>( correlation));
+            EXPECT_TRUE( reply.buffer.memory == message.buffer.memory);
+         }
+
+         namespace local
+         {
+            namespace
+            {
+               struct Threshold
+               {
+                  Threshold( std::size_t size) : m_origin{ message::segment::threshold()} { message::segment::threshold( size);}
+                  ~Threshold() { message::segment::threshold( m_origin);}
+               private:
+                  std::size_t m_origin;
+               };
+
+               common::message::service::call::callee::Request large()
+               {
+                  common::message::service::call::callee::Request message;
+                  while( message.buffer.memory.size() < 10 * ipc::message::Transport::payload_max_size)
+                  {
+                     range::copy( local::payload::get(), std::back_inserter( message.buffer.memory));
+                  }
+                  return message;
+               }
+
+               bool segment( platform::queue_id_type owner)
+               {
+                  auto owners = message::segment::owners();
+                  return ! range::find( owners, owner).empty();
+               }
+            } // <unnamed>
+         } // local
+
+         TEST( casual_common_communication_segment, transport_descriptor)
+         {
+            message::segment::Descriptor descriptor;
+            uuid::make().copy( descriptor.id);
+            descriptor.size = 42;
+
+            ipc::message::Transport transport;
+            EXPECT_FALSE( transport.segment());
+
+            transport.segment( descriptor);
+            EXPECT_TRUE( transport.segment());
+            EXPECT_TRUE( transport.last());
+            EXPECT_TRUE( transport.message.header.complete_size == 42);
+            EXPECT_TRUE( Uuid( transport.descriptor().id) == Uuid( descriptor.id));
+         }
+
+         TEST( casual_common_communication_segment, ipc_send_receive__large_message)
+         {
+            local::Threshold threshold{ 1024};
+
+            ipc::inbound::Device destination;
+
+            auto message = local::large();
+            auto correlation = ipc::non::blocking::send( destination.connector().id(), message);
+            EXPECT_TRUE( static_cast< bool>( correlation));
+
+            common::message::service::call::callee::Request reply;
+            EXPECT_TRUE( ( ipc::non::blocking::receive( destination, reply, correlation)));
+            EXPECT_TRUE( reply.buffer.memory == message.buffer.memory);
+         }
+
+         TEST( casual_common_communication_segment, shared_send_receive__large_message)
+         {
+            local::Threshold threshold{ 1024};
+
+            shared::inbound::Device destination{ std::size_t{ 2}};
+            shared::outbound::Device source{ destination.connector().id()};
+
+            auto message = local::large();
+            auto correlation = shared::non::blocking::send( source, message);
+            EXPECT_TRUE( static_cast< bool>( correlation));
+
+            common::message::service::call::callee::Request reply;
+            EXPECT_TRUE( ( shared::non::blocking::receive( destination, reply, correlation)));
+            EXPECT_TRUE( reply.buffer.memory == message.buffer.memory);
+         }
+
+         TEST( casual_common_communication_ipc, send_receive__large_message__no_segment)
+         {
+            local::Threshold threshold{ 0};
+
+            ipc::inbound::Device destination;
+
+            auto message = local::large();
+
+            //
+            // The message is bigger than the ipc-queue, so the sender has to block until we consume
+            //
+            Uuid correlation;
+            std::thread sender{ [&](){
+               correlation = ipc::blocking::send( destination.connector().id(), message);
+            }};
+
+            common::message::service::call::callee::Request reply;
+            ipc::blocking::receive( destination, reply);
+            sender.join();
+
+            EXPECT_TRUE( static_cast< bool>( correlation));
+            EXPECT_TRUE( reply.buffer.memory == message.buffer.memory);
+         }
+
+         TEST( casual_common_communication_segment, send__discard__expect_no_message)
+         {
+            local::Threshold threshold{ 1024};
+
+            ipc::inbound::Device destination;
+
+            auto correlation = ipc::non::blocking::send( destination.connector().id(), local::large());
+            destination.discard( correlation);
+
+            common::message::service::call::callee::Request reply;
+            EXPECT_FALSE( ( ipc::non::blocking::receive( destination, reply)));
+         }
+
+         TEST( casual_common_communication_segment, send__remove_destination__expect_segment_removed)
+         {
+            local::Threshold threshold{ 1024};
+
+            platform::queue_id_type id;
+            {
+               ipc::inbound::Device destination;
+               id = destination.connector().id();
+
+               ipc::non::blocking::send( id, local::large());
+               EXPECT_TRUE( local::segment( id));
+            }
+
+            EXPECT_FALSE( local::segment( id));
+         }
+
+         TEST( casual_common_communication_segment, create__owner_gone__clear__expect_segment_removed)
+         {
+            //
+            // Same as domain startup, the owner has died before its queue was removed
+            //
+            auto descriptor = message::segment::create( platform::binary_type( 100), 424242);
+            EXPECT_TRUE( local::segment( descriptor.owner));
+
+            message::segment::clear( descriptor.owner);
+            EXPECT_FALSE( local::segment( descriptor.owner));
+         }
+
+         TEST( casual_common_communication_cache, add_reverse_ordered__expect_complete_and_out_of_order)
+         {
+            inbound::Cache cache;
+
+            auto parts = local::payload::parts( 100, common::message::Type::traffic_event);
+            range::reverse( parts);
+
+            for( auto& transport : parts)
+            {
+               cache.add( transport);
+            }
+
+            EXPECT_TRUE( cache.size() == 1);
+            EXPECT_TRUE( cache.statistics().transports == parts.size());
+            EXPECT_TRUE( cache.statistics().out_of_order == parts.size());
+
+            auto complete = cache.extract( common::message::Type::traffic_event);
+            EXPECT_TRUE( static_cast< bool>( complete));
+            EXPECT_TRUE( complete.payload == local::payload::get());
+            EXPECT_TRUE( cache.empty());
+         }
+
+         TEST( casual_common_communication_cache, add_ordered__expect_no_out_of_order)
+         {
+            inbound::Cache cache;
+
+            auto parts = local::payload::parts( 100, common::message::Type::traffic_event);
+
+            for( auto& transport : parts)
+            {
+               cache.add( transport);
+            }
+            EXPECT_TRUE( cache.statistics().out_of_order == 0);
+            EXPECT_TRUE( static_cast< bool>( cache.extract()));
+         }
+
+         TEST( casual_common_communication_cache, extract__incomplete__expect_absent)
+         {
+            inbound::Cache cache;
+
+            auto parts = local::payload::parts( 100, common::message::Type::traffic_event);
+            cache.add( parts.front());
+
+            EXPECT_FALSE( static_cast< bool>( cache.extract()));
+            EXPECT_FALSE( static_cast< bool>( cache.extract( common::message::Type::traffic_event)));
+            EXPECT_FALSE( static_cast< bool>( cache.extract( Uuid{ parts.front().message.header.correlation})));
+            EXPECT_TRUE( cache.find( Uuid{ parts.front().message.header.correlation}) != nullptr);
+
+            cache.erase( Uuid{ parts.front().message.header.correlation});
+            EXPECT_TRUE( cache.empty());
+         }
+
+         TEST( casual_common_communication_cache, extract_types__expect_arrival_order)
+         {
+            inbound::Cache cache;
+
+            auto first = uuid::make();
+            auto second = uuid::make();
+
+            cache.push( message::Complete{ common::message::Type::traffic_event, first});
+            cache.push( message::Complete{ common::message::Type::lookup_process_reply, second});
+
+            EXPECT_TRUE( cache.extract( { common::message::Type::lookup_process_reply, common::message::Type::traffic_event}).correlation == first);
+            EXPECT_TRUE( cache.extract( { common::message::Type::lookup_process_reply, common::message::Type::traffic_event}).correlation == second);
+            EXPECT_TRUE( cache.empty());
+            EXPECT_TRUE( cache.statistics().high == 2);
+         }
+
+         TEST( casual_common_communication_cache, same_correlation_twice__extract_type__expect_other_still_found)
+         {
+            inbound::Cache cache;
+
+            auto correlation = uuid::make();
+
+            cache.push( message::Complete{ common::message::Type::traffic_event, correlation});
+            cache.push( message::Complete{ common::message::Type::lookup_process_reply, correlation});
+
+            EXPECT_TRUE( cache.extract( common::message::Type::traffic_event).type == common::message::Type::traffic_event);
+
+            ASSERT_TRUE( cache.find( correlation) != nullptr);
+            EXPECT_TRUE( cache.extract( correlation).type == common::message::Type::lookup_process_reply);
+            EXPECT_TRUE( cache.empty());
+         }
+
+         TEST( casual_common_communication_cache, same_correlation_twice__erase__expect_empty)
+         {
+            inbound::Cache cache;
+
+            auto correlation = uuid::make();
+
+            cache.push( message::Complete{ common::message::Type::traffic_event, correlation});
+            cache.push( message::Complete{ common::message::Type::traffic_event, correlation});
+            EXPECT_TRUE( cache.size() == 2);
+
+            cache.erase( correlation);
+            EXPECT_TRUE( cache.empty());
+            EXPECT_TRUE( cache.find( correlation) == nullptr);
+         }
+
+         TEST( casual_common_communication_ipc, descriptor__send__expect_readable__receive__expect_not_readable)
+         {
+            ipc::inbound::Device destination;
+
+            auto descriptor = destination.connector().descriptor();
+
+            struct pollfd readable{ descriptor, POLLIN, 0};
+            EXPECT_TRUE( poll( &readable, 1, 0) == 0);
+
+            common::message::lookup::process::Reply message;
+            message.domain = "charlie";
+            auto correlation = ipc::non::blocking::send( destination.connector().id(), message);
+
+            EXPECT_TRUE( poll( &readable, 1, 5000) == 1);
+
+            common::message::lookup::process::Reply reply;
+            ipc::blocking::receive( destination, reply, correlation);
+            EXPECT_TRUE( reply.domain == "charlie");
+
+            EXPECT_TRUE( poll( &readable, 1, 0) == 0);
+            EXPECT_FALSE( ( ipc::non::blocking::receive( destination, reply)));
+         }
+
+         TEST( casual_common_communication_ipc, descriptor__send_2__receive_second__expect_not_readable_for_cached_first__send_3__expect_readable)
+         {
+            ipc::inbound::Device destination;
+
+            auto descriptor = destination.connector().descriptor();
+            struct pollfd readable{ descriptor, POLLIN, 0};
+
+            common::message::lookup::process::Reply message;
+            message.domain = "first";
+            auto first = ipc::non::blocking::send( destination.connector().id(), message);
+            message.domain = "second";
+            auto second = ipc::non::blocking::send( destination.connector().id(), message);
+
+            common::message::lookup::process::Reply reply;
+            ipc::blocking::receive( destination, reply, second);
+            EXPECT_TRUE( reply.domain == "second");
+
+            //
+            // first is cached in the device, nothing new has arrived
+            //
+            EXPECT_TRUE( poll( &readable, 1, 0) == 0);
+
+            EXPECT_TRUE( ( ipc::non::blocking::receive( destination, reply, first)));
+            EXPECT_TRUE( reply.domain == "first");
+
+            message.domain = "third";
+            auto third = ipc::non::blocking::send( destination.connector().id(), message);
+
+            EXPECT_TRUE( poll( &readable, 1, 5000) == 1);
+            EXPECT_TRUE( ( ipc::non::blocking::receive( destination, reply, third)));
+            EXPECT_TRUE( reply.domain == "third");
+
+            EXPECT_TRUE( poll( &readable, 1, 0) == 0);
+         }
+
       } // communication
 
    } // common
@@ -10,6 +10,8 @@
 #include "common/marshal/binary.h"
 #include "common/marshal/network.h"
 
+#include "common/communication/ipc.h"
+
 #include "common/message/service.h"
 #include "common/message/queue.h"
 
@@ -18,6 +20,8 @@
 
 #include "common/platform.h"
 
+#include <chrono>
+
 namespace casual
 {
    namespace common
@@ -254,6 +258,66 @@ namespace casual
 
          }
 
+         namespace local
+         {
+            namespace
+            {
+               template< typename I, typename O, typename T>
+               void range( const std::vector< T>& source)
+               {
+                  platform::binary_type buffer;
+
+                  auto output = O{}( buffer);
+                  output << source;
+
+                  using policy_type = typename decltype( output)::policy_type;
+                  EXPECT_TRUE( binary::size< policy_type>( source) == buffer.size());
+
+                  std::vector< T> target;
+                  auto input = I{}( buffer);
+                  input >> target;
+
+                  EXPECT_TRUE( source == target);
+               }
+            } // <unnamed>
+         } // local
+
+         TYPED_TEST( casual_common_marshal, vector_range__expect_same_in_and_out)
+         {
+            using input_type = typename TestFixture::input_type;
+            using output_type = typename TestFixture::output_type;
+
+            local::range< input_type, output_type>( std::vector< long>{ 1, -2, 300, 1L << 40});
+            local::range< input_type, output_type>( std::vector< int>{ 1, -2, 300, 70000});
+            local::range< input_type, output_type>( std::vector< short>{ 1, -2, 300});
+            local::range< input_type, output_type>( std::vector< char>{ 'a', 'b'});
+            local::range< input_type, output_type>( std::vector< double>{ 1.5, -2.25});
+            local::range< input_type, output_type>( std::vector< std::size_t>{ 1, 2, 3});
+            local::range< input_type, output_type>( std::vector< long>{});
+         }
+
+         TYPED_TEST( casual_common_marshal, vector_range__followed_by_value__expect_offset_maintained)
+         {
+            using input_type = typename TestFixture::input_type;
+            using output_type = typename TestFixture::output_type;
+
+            platform::binary_type buffer;
+
+            std::vector< int> pids{ 10, 20, 30};
+            std::string name{ "casual"};
+
+            auto output = output_type{}( buffer);
+            output << pids << name;
+
+            std::vector< int> pids_target;
+            std::string name_target;
+            auto input = input_type{}( buffer);
+            input >> pids_target >> name_target;
+
+            EXPECT_TRUE( pids == pids_target);
+            EXPECT_TRUE( name == name_target);
+         }
+
          TYPED_TEST( casual_common_marshal, enqueue_request)
          {
             using input_type = typename TestFixture::input_type;
@@ -280,10 +344,242 @@ namespace casual
             EXPECT_TRUE( source.message.payload == target.message.payload);
 
          }
-      }
 
-   }
-}
+         namespace local
+         {
+            namespace
+            {
+               message::service::Advertise advertise()
+               {
+                  message::service::Advertise message;
+                  message.execution = uuid::make();
+                  message.serverPath = "/some/path/to/server";
+                  message.process = process::handle();
+
+                  for( auto index = 0; index < 100; ++index)
+                  {
+                     message.services.emplace_back( "service_" + std::to_string( index), 1, 2);
+                  }
+                  return message;
+               }
+
+               message::service::call::callee::Request call( platform::binary_size_type size)
+               {
+                  message::service::call::callee::Request message;
+                  message.service.name = "some_service";
+                  message.parent = "parent";
+                  message.buffer = buffer::Payload{ buffer::Type{ "X_OCTET", "binary"}, size};
+                  return message;
+               }
+
+               message::queue::enqueue::Request enqueue( platform::binary_size_type size)
+               {
+                  message::queue::enqueue::Request message;
+                  message.process = process::handle();
+                  message.trid = transaction::ID::create();
+                  message.message.payload.resize( size);
+                  return message;
+               }
+
+               template< typename O, typename M>
+               std::size_t marshaled( const M& message)
+               {
+                  platform::binary_type buffer;
+                  auto output = O{}( buffer);
+                  output << message;
+                  return buffer.size();
+               }
+
+               template< typename O, typename M>
+               std::size_t sized( const M& message)
+               {
+                  platform::binary_type buffer;
+                  using policy_type = typename decltype( O{}( buffer))::policy_type;
+                  return binary::size< policy_type>( message);
+               }
+
+            } // <unnamed>
+         } // local
+
+         TYPED_TEST( casual_common_marshal, sizer__expect_same_size_as_output)
+         {
+            using output_type = typename TestFixture::output_type;
+
+            {
+               auto message = local::advertise();
+               EXPECT_TRUE( local::sized< output_type>( message) == local::marshaled< output_type>( message));
+            }
 
+            {
+               auto message = local::call( 1000);
+               EXPECT_TRUE( local::sized< output_type>( message) == local::marshaled< output_type>( message));
+            }
 
+            {
+               auto message = local::enqueue( 1000);
+               EXPECT_TRUE( local::sized< output_type>( message) == local::marshaled< output_type>( message));
+            }
 
+            {
+               transaction::ID trid;
+               EXPECT_TRUE( local::sized< output_type>( trid) == local::marshaled< output_type>( trid));
+            }
+         }
+
+         TYPED_TEST( casual_common_marshal, transport_output__expect_same_bytes_as_output)
+         {
+            using output_type = typename TestFixture::output_type;
+            using transport_type = communication::ipc::message::Transport;
+
+            platform::binary_type expected;
+            auto message = local::call( 3 * transport_type::payload_max_size + 42);
+            {
+               auto output = output_type{}( expected);
+               output << message;
+            }
+
+            using policy_type = typename decltype( output_type{}( expected))::policy_type;
+
+            transport_type transport;
+            transport.message.header.complete_size = binary::size< policy_type>( message);
+
+            platform::binary_type result;
+            std::vector< bool> last;
+
+            auto output = binary::transport::output< policy_type>( transport, [&]( const transport_type& transport){
+               EXPECT_TRUE( transport.message.header.offset == result.size());
+               range::copy( transport.payload(), std::back_inserter( result));
+               last.push_back( transport.last());
+               return true;
+            });
+
+            output << message;
+            EXPECT_TRUE( output.flush());
+
+            EXPECT_TRUE( result == expected);
+            ASSERT_TRUE( last.size() == 4);
+            EXPECT_TRUE( last == std::vector< bool>( { false, false, false, true}));
+         }
+
+         TEST( casual_common_marshal, transport_output__sender_fails__expect_rest_discarded)
+         {
+            using transport_type = communication::ipc::message::Transport;
+
+            auto message = local::call( 3 * transport_type::payload_max_size);
+
+            transport_type transport;
+            auto count = 0;
+
+            auto output = binary::transport::output< binary::Policy>( transport, [&]( const transport_type&){
+               return ++count < 2;
+            });
+
+            output << message;
+            EXPECT_FALSE( output.flush());
+            EXPECT_TRUE( count == 2);
+         }
+
+         TEST( casual_common_marshal_complete, payload__expect_exact_capacity)
+         {
+            auto message = local::call( 100000);
+            auto complete = marshal::complete( message);
+
+            EXPECT_TRUE( complete.payload.size() == complete.payload.capacity()) << "size: " << complete.payload.size() << " capacity: " << complete.payload.capacity();
+
+            message::service::call::callee::Request target;
+            complete >> target;
+            EXPECT_TRUE( target.buffer.memory.size() == 100000);
+         }
+
+         namespace local
+         {
+            namespace
+            {
+               template< typename M>
+               void compare( const M& message)
+               {
+                  //
+                  // marshal::complete sets the execution if absent, so it goes first
+                  //
+                  auto exact = marshal::complete( message);
+
+                  //
+                  // Same as marshal::complete, but let the output grow the payload
+                  //
+                  communication::message::Complete grow( message.type(), uuid::make());
+                  {
+                     binary::Output output{ grow.payload};
+                     output << message;
+                  }
+
+                  EXPECT_TRUE( exact.payload == grow.payload);
+               }
+
+               //!
+               //! @return best time in nanoseconds of @p count invocations of @p functor
+               //!
+               template< typename F>
+               long measure( std::size_t count, F&& functor)
+               {
+                  auto best = std::chrono::steady_clock::duration::max();
+
+                  for( auto round = 0; round < 5; ++round)
+                  {
+                     auto start = std::chrono::steady_clock::now();
+
+                     for( std::size_t index = 0; index < count; ++index)
+                     {
+                        functor();
+                     }
+
+                     best = std::min( best, std::chrono::steady_clock::now() - start);
+                  }
+                  return std::chrono::duration_cast< std::chrono::nanoseconds>( best).count() / count;
+               }
+
+               //!
+               //! Records the time to marshal @p message with exact reservation and by letting the output grow
+               //!
+               template< typename M>
+               void benchmark( const std::string& name, const M& message)
+               {
+                  auto grow = measure( 200, [&](){
+                     communication::message::Complete complete( message.type(), uuid::make());
+                     binary::Output output{ complete.payload};
+                     output << message;
+                  });
+
+                  auto exact = measure( 200, [&](){
+                     marshal::complete( message);
+                  });
+
+                  ::testing::Test::RecordProperty( name + "_grow_ns", grow);
+                  ::testing::Test::RecordProperty( name + "_exact_ns", exact);
+               }
+
+            } // <unnamed>
+         } // local
+
+         TEST( casual_common_marshal_complete, exact__expect_same_payload_as_grow)
+         {
+            local::compare( local::advertise());
+            local::compare( local::call( 1024 * 1024));
+            local::compare( local::enqueue( 1024 * 1024));
+         }
+
+
+         //
+         // Benchmark, run with --gtest_also_run_disabled_tests. The timings are recorded
+         // as properties of the test, see --gtest_output=xml
+         //
+         TEST( casual_common_marshal_complete, DISABLED_benchmark__exact_vs_grow)
+         {
+            local::benchmark( "service_advertise", local::advertise());
+            local::benchmark( "service_call", local::call( 1024 * 1024));
+            local::benchmark( "queue_enqueue", local::enqueue( 1024 * 1024));
+         }
+
+      }
+
+   }
+}
@@ -13,6 +13,8 @@
 #include "common/network/byteorder.h"
 
 #include <typeinfo>
+#include <vector>
+#include <cstring>
 
 
 namespace casual
@@ -131,7 +133,49 @@ namespace casual
             }
          }
 
-
+         namespace local
+         {
+            namespace
+            {
+               template< typename T>
+               void range_encode_decode( const std::vector< T>& initial)
+               {
+                  std::vector< char> encoded( initial.size() * byteorder::bytes< T>());
+
+                  //
+                  // + 1 to make sure we can handle unaligned memory
+                  //
+                  std::vector< char> unaligned( encoded.size() + 1);
+                  byteorder::encode( initial.data(), initial.size(), unaligned.data() + 1);
+
+                  auto out = encoded.data();
+                  for( auto& value : initial)
+                  {
+                     const auto single = byteorder::encode( value);
+                     std::memcpy( out, &single, sizeof( single));
+                     out += sizeof( single);
+                  }
+
+                  EXPECT_TRUE( std::equal( std::begin( encoded), std::end( encoded), std::begin( unaligned) + 1));
+
+                  std::vector< T> decoded( initial.size());
+                  byteorder::decode( unaligned.data() + 1, decoded.size(), decoded.data());
+                  EXPECT_TRUE( decoded == initial);
+               }
+            } // <unnamed>
+         } // local
+
+         TEST( casual_common, network_byteorder__range_encode_decode__expect_same_as_single)
+         {
+            local::range_encode_decode( std::vector< char>{ 'a', 'b', 'c'});
+            local::range_encode_decode( std::vector< short>{ 1, -2, 300, 32000, -32000});
+            local::range_encode_decode( std::vector< int>{ 1, -2, 300, 70000, -70000});
+            local::range_encode_decode( std::vector< long>{ 1, -2, 300, 70000, -70000, 1L << 40, -( 1L << 40)});
+            local::range_encode_decode( std::vector< unsigned long>{ 1, 2, 300, 70000, 1UL << 63});
+            local::range_encode_decode( std::vector< float>{ 1.5, -2.25, 300.125});
+            local::range_encode_decode( std::vector< double>{ 1.5, -2.25, 300.125, 1e100});
+            local::range_encode_decode( std::vector< long>{});
+         }
 
       }
    }
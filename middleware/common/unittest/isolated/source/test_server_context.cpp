@@ -215,6 +215,40 @@ namespace casual
 
 
 
+      TEST( casual_common_server_context, call_service_reserved__expect_broker_ack)
+      {
+         common::Trace trace{ "TEST casual_common_server_context.call_service_reserved__expect_broker_ack", log::internal::debug};
+
+         mockup::ipc::clear();
+         mockup::ipc::Instance caller{ 42};
+
+         auto prepare_caller = [](){
+
+            mockup::domain::Broker broker;
+            return server::handle::Call{ local::arguments()};
+         };
+
+         {
+            auto callHandler = prepare_caller();
+            auto message = local::callMessage( caller.id());
+            message.reserved = true;
+            callHandler( message);
+         }
+
+         message::service::call::Reply reply;
+         communication::ipc::blocking::receive( caller.output(), reply);
+
+         //
+         // broker needs the ACK to take us back, if the caller never releases the reservation
+         //
+         message::service::call::ACK message;
+         communication::ipc::blocking::receive( mockup::ipc::broker::queue().output(), message);
+
+         EXPECT_TRUE( message.service == "test_service");
+         EXPECT_TRUE( message.process.queue == communication::ipc::inbound::id());
+      }
+
+
       TEST( casual_common_server_context, call_service__gives_traffic_notify)
       {
          mockup::ipc::clear();
@@ -87,12 +87,18 @@ namespace casual
             std::string note;
             std::string transaction;
 
+            //!
+            //! how to choose among idle instances: round-robin, lru or least-invoked
+            //!
+            std::string routing;
+
             CASUAL_CONST_CORRECT_SERIALIZE
             (
                archive & CASUAL_MAKE_NVP( name);
                archive & CASUAL_MAKE_NVP( timeout);
                archive & CASUAL_MAKE_NVP( note);
                archive & CASUAL_MAKE_NVP( transaction);
+               archive & CASUAL_MAKE_NVP( routing);
             )
          };
 
@@ -138,6 +144,7 @@ namespace casual
             {
                server.instances = std::to_string( 1);
                service.timeout = "1h";
+               service.routing = "round-robin";
             }
 
             Environment environment;
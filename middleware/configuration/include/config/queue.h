@@ -27,21 +27,77 @@ namespace casual
             std::string name;
             std::string retries;
 
+            //!
+            //! persistent (default) | volatile - messages are held in memory and lost if the group goes down
+            //!
+            std::string storage;
+
             template< typename A>
             void serialize( A& archive)
             {
                archive & CASUAL_MAKE_NVP( name);
                archive & CASUAL_MAKE_NVP( retries);
+               archive & CASUAL_MAKE_NVP( storage);
             }
 
             friend bool operator < ( const Queue& lhs, const Queue& rhs);
             friend bool operator == ( const Queue& lhs, const Queue& rhs);
          };
 
+         //!
+         //! How hard a group works to persist each write transaction. Empty values
+         //! gets the domain default, and then the queuebase default.
+         //!
+         struct Durability
+         {
+            //!
+            //! rollback | wal
+            //!
+            std::string journal;
+
+            //!
+            //! full | normal | off
+            //!
+            std::string synchronous;
+
+            //!
+            //! page cache size in KiB
+            //!
+            std::string cache;
+
+            //!
+            //! wal only - number of write transactions between the checkpoints the group does,
+            //! otherwise sqlite checkpoints automatically
+            //!
+            std::string checkpoint;
+
+            //!
+            //! max number of persistent replies per write transaction
+            //!
+            std::string batch;
+
+            //!
+            //! payloads larger than this (bytes) is stored in segment files beside the queuebase
+            //!
+            std::string blob;
+
+            template< typename A>
+            void serialize( A& archive)
+            {
+               archive & CASUAL_MAKE_NVP( journal);
+               archive & CASUAL_MAKE_NVP( synchronous);
+               archive & CASUAL_MAKE_NVP( cache);
+               archive & CASUAL_MAKE_NVP( checkpoint);
+               archive & CASUAL_MAKE_NVP( batch);
+               archive & CASUAL_MAKE_NVP( blob);
+            }
+         };
+
          struct Group
          {
             std::string name;
             std::string queuebase;
+            Durability durability;
             std::vector< Queue> queues;
 
             template< typename A>
@@ -49,6 +105,7 @@ namespace casual
             {
                archive & CASUAL_MAKE_NVP( name);
                archive & CASUAL_MAKE_NVP( queuebase);
+               archive & CASUAL_MAKE_NVP( durability);
                archive & CASUAL_MAKE_NVP( queues);
             }
 
@@ -60,11 +117,13 @@ namespace casual
          struct Default
          {
             Queue queue;
+            Durability durability;
 
             template< typename A>
             void serialize( A& archive)
             {
                archive & CASUAL_MAKE_NVP( queue);
+               archive & CASUAL_MAKE_NVP( durability);
             }
          };
 
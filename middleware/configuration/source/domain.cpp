@@ -50,6 +50,7 @@ namespace casual
                      {
                         assign_if_empty( service.timeout, m_casual_default.service.timeout);
                         assign_if_empty( service.transaction, m_casual_default.service.transaction);
+                        assign_if_empty( service.routing, m_casual_default.service.routing);
                      }
 
                      void operator ()( domain::Domain& configuration) const
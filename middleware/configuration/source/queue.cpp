@@ -52,16 +52,35 @@ namespace casual
             namespace
             {
 
+               void default_value( std::string& value, const std::string& casual_default)
+               {
+                  if( value.empty())
+                  {
+                     value = casual_default;
+                  }
+               }
+
                void default_values( Domain& domain)
                {
                   for( auto& group : domain.groups)
                   {
+                     auto& durability = domain.casual_default.durability;
+
+                     default_value( group.durability.journal, durability.journal);
+                     default_value( group.durability.synchronous, durability.synchronous);
+                     default_value( group.durability.cache, durability.cache);
+                     default_value( group.durability.checkpoint, durability.checkpoint);
+                     default_value( group.durability.batch, durability.batch);
+                     default_value( group.durability.blob, durability.blob);
+
                      for( auto& queue : group.queues)
                      {
                         if( queue.retries.empty())
                         {
                            queue.retries = domain.casual_default.queue.retries;
                         }
+
+                        default_value( queue.storage, domain.casual_default.queue.storage);
                      }
                   }
                }
@@ -79,6 +98,43 @@ namespace casual
                      {
                         throw common::exception::invalid::Configuration{ "queue has to have numeric retry set", CASUAL_NIP( queue.retries)};
                      }
+
+                     if( ! queue.storage.empty() && queue.storage != "persistent" && queue.storage != "volatile")
+                     {
+                        throw common::exception::invalid::Configuration{ "queue storage has to be persistent or volatile", CASUAL_NIP( queue.storage)};
+                     }
+                  }
+
+                  void operator ()( const Durability& durability) const
+                  {
+                     auto one_of = []( const std::string& value, std::vector< std::string> valid){
+                        return value.empty() || common::range::find( valid, value);
+                     };
+
+                     if( ! one_of( durability.journal, { "rollback", "wal"}))
+                     {
+                        throw common::exception::invalid::Configuration{ "queue group journal has to be rollback or wal", CASUAL_NIP( durability.journal)};
+                     }
+
+                     if( ! one_of( durability.synchronous, { "full", "normal", "off"}))
+                     {
+                        throw common::exception::invalid::Configuration{ "queue group synchronous has to be full, normal or off", CASUAL_NIP( durability.synchronous)};
+                     }
+
+                     auto numeric = []( const std::string& value){
+                        return value.empty() || common::string::integer( value);
+                     };
+
+                     if( ! numeric( durability.cache) || ! numeric( durability.checkpoint) || ! numeric( durability.batch) || ! numeric( durability.blob))
+                     {
+                        throw common::exception::invalid::Configuration{ "queue group cache, checkpoint, batch and blob has to be numeric",
+                           CASUAL_NIP( durability.cache), CASUAL_NIP( durability.checkpoint), CASUAL_NIP( durability.batch), CASUAL_NIP( durability.blob)};
+                     }
+
+                     if( ! durability.checkpoint.empty() && durability.journal != "wal")
+                     {
+                        throw common::exception::invalid::Configuration{ "queue group checkpoint requires journal wal", CASUAL_NIP( durability.checkpoint)};
+                     }
                   }
 
                   void operator ()( const Group& group) const
@@ -92,6 +148,7 @@ namespace casual
                      {
                         throw common::exception::invalid::Configuration{ "queue group has to have a queuebase path"};
                      }
+                     (*this)( group.durability);
                      common::range::for_each( group.queues, *this);
                   }
                };
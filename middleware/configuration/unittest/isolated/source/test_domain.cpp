@@ -89,5 +89,14 @@ namespace casual
 
    }
 
+   TEST_P( casual_configuration_domain, read_service_routing)
+   {
+      auto domain = config::domain::get( local::get_testfile_path( GetParam()));
+
+      ASSERT_TRUE( domain.services.size() == 1) << "size: " << domain.services.size();
+      EXPECT_TRUE( domain.services.at( 0).routing == "least-invoked") << "routing: " << domain.services.at( 0).routing;
+      EXPECT_TRUE( domain.casual_default.service.routing == "round-robin");
+   }
+
 
 } // casual
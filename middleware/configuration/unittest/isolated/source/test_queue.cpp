@@ -52,6 +52,32 @@ namespace casual
       }
 
 
+      TEST( casual_configuration_queue, durability__group_one_expect_defaults__group_two_expect_wal)
+      {
+         auto queues = config::queue::get( local::get_testfile_path( "queue.yaml"));
+
+         auto& one = queues.groups.at( 0).durability;
+         EXPECT_TRUE( one.journal.empty()) << one.journal;
+         EXPECT_TRUE( one.synchronous == "full") << one.synchronous;
+
+         auto& two = queues.groups.at( 1).durability;
+         EXPECT_TRUE( two.journal == "wal") << two.journal;
+         EXPECT_TRUE( two.synchronous == "normal") << two.synchronous;
+         EXPECT_TRUE( two.cache == "8192") << two.cache;
+         EXPECT_TRUE( two.checkpoint == "10") << two.checkpoint;
+         EXPECT_TRUE( two.batch.empty()) << two.batch;
+      }
+
+      TEST( casual_configuration_queue, storage__expect_queueB4_volatile)
+      {
+         auto queues = config::queue::get( local::get_testfile_path( "queue.yaml"));
+
+         auto& group = queues.groups.at( 1);
+         ASSERT_TRUE( group.queues.size() == 4);
+         EXPECT_TRUE( group.queues.at( 0).storage.empty());
+         EXPECT_TRUE( group.queues.at( 3).storage == "volatile") << group.queues.at( 3).storage;
+      }
+
       TEST( casual_configuration_queue, validate__group_has_to_have_a_name)
       {
          queue::Domain domain;
@@ -133,6 +159,84 @@ namespace casual
       }
 
 
+      namespace local
+      {
+         namespace
+         {
+            queue::Domain durability( queue::Durability durability)
+            {
+               queue::Domain domain;
+               domain.groups.resize( 1);
+               domain.groups.at( 0).name = "A";
+               domain.groups.at( 0).queuebase = "X";
+               domain.groups.at( 0).durability = std::move( durability);
+               return domain;
+            }
+         } // <unnamed>
+      } // local
+
+      TEST( casual_configuration_queue, validate__durability_unknown_journal__expect_throw)
+      {
+         queue::Durability durability;
+         durability.journal = "memory";
+
+         EXPECT_THROW( { queue::unittest::validate( local::durability( durability));}, common::exception::invalid::Configuration);
+      }
+
+      TEST( casual_configuration_queue, validate__durability_non_numeric_cache__expect_throw)
+      {
+         queue::Durability durability;
+         durability.cache = "a lot";
+
+         EXPECT_THROW( { queue::unittest::validate( local::durability( durability));}, common::exception::invalid::Configuration);
+      }
+
+      TEST( casual_configuration_queue, validate__durability_non_numeric_blob__expect_throw)
+      {
+         queue::Durability durability;
+         durability.blob = "64k";
+
+         EXPECT_THROW( { queue::unittest::validate( local::durability( durability));}, common::exception::invalid::Configuration);
+      }
+
+      TEST( casual_configuration_queue, validate__durability_checkpoint_without_wal__expect_throw)
+      {
+         queue::Durability durability;
+         durability.checkpoint = "10";
+
+         EXPECT_THROW( { queue::unittest::validate( local::durability( durability));}, common::exception::invalid::Configuration);
+
+         durability.journal = "wal";
+         EXPECT_NO_THROW( { queue::unittest::validate( local::durability( durability));});
+      }
+
+      TEST( casual_configuration_queue, validate__queue_unknown_storage__expect_throw)
+      {
+         auto domain = local::durability( queue::Durability{});
+         domain.groups.at( 0).queues.resize( 1);
+         domain.groups.at( 0).queues.at( 0).name = "a";
+         domain.groups.at( 0).queues.at( 0).retries = "0";
+         domain.groups.at( 0).queues.at( 0).storage = "disc";
+
+         EXPECT_THROW( { queue::unittest::validate( domain);}, common::exception::invalid::Configuration);
+
+         domain.groups.at( 0).queues.at( 0).storage = "volatile";
+         EXPECT_NO_THROW( { queue::unittest::validate( domain);});
+      }
+
+      TEST( casual_configuration_queue, default_values__durability)
+      {
+         auto domain = local::durability( queue::Durability{});
+         domain.groups.at( 0).durability.synchronous = "off";
+         domain.casual_default.durability.journal = "wal";
+         domain.casual_default.durability.synchronous = "normal";
+
+         queue::unittest::default_values( domain);
+
+         EXPECT_TRUE( domain.groups.at( 0).durability.journal == "wal");
+         EXPECT_TRUE( domain.groups.at( 0).durability.synchronous == "off");
+      }
+
    } // config
 
 } // casual
@@ -36,11 +36,17 @@ namespace casual
          //!
          sf::platform::time_point available = sf::platform::time_point::min();
 
+         //!
+         //! Number of times the message has been rolled back, set on dequeue.
+         //!
+         std::size_t redelivered = 0;
+
          CASUAL_CONST_CORRECT_SERIALIZE(
          {
             archive & CASUAL_MAKE_NVP( properties);
             archive & CASUAL_MAKE_NVP( reply);
             archive & CASUAL_MAKE_NVP( available);
+            archive & CASUAL_MAKE_NVP( redelivered);
          })
 
       };
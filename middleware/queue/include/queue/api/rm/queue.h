@@ -25,6 +25,27 @@ namespace casual
          std::vector< Message> dequeue( const std::string& queue);
          std::vector< Message> dequeue( const std::string& queue, const Selector& selector);
 
+         namespace batch
+         {
+            //!
+            //! Enqueues all @p messages in one exchange with the queue-group, within the
+            //! same transaction.
+            //!
+            //! @return the ids of the messages, in the same order as @p messages
+            //! @throws common::exception::NotReallySureWhatToNameThisException if the group
+            //!   failed to enqueue the batch, none of the messages are enqueued
+            //!
+            std::vector< sf::platform::Uuid> enqueue( const std::string& queue, const std::vector< Message>& messages);
+
+            //!
+            //! Dequeues at most @p max messages, that matches @p selector, in one exchange with the queue-group.
+            //!
+            //! @return the dequeued messages, could be empty
+            //!
+            std::vector< Message> dequeue( const std::string& queue, const Selector& selector, std::size_t max);
+
+         } // batch
+
          // We dont't need async right now, and there are some problems to make sure the user fetch the reply
          // before commit. Pretty much the same problem as in tpacall, but it's somewhat complicated.
          /*
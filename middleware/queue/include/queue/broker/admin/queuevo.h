@@ -131,15 +131,48 @@ namespace casual
             };
 
 
+            struct Forward
+            {
+               sf::platform::pid_type pid;
+               std::string queue;
+
+               std::size_t forwarded;
+               std::size_t rolledback;
+               std::size_t errored;
+               std::size_t transactions;
+               std::size_t in_flight;
+               std::size_t high;
+
+               sf::platform::time_point start;
+               sf::platform::time_point timestamp;
+
+               CASUAL_CONST_CORRECT_SERIALIZE(
+               {
+                  archive & CASUAL_MAKE_NVP( pid);
+                  archive & CASUAL_MAKE_NVP( queue);
+                  archive & CASUAL_MAKE_NVP( forwarded);
+                  archive & CASUAL_MAKE_NVP( rolledback);
+                  archive & CASUAL_MAKE_NVP( errored);
+                  archive & CASUAL_MAKE_NVP( transactions);
+                  archive & CASUAL_MAKE_NVP( in_flight);
+                  archive & CASUAL_MAKE_NVP( high);
+                  archive & CASUAL_MAKE_NVP( start);
+                  archive & CASUAL_MAKE_NVP( timestamp);
+               })
+            };
+
+
             struct State
             {
                std::vector< Group> groups;
                std::vector< Queue> queues;
+               std::vector< Forward> forwards;
 
                CASUAL_CONST_CORRECT_SERIALIZE(
                {
                   archive & CASUAL_MAKE_NVP( groups);
                   archive & CASUAL_MAKE_NVP( queues);
+                  archive & CASUAL_MAKE_NVP( forwards);
                })
 
             };
@@ -113,6 +113,19 @@ namespace casual
 
             }
 
+            namespace forward
+            {
+               struct Statistics : Base
+               {
+                  using message_type = common::message::queue::forward::Statistics;
+
+                  using Base::Base;
+
+                  void operator () ( message_type& message);
+               };
+
+            } // forward
+
             namespace transaction
             {
                namespace commit
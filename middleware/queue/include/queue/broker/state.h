@@ -59,6 +59,11 @@ namespace casual
 
             std::map< common::transaction::ID, std::vector< Group::id_type>> involved;
 
+            //!
+            //! The latest statistics reported by each forwarder
+            //!
+            std::map< common::platform::pid_type, common::message::queue::forward::Statistics> forwards;
+
 
 
 
@@ -10,8 +10,10 @@
 
 
 #include "common/message/queue.h"
+#include "common/exception.h"
 
 #include <string>
+#include <unordered_map>
 
 namespace casual
 {
@@ -25,6 +27,63 @@ namespace casual
 
       };
 
+      namespace lookup
+      {
+         //!
+         //! Caches lookup replies in this process, so only the first enqueue/dequeue
+         //! to a queue needs a round-trip to the queue-broker.
+         //!
+         //! If the group is unavailable (it has been restarted and the queues might have
+         //! been removed) all entries for the group is invalidated.
+         //!
+         class Cache
+         {
+         public:
+            using reply_type = common::message::queue::lookup::Reply;
+
+            static Cache& instance();
+
+            //!
+            //! @return the cached reply for @p queue, or asks the queue-broker if absent.
+            //! Only found queues are cached
+            //!
+            reply_type get( const std::string& queue);
+
+            //!
+            //! Invokes @p function with the group of @p queue. If the group is unavailable
+            //! the group is invalidated and @p function is invoked once more with a fresh lookup
+            //!
+            template< typename F>
+            auto invoke( const std::string& queue, F&& function) -> decltype( function( std::declval< const reply_type&>()))
+            {
+               auto group = get( queue);
+
+               try
+               {
+                  return function( group);
+               }
+               catch( const common::exception::queue::Unavailable&)
+               {
+                  invalidate( group.process);
+                  return function( get( queue));
+               }
+            }
+
+            //!
+            //! Removes all entries that belongs to @p group
+            //!
+            void invalidate( const common::process::Handle& group);
+
+            void clear();
+
+         private:
+            Cache();
+
+            std::unordered_map< std::string, reply_type> m_replies;
+         };
+
+      } // lookup
+
    } // queue
 } // casual
 
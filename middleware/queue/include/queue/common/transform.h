@@ -32,6 +32,11 @@ namespace casual
 
          std::vector< broker::admin::Group> groups( const broker::State& state);
 
+         //!
+         //! The forwarders that has reported statistics, and is still running
+         //!
+         std::vector< broker::admin::Forward> forwards( const broker::State& state);
+
 
          struct Queue
          {
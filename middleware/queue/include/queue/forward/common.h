@@ -11,9 +11,13 @@
 #include "queue/api/message.h"
 
 #include "common/transaction/resource.h"
+#include "common/platform.h"
 
 
 #include <functional>
+#include <ostream>
+#include <vector>
+#include <limits>
 
 namespace casual
 {
@@ -21,7 +25,11 @@ namespace casual
    {
       namespace forward
       {
-         using dispatch_type = std::function< void( queue::Message&&)>;
+         //!
+         //! Forwards all messages, within the current transaction. Throws if any of them fails,
+         //! and the transaction, hence all the messages, are rolled back.
+         //!
+         using dispatch_type = std::function< void( std::vector< queue::Message>&&)>;
 
          struct Task
          {
@@ -33,16 +41,132 @@ namespace casual
             dispatch_type dispatch;
          };
 
+         struct Configuration
+         {
+            //!
+            //! max number of messages that is dequeued, and forwarded, per transaction.
+            //! 1 -> commit per message
+            //!
+            std::size_t batch = 1;
+
+            //!
+            //! max number of forwards in-flight at the same time, within the batch
+            //!
+            std::size_t concurrent = 1;
+
+            //!
+            //! seconds between the statistics is logged and reported to the queue-broker, 0 -> never
+            //!
+            std::size_t statistics = 0;
+         };
+
+         struct Statistics
+         {
+            //!
+            //! number of messages forwarded and committed
+            //!
+            std::size_t forwarded = 0;
+
+            //!
+            //! number of messages rolled back, and put back on the queue
+            //!
+            std::size_t rolledback = 0;
+
+            //!
+            //! number of messages rolled back, and moved to the error queue by the group,
+            //! since the retries of the queue is exceeded
+            //!
+            std::size_t errored = 0;
+
+            std::size_t transactions = 0;
+
+            //!
+            //! messages dequeued in the current transaction, and the most we've had
+            //!
+            std::size_t in_flight = 0;
+            std::size_t high = 0;
+
+            common::platform::time_point start = common::platform::clock_type::now();
+
+            friend std::ostream& operator << ( std::ostream& out, const Statistics& value);
+         };
+
+         //!
+         //! Decides how many messages each transaction takes and keeps the statistics.
+         //!
+         //! When a batch is rolled back, its messages are retried one per transaction, so
+         //! one failing message does not take the rest of the batch to the error queue
+         //!
+         class Policy
+         {
+         public:
+            Policy( const Configuration& configuration);
+
+            //!
+            //! @return the max number of messages to dequeue in the next transaction
+            //!
+            std::size_t batch() const;
+
+            //!
+            //! @return true if the messages are retried one per transaction
+            //!
+            bool isolated() const { return m_isolated > 0;}
+
+            void dequeued( std::size_t count);
+
+            void committed( std::size_t count);
+
+            //!
+            //! @param redelivered the redelivered count of each rolled back message, when it was dequeued
+            //! @param retries of the queue, the group moves the messages that exceeds it to the error queue
+            //!
+            void rolledback( const std::vector< std::size_t>& redelivered, std::size_t retries);
+
+            const Statistics& statistics() const { return m_statistics;}
+
+         private:
+            void transaction();
+
+            std::size_t m_batch;
+            std::size_t m_isolated = 0;
+            Statistics m_statistics;
+         };
+
          struct Dispatch
          {
-            Dispatch( std::vector< forward::Task> tasks);
-            Dispatch( std::vector< forward::Task> tasks, const std::vector< common::transaction::Resource>& resources);
+            Dispatch( std::vector< forward::Task> tasks, Configuration configuration = Configuration{});
+            Dispatch( std::vector< forward::Task> tasks, Configuration configuration, const std::vector< common::transaction::Resource>& resources);
 
             void execute();
 
+            const Statistics& statistics() const { return m_policy.statistics();}
+
          private:
 
+            bool perform();
+            void log();
+
+            //!
+            //! Sends the statistics to the queue-broker, if anything has changed since last time
+            //!
+            void report();
+
             std::vector< forward::Task> m_tasks;
+            Configuration m_configuration;
+            Policy m_policy;
+
+            //!
+            //! retries of the queue, we get it from the group when we start
+            //!
+            std::size_t m_retries = 0;
+
+            struct
+            {
+               common::platform::time_point time = common::platform::clock_type::now();
+               std::size_t forwarded = 0;
+            } m_logged;
+
+            std::size_t m_reported = std::numeric_limits< std::size_t>::max();
 
          };
 
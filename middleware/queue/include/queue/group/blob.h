@@ -0,0 +1,113 @@
+//!
+//! blob.h
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#ifndef CASUAL_QUEUE_GROUP_BLOB_H_
+#define CASUAL_QUEUE_GROUP_BLOB_H_
+
+#include "common/platform.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace casual
+{
+   namespace queue
+   {
+      namespace group
+      {
+         namespace blob
+         {
+            struct Settings
+            {
+               //!
+               //! payloads larger than threshold (bytes) are stored in the blob segments,
+               //! 0 -> all new payloads are stored inline, existing segments are still read
+               //!
+               std::size_t threshold = 0;
+
+               //!
+               //! size in bytes when a segment is considered full, and a new one is started
+               //!
+               std::size_t segment = 64 * 1024 * 1024;
+            };
+
+            struct Reference
+            {
+               std::size_t segment = 0;
+               std::size_t offset = 0;
+               std::size_t size = 0;
+
+               explicit operator bool() const { return segment != 0;}
+            };
+
+            //!
+            //! Append-only segment files beside the queuebase, `<queuebase>.blob.<n>`, that
+            //! are read via mmap.
+            //!
+            //! The store has no knowledge of which blobs are alive, that is kept (transactional)
+            //! in the queuebase, the store only appends, reads, and removes whole segments.
+            //!
+            class Store
+            {
+            public:
+               Store( const std::string& queuebase, Settings settings);
+               ~Store();
+
+               Store( const Store&) = delete;
+               Store& operator = ( const Store&) = delete;
+
+               //!
+               //! @return true if a payload of @p size should be stored in the store
+               //!
+               bool external( std::size_t size) const;
+
+               Reference write( const common::platform::binary_type& payload);
+
+               void read( const Reference& reference, common::platform::binary_type& payload);
+
+               //!
+               //! Makes all writes since last sync durable
+               //!
+               void sync();
+
+               //!
+               //! @return the segment writes goes to, 0 if nothing is written yet
+               //!
+               std::size_t active() const { return m_active;}
+
+               //!
+               //! @return all segments with their sizes
+               //!
+               std::map< std::size_t, std::size_t> segments() const;
+
+               //!
+               //! removes the segment file, the caller has to make sure there are no references left
+               //!
+               void remove( std::size_t segment);
+
+            private:
+               struct Segment;
+
+               std::string path( std::size_t segment) const;
+               Segment& segment( std::size_t segment);
+
+               std::string m_base;
+               Settings m_settings;
+               std::map< std::size_t, std::unique_ptr< Segment>> m_segments;
+               std::set< std::size_t> m_dirty;
+               std::size_t m_active = 0;
+            };
+
+         } // blob
+      } // group
+   } // queue
+} // casual
+
+#endif // CASUAL_QUEUE_GROUP_BLOB_H_
@@ -8,11 +8,16 @@
 #ifndef CASUALQUEUESERVERDATABASE_H_
 #define CASUALQUEUESERVERDATABASE_H_
 
+#include "queue/group/blob.h"
+
 #include "sql/database.h"
 
 
 #include "common/message/queue.h"
 
+#include <set>
+#include <unordered_map>
+
 namespace casual
 {
    namespace queue
@@ -29,14 +34,56 @@ namespace casual
                added = 1,
                enqueued = 2,
                removed = 3,
-               dequeued = 4
+               dequeued = 4,
+               //! the payload can't be read, moved to the error queue and never dequeued
+               broken = 5
             };
          } // message
 
+         //!
+         //! How hard the queuebase works to persist each write transaction
+         //!
+         struct Durability
+         {
+            enum class Journal
+            {
+               rollback,
+               wal,
+            };
+
+            enum class Synchronous
+            {
+               off,
+               normal,
+               full,
+            };
+
+            Journal journal = Journal::rollback;
+            Synchronous synchronous = Synchronous::full;
+
+            //!
+            //! page cache size in KiB, 0 -> sqlite default
+            //!
+            std::size_t cache = 0;
+
+            //!
+            //! wal only - number of write transactions between explicit checkpoints,
+            //! 0 -> sqlite checkpoints automatically
+            //!
+            std::size_t checkpoint = 0;
+
+            friend std::ostream& operator << ( std::ostream& out, const Durability& value);
+         };
+
          class Database
          {
          public:
-            Database( const std::string& database, std::string groupname);
+            Database( const std::string& database, std::string groupname, Durability durability = Durability{}, blob::Settings blob = blob::Settings{});
+
+            //!
+            //! flushes the counters, if needed
+            //!
+            ~Database();
 
             Queue create( Queue queue);
 
@@ -54,8 +101,34 @@ namespace casual
 
             common::message::queue::enqueue::Reply enqueue( const common::message::queue::enqueue::Request& message);
 
+            //!
+            //! Inserts all messages with the same (precompiled) statement
+            //!
+            //! All or nothing, if one insert fails the previous ones are rolled back
+            //! (to a savepoint) before the exception is propagated
+            //!
+            common::message::queue::enqueue::batch::Reply enqueue( const common::message::queue::enqueue::batch::Request& message);
+
+            //!
+            //! dequeues at most `message.count` messages
+            //!
+            //! All or nothing, if one fails the previous ones are rolled back
+            //! (to a savepoint) before the exception is propagated
+            //!
             common::message::queue::dequeue::Reply dequeue( const common::message::queue::dequeue::Request& message);
 
+            //!
+            //! Dequeues for @p requests, that are all without selector and for @p queue, with
+            //! one read of the oldest available messages. Each request gets at most its `count`.
+            //!
+            //! All or nothing, if one fails the previous ones are rolled back
+            //! (to a savepoint) before the exception is propagated
+            //!
+            //! @return replies in the same order as @p requests, fewer than requests if there
+            //!   were not enough messages
+            //!
+            std::vector< common::message::queue::dequeue::Reply> dequeue( Queue::id_type queue, const std::vector< common::message::queue::dequeue::Request>& requests);
+
 
             void commit( const common::transaction::ID& id);
             void rollback( const common::transaction::ID& id);
@@ -89,9 +162,69 @@ namespace casual
             void commit();
             void rollback();
 
+            //!
+            //! Transfers the wal content to the database, if it can be done without waiting
+            //! for readers. No-op if the journal is not wal.
+            //!
+            void checkpoint();
+
+            const Durability& durability() const { return m_durability;}
+
+            //!
+            //! Removes blob segments that no message refers to, and moves the live blobs
+            //! out of segments that are mostly garbage, so these can be removed as well.
+            //!
+            //! Has to be called outside a write transaction.
+            //!
+            void compact();
+
+            //!
+            //! Writes the count, size and uncommitted of the queues that have changed to the
+            //! queue table. These are kept in memory, and rebuilt from the messages at startup.
+            //!
+            //! Has to be called within a write transaction.
+            //!
+            void flush();
+
 
          private:
 
+            common::Uuid enqueue( const common::transaction::ID& trid, Queue::id_type queue, const common::message::queue::base_message& message);
+
+            //!
+            //! Reads the blob, if any, and marks the message at @p row as dequeued (in @p trid)
+            //!
+            //! @throws common::exception::invalid::File if the blob can't be read, nothing is updated
+            //!
+            void dequeued( Queue::id_type queue, std::int64_t row, const common::transaction::ID& trid, const blob::Reference& reference,
+                  common::message::queue::dequeue::Reply::Message& message);
+
+            //!
+            //! Moves the message at @p row, which blob can't be read, to the error queue of @p queue
+            //! as message::State::broken
+            //!
+            void broken( Queue::id_type queue, std::int64_t row, const blob::Reference& reference);
+
+            struct Counter
+            {
+               std::size_t count = 0;
+               std::size_t size = 0;
+               std::size_t uncommitted = 0;
+               common::platform::time_point timestamp = common::platform::time_point::min();
+            };
+
+            //!
+            //! Rebuilds all counters from the messages, with one aggregate query
+            //!
+            void counters();
+
+            //!
+            //! Calls @p functor with the counter, state, number of messages and their size,
+            //! for each queue and state the messages in @p gtrid has
+            //!
+            template< typename F>
+            void transaction( const common::transaction::xid_range_type& gtrid, F&& functor);
+
             void updateQueue( const Queue& queue);
             void removeQueue( Queue::id_type id);
 
@@ -100,18 +233,34 @@ namespace casual
 
 
             sql::database::Connection m_connection;
+            Durability m_durability;
+            blob::Store m_blob;
             Queue::id_type m_error_queue;
 
+            std::unordered_map< Queue::id_type, Counter> m_counters;
+            std::set< Queue::id_type> m_dirty;
+
             struct Statement
             {
                sql::database::Statement enqueue;
 
+               struct blob_t
+               {
+                  sql::database::Statement insert;
+                  sql::database::Statement remove;
+                  sql::database::Statement segments;
+                  sql::database::Statement references;
+                  sql::database::Statement move;
+
+               } blob;
+
 
                struct dequeue_t
                {
                   sql::database::Statement first;
                   sql::database::Statement first_id;
                   sql::database::Statement first_match;
+                  sql::database::Statement available;
 
                } dequeue;
 
@@ -119,6 +268,7 @@ namespace casual
                {
                   sql::database::Statement xid;
                   sql::database::Statement nullxid;
+                  sql::database::Statement broken;
 
                } state;
 
@@ -138,6 +288,14 @@ namespace casual
 
                } information;
 
+               struct counter_t
+               {
+                  sql::database::Statement transaction;
+                  sql::database::Statement moved;
+                  sql::database::Statement flush;
+
+               } counter;
+
             } m_statement;
 
          };
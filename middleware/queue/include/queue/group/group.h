@@ -8,9 +8,12 @@
 #ifndef CASUALQUEUESERVER_H_
 #define CASUALQUEUESERVER_H_
 
+#include <deque>
+#include <map>
 #include <string>
 
 #include "queue/group/database.h"
+#include "queue/group/memory.h"
 
 #include "common/platform.h"
 #include "common/message/pending.h"
@@ -28,15 +31,75 @@ namespace casual
          {
             std::string queuebase;
             std::string name;
+
+            std::string journal;
+            std::string synchronous;
+            std::size_t cache = 0;
+            std::size_t checkpoint = 0;
+
+            //!
+            //! max number of persistent replies that is collected before the write transaction is committed
+            //!
+            std::size_t batch = common::platform::batch::transaction;
+
+            //!
+            //! payloads larger than this (bytes) is stored in the blob segments, 0 -> inline
+            //!
+            std::size_t blob = 0;
          };
 
          struct State
          {
-            State( std::string filename, std::string name)
-               : queuebase( std::move( filename), std::move( name)) {}
+            State( std::string filename, std::string name, Durability durability = Durability{},
+                  std::size_t batch = common::platform::batch::transaction, blob::Settings blob = blob::Settings{})
+               : queuebase( std::move( filename), std::move( name), std::move( durability), std::move( blob)), batch( batch) {}
 
             Database queuebase;
 
+            //!
+            //! messages for volatile queues
+            //!
+            Memory memory;
+
+            //!
+            //! max number of persistent replies per write transaction
+            //!
+            std::size_t batch;
+
+            //!
+            //! Keeps track of when it's time for periodic maintenance of the queuebase
+            //!
+            struct Interval
+            {
+               Interval( std::size_t interval) : interval( interval) {}
+
+               //!
+               //! @return true if the maintenance is due after this write transaction
+               //!
+               bool transaction()
+               {
+                  return interval > 0 && ++transactions % interval == 0;
+               }
+
+               std::size_t interval = 0;
+               std::size_t transactions = 0;
+            };
+
+            //!
+            //! explicit wal checkpoint
+            //!
+            Interval checkpoint{ queuebase.durability().checkpoint};
+
+            //!
+            //! removal and compaction of blob segments
+            //!
+            Interval compaction{ 1000};
+
+            //!
+            //! writes the in-memory queue counters to the queuebase
+            //!
+            Interval flush{ common::platform::batch::statistics};
+
 
             template< typename M>
             void persist( M&& message, std::vector< common::platform::queue_id_type> destinations)
@@ -54,23 +117,71 @@ namespace casual
             {
                using request_type = common::message::queue::dequeue::Request;
 
+               //!
+               //! blocked requests for one queue, in arrival order
+               //!
+               struct Waiting
+               {
+                  //!
+                  //! requests without selector, any message will do
+                  //!
+                  std::deque< request_type> any;
+
+                  //!
+                  //! requests that selects on properties, indexed by the properties
+                  //!
+                  std::map< std::string, std::deque< request_type>> properties;
+
+                  //!
+                  //! requests that selects a specific message id
+                  //!
+                  std::deque< request_type> id;
+
+                  bool empty() const { return any.empty() && properties.empty() && id.empty();}
+               };
 
-               std::vector< request_type> requests;
-               std::map< common::transaction::ID, std::map< queue_id_type, std::size_t>> transactions;
+               //!
+               //! enqueued messages in a transaction, for a queue someone is waiting on
+               //!
+               struct Enqueued
+               {
+                  std::size_t count = 0;
+                  std::map< std::string, std::size_t> properties;
+               };
+
+               std::map< queue_id_type, Waiting> requests;
+               std::map< common::transaction::ID, std::map< queue_id_type, Enqueued>> transactions;
 
                void dequeue( const request_type& request);
 
-               void enqueue( const common::transaction::ID& trid, queue_id_type queue);
+               //!
+               //! Puts back requests that was woken but did not get any message, first in line
+               //!
+               void restore( std::vector< request_type> requests);
+
+               void enqueue( const common::transaction::ID& trid, queue_id_type queue, const std::string& properties = std::string{});
 
 
                common::message::queue::dequeue::forget::Reply forget( const common::message::queue::dequeue::forget::Request& request);
 
                struct result_t
                {
-                  std::vector< request_type> requests;
-                  std::map< queue_id_type, std::size_t> enqueued;
+                  //!
+                  //! requests without selector, per queue, at most one per enqueued message
+                  //!
+                  std::map< queue_id_type, std::vector< request_type>> any;
+
+                  //!
+                  //! requests with a selector that could match the enqueued messages
+                  //!
+                  std::vector< request_type> selective;
+
+                  bool empty() const { return any.empty() && selective.empty();}
                };
 
+               //!
+               //! Removes, and returns, the requests that the committed enqueues in @p trid could satisfy
+               //!
                result_t commit( const common::transaction::ID& trid);
 
                void rollback( const common::transaction::ID& trid);
@@ -90,6 +90,19 @@ namespace casual
                   void operator () ( message_type& message);
                };
 
+               namespace batch
+               {
+                  struct Request : Base
+                  {
+                     using message_type = common::message::queue::enqueue::batch::Request;
+
+                     using Base::Base;
+
+                     void operator () ( message_type& message);
+                  };
+
+               } // batch
+
             } // enqueue
 
             namespace dequeue
@@ -0,0 +1,100 @@
+//!
+//! memory.h
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#ifndef CASUAL_QUEUE_GROUP_MEMORY_H_
+#define CASUAL_QUEUE_GROUP_MEMORY_H_
+
+#include "queue/group/database.h"
+
+#include "common/message/queue.h"
+
+#include <list>
+#include <map>
+#include <unordered_map>
+
+namespace casual
+{
+   namespace queue
+   {
+      namespace group
+      {
+         //!
+         //! Holds the messages of volatile queues, with the same semantics as Database,
+         //! but the messages are lost when the group goes down.
+         //!
+         //! The queues themselves are still created in the queuebase, so ids, lookup
+         //! and information is the same regardless of storage.
+         //!
+         class Memory
+         {
+         public:
+
+            //!
+            //! Holds @p queue, and its error queue, in memory from now on
+            //!
+            void add( const Queue& queue);
+
+            //!
+            //! @return true if messages to @p queue is held in memory
+            //!
+            bool handles( Queue::id_type queue) const;
+
+            common::message::queue::enqueue::Reply enqueue( const common::message::queue::enqueue::Request& message);
+            common::message::queue::enqueue::batch::Reply enqueue( const common::message::queue::enqueue::batch::Request& message);
+
+            //!
+            //! dequeues at most `message.count` messages
+            //!
+            common::message::queue::dequeue::Reply dequeue( const common::message::queue::dequeue::Request& message);
+
+            void commit( const common::transaction::ID& id);
+            void rollback( const common::transaction::ID& id);
+
+            //!
+            //! Updates count, size and uncommitted for the queues that is held in memory
+            //!
+            void information( std::vector< common::message::queue::information::Queue>& queues) const;
+
+            std::vector< common::message::queue::information::Message> messages( Queue::id_type id) const;
+
+         private:
+
+            struct Entry
+            {
+               common::message::queue::dequeue::Reply::Message message;
+               Queue::id_type origin = 0;
+               common::platform::binary_type gtrid;
+               message::State state = message::State::enqueued;
+            };
+
+            using entries_type = std::list< Entry>;
+            using position_type = entries_type::iterator;
+
+            struct Storage
+            {
+               Queue::id_type error = 0;
+               std::size_t retries = 0;
+               entries_type entries;
+            };
+
+            common::Uuid enqueue( const common::transaction::ID& trid, Queue::id_type queue, const common::message::queue::base_message& message);
+
+            Storage& storage( Queue::id_type queue);
+
+            std::unordered_map< Queue::id_type, Storage> m_queues;
+
+            //!
+            //! entries that is involved in a transaction, keyed by the global transaction id
+            //!
+            std::map< common::platform::binary_type, std::vector< std::tuple< Queue::id_type, position_type>>> m_transactions;
+         };
+
+      } // group
+   } // queue
+} // casual
+
+#endif // CASUAL_QUEUE_GROUP_MEMORY_H_
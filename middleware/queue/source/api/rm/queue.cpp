@@ -129,7 +129,25 @@ namespace casual
                } // scoped
 
 
-               sf::platform::Uuid enqueue( const std::string& queue, const Message& message)
+               namespace transform
+               {
+                  common::message::queue::base_message message( const Message& message)
+                  {
+                     common::message::queue::base_message result;
+
+                     result.payload = message.payload.data;
+                     result.type.name = message.payload.type.type;
+                     result.type.subname = message.payload.type.subtype;
+                     result.properties = message.attributes.properties;
+                     result.reply = message.attributes.reply;
+                     result.avalible = message.attributes.available;
+
+                     return result;
+                  }
+               } // transform
+
+               template< typename Request, typename Reply>
+               Reply enqueue( const std::string& queue, Request& request)
                {
                   //
                   // Register to TM
@@ -138,46 +156,45 @@ namespace casual
 
                   auto send_request = [&]()
                   {
-                     queue::Lookup lookup( queue);
-
-                     common::message::queue::enqueue::Request request;
                      request.trid = ax_reg.trid;
 
                      request.process = common::process::handle();
 
-                     request.message.payload = message.payload.data;
-                     request.message.type.name = message.payload.type.type;
-                     request.message.type.subname = message.payload.type.subtype;
-                     request.message.properties = message.attributes.properties;
-                     request.message.reply = message.attributes.reply;
-                     request.message.avalible = message.attributes.available;
-
-                     auto group = lookup();
+                     return queue::lookup::Cache::instance().invoke( queue, [&]( const common::message::queue::lookup::Reply& group){
 
-                     if( group.queue == 0)
-                     {
-                        throw common::exception::invalid::Argument{ "failed to look up queue: " + queue};
-                     }
-                     request.queue = group.queue;
+                        if( group.queue == 0)
+                        {
+                           throw common::exception::invalid::Argument{ "failed to look up queue: " + queue};
+                        }
+                        request.queue = group.queue;
 
-                     common::log::internal::queue << "enqueues - queue: " << queue << " group: " << group.queue << " process: " << group.process << std::endl;
-                     common::log::internal::queue << "enqueues - request: " << request << std::endl;
+                        common::log::internal::queue << "enqueues - queue: " << queue << " group: " << group.queue << " process: " << group.process << std::endl;
+                        common::log::internal::queue << "enqueues - request: " << request << std::endl;
 
-                     return casual::common::communication::ipc::blocking::send( group.process.queue, request);
+                        return casual::common::communication::ipc::blocking::send( group.process.queue, request);
+                     });
                   };
 
-                  common::message::queue::enqueue::Reply reply;
+                  Reply reply;
 
                   casual::common::communication::ipc::blocking::receive(
                         casual::common::communication::ipc::inbound::device(),
                         reply,
                         send_request());
 
-                  return reply.id;
+                  return reply;
                }
 
+               sf::platform::Uuid enqueue( const std::string& queue, const Message& message)
+               {
+                  common::message::queue::enqueue::Request request;
+                  request.message = transform::message( message);
+
+                  return enqueue< common::message::queue::enqueue::Request, common::message::queue::enqueue::Reply>( queue, request).id;
+               }
 
-               std::vector< Message> dequeue( const std::string& queue, const Selector& selector, bool block = false)
+
+               std::vector< Message> dequeue( const std::string& queue, const Selector& selector, bool block = false, std::size_t count = 1)
                {
 
                   //
@@ -189,15 +206,13 @@ namespace casual
 
                   common::scope::Execute forget_blocking{ [&]()
                   {
-                     queue::Lookup lookup( queue);
-
                      common::message::queue::dequeue::forget::Request request;
                      request.process = common::process::handle();
 
-                     auto group = lookup();
-                     request.queue = group.queue;
-
-                     auto correlation = ipc.blocking_send( group.process.queue, request);
+                     auto correlation = queue::lookup::Cache::instance().invoke( queue, [&]( const common::message::queue::lookup::Reply& group){
+                        request.queue = group.queue;
+                        return ipc.blocking_send( group.process.queue, request);
+                     });
 
                      common::message::queue::dequeue::forget::Reply reply;
                      ipc.blocking_receive( reply, correlation);
@@ -205,22 +220,22 @@ namespace casual
 
                   auto send_reqeust = [&]()
                   {
-                     queue::Lookup lookup( queue);
-
                      common::message::queue::dequeue::Request request;
                      request.trid = ax_reg.trid;
 
                      request.process = common::process::handle();
-
-                     auto group = lookup();
-                     request.queue = group.queue;
                      request.block = block;
+                     request.count = count;
                      request.selector.id = selector.id;
                      request.selector.properties = selector.properties;
 
-                     common::log::internal::queue << "async::dequeue - request: " << request << std::endl;
+                     return queue::lookup::Cache::instance().invoke( queue, [&]( const common::message::queue::lookup::Reply& group){
+                        request.queue = group.queue;
 
-                     return ipc.blocking_send( group.process.queue, request);
+                        common::log::internal::queue << "async::dequeue - request: " << request << std::endl;
+
+                        return ipc.blocking_send( group.process.queue, request);
+                     });
                   };
 
                   auto correlation = send_reqeust();
@@ -294,6 +309,47 @@ namespace casual
 
 
 
+         namespace batch
+         {
+            std::vector< sf::platform::Uuid> enqueue( const std::string& queue, const std::vector< Message>& messages)
+            {
+               common::trace::Scope trace( "queue::rm::batch::enqueue", common::log::internal::queue);
+
+               if( messages.empty())
+               {
+                  return {};
+               }
+
+               common::message::queue::enqueue::batch::Request request;
+               request.messages = common::range::transform( messages, &local::transform::message);
+
+               auto ids = local::enqueue< common::message::queue::enqueue::batch::Request, common::message::queue::enqueue::batch::Reply>( queue, request).ids;
+
+               //
+               // The group replies without ids if the batch failed, nothing is enqueued
+               //
+               if( ids.size() != messages.size())
+               {
+                  throw common::exception::NotReallySureWhatToNameThisException{ "failed to enqueue batch to queue: " + queue};
+               }
+
+               return ids;
+            }
+
+            std::vector< Message> dequeue( const std::string& queue, const Selector& selector, std::size_t max)
+            {
+               common::trace::Scope trace( "queue::rm::batch::dequeue", common::log::internal::queue);
+
+               if( max == 0)
+               {
+                  return {};
+               }
+
+               return local::dequeue( queue, selector, false, max);
+            }
+
+         } // batch
+
          namespace blocking
          {
             Message dequeue( const std::string& queue, const Selector& selector)
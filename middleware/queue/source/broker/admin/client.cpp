@@ -171,6 +171,24 @@ namespace casual
             };
          }
 
+         terminal::format::formatter< broker::admin::Forward> forwards()
+         {
+            using f_type = broker::admin::Forward;
+
+            return {
+               { global::porcelain, global::color, global::header},
+               terminal::format::column( "queue", std::mem_fn( &f_type::queue), terminal::color::yellow),
+               terminal::format::column( "pid", []( const f_type& f){ return f.pid;}, terminal::color::grey, terminal::format::Align::right),
+               terminal::format::column( "forwarded", []( const f_type& f){ return f.forwarded;}, terminal::color::green, terminal::format::Align::right),
+               terminal::format::column( "rolledback", []( const f_type& f){ return f.rolledback;}, terminal::color::cyan, terminal::format::Align::right),
+               terminal::format::column( "errored", []( const f_type& f){ return f.errored;}, terminal::color::red, terminal::format::Align::right),
+               terminal::format::column( "trans", []( const f_type& f){ return f.transactions;}, terminal::color::no_color, terminal::format::Align::right),
+               terminal::format::column( "high", []( const f_type& f){ return f.high;}, terminal::color::no_color, terminal::format::Align::right),
+               terminal::format::column( "started", []( const f_type& f){ return normalize::timestamp( f.start);}),
+               terminal::format::column( "updated", []( const f_type& f){ return normalize::timestamp( f.timestamp);}),
+            };
+         }
+
       } // format
 
 
@@ -199,6 +217,15 @@ namespace casual
          formatter.print( std::cout, state.groups);
       }
 
+      void listForwards()
+      {
+         auto state = call::state();
+
+         auto formatter = format::forwards();
+
+         formatter.print( std::cout, state.forwards);
+      }
+
       void listMessages( const std::string& queue)
       {
          auto messages = call::messages( queue);
@@ -265,6 +292,7 @@ namespace casual
             common::argument::directive( {"--porcelain"}, "Easy to parse format", queue::global::porcelain),
             common::argument::directive( {"-q", "--list-queues"}, "list information of all queues in current domain", &queue::listQueues),
             common::argument::directive( {"-g", "--list-groups"}, "list information of all groups in current domain", &queue::listGroups),
+            common::argument::directive( {"-f", "--list-forwards"}, "list statistics of all forwarders that reports statistics", &queue::listForwards),
             common::argument::directive( {"-m", "--list-messages"}, "list information of all messages of a queue", &queue::listMessages),
             common::argument::directive( {"-e", "--enqueue"}, "enqueue to a queue from stdin\n  cat somefile.bin | casual-admin queue --enqueue <queue-name>\n  note: should not be used with rest of casual", &queue::enqueue_),
             common::argument::directive( {"-d", "--dequeue"}, "dequeue from a queue to stdout\n  casual-admin queue --dequeue <queue-name> > somefile.bin\n  note: should not be used with rest of casual", &queue::dequeue_)
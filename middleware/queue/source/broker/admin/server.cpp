@@ -131,6 +131,7 @@ namespace casual
 
                result.queues = transform::queues( broker::queues( state));
                result.groups = transform::groups( state);
+               result.forwards = transform::forwards( state);
 
                return result;
             }
@@ -68,6 +68,7 @@ namespace casual
                         {
                            result.retries = std::stoul( value.retries);
                         }
+                        result.persistent = value.storage != "volatile";
                         return result;
                      }
                   };
@@ -84,9 +85,26 @@ namespace casual
                      queueGroup.name = group.name;
                      queueGroup.queuebase = group.queuebase;
 
+                     std::vector< std::string> arguments{ "--queuebase", group.queuebase, "--name", group.name};
+
+                     auto option = [&]( const std::string& name, const std::string& value){
+                        if( ! value.empty())
+                        {
+                           arguments.push_back( name);
+                           arguments.push_back( value);
+                        }
+                     };
+
+                     option( "--journal", group.durability.journal);
+                     option( "--synchronous", group.durability.synchronous);
+                     option( "--cache", group.durability.cache);
+                     option( "--checkpoint", group.durability.checkpoint);
+                     option( "--batch", group.durability.batch);
+                     option( "--blob-threshold", group.durability.blob);
+
                      queueGroup.process.pid = casual::common::process::spawn(
                         m_state.group_executable,
-                        { "--queuebase", group.queuebase, "--name", group.name});
+                        arguments);
 
                      common::message::queue::connect::Request request;
                      ipc::device().blocking_receive( request);
@@ -144,6 +162,7 @@ namespace casual
                   broker::handle::shutdown::Request{ state},
                   broker::handle::lookup::Request{ state},
                   broker::handle::group::Involved{ state},
+                  broker::handle::forward::Statistics{ state},
                   broker::handle::transaction::commit::Request{ state},
                   broker::handle::transaction::commit::Reply{ state},
                   broker::handle::transaction::rollback::Request{ state},
@@ -131,6 +131,8 @@ namespace casual
                         }
                      }
                   }
+                  m_state.forwards.erase( exit.pid);
+
                   //
                   // Invalidate xa-requests
                   //
@@ -237,6 +239,15 @@ namespace casual
                }
             } // group
 
+            namespace forward
+            {
+               void Statistics::operator () ( message_type& message)
+               {
+                  m_state.forwards[ message.process.pid] = std::move( message);
+               }
+
+            } // forward
+
 
             namespace transaction
             {
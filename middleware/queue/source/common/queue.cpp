@@ -10,6 +10,7 @@
 
 
 #include "common/communication/ipc.h"
+#include "common/log.h"
 
 
 namespace casual
@@ -35,6 +36,59 @@ namespace casual
          return reply;
       }
 
+      namespace lookup
+      {
+         Cache& Cache::instance()
+         {
+            static Cache singleton;
+            return singleton;
+         }
+
+         Cache::Cache() = default;
+
+         Cache::reply_type Cache::get( const std::string& queue)
+         {
+            auto found = m_replies.find( queue);
+
+            if( found != std::end( m_replies))
+            {
+               return found->second;
+            }
+
+            Lookup lookup( queue);
+            auto reply = lookup();
+
+            if( reply.queue != 0)
+            {
+               m_replies.emplace( queue, reply);
+            }
+
+            return reply;
+         }
+
+         void Cache::invalidate( const common::process::Handle& group)
+         {
+            common::log::internal::queue << "lookup cache - invalidate group: " << group << std::endl;
+
+            for( auto current = std::begin( m_replies); current != std::end( m_replies);)
+            {
+               if( current->second.process == group)
+               {
+                  current = m_replies.erase( current);
+               }
+               else
+               {
+                  ++current;
+               }
+            }
+         }
+
+         void Cache::clear()
+         {
+            m_replies.clear();
+         }
+
+      } // lookup
 
    } // queue
 } // casual
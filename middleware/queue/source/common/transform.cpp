@@ -40,6 +40,27 @@ namespace casual
                   }
                };
 
+               struct Forward
+               {
+                  broker::admin::Forward operator () ( const common::message::queue::forward::Statistics& statistics) const
+                  {
+                     broker::admin::Forward result;
+
+                     result.pid = statistics.process.pid;
+                     result.queue = statistics.queue;
+                     result.forwarded = statistics.forwarded;
+                     result.rolledback = statistics.rolledback;
+                     result.errored = statistics.errored;
+                     result.transactions = statistics.transactions;
+                     result.in_flight = statistics.in_flight;
+                     result.high = statistics.high;
+                     result.start = statistics.start;
+                     result.timestamp = statistics.timestamp;
+
+                     return result;
+                  }
+               };
+
             } // <unnamed>
          } // local
 
@@ -55,6 +76,24 @@ namespace casual
             return result;
          }
 
+         std::vector< broker::admin::Forward> forwards( const broker::State& state)
+         {
+            std::vector< broker::admin::Forward> result;
+
+            for( auto& forward : state.forwards)
+            {
+               //
+               // We only know about forwarders that are gone if their ipc-queue is gone
+               //
+               if( common::communication::ipc::exists( forward.second.process.queue))
+               {
+                  result.push_back( local::Forward{}( forward.second));
+               }
+            }
+
+            return result;
+         }
+
          broker::admin::Queue Queue::operator () ( const common::message::queue::information::Queue& queue) const
          {
             broker::admin::Queue result;
@@ -100,6 +139,7 @@ namespace casual
             result.attributes.available = value.avalible;
             result.attributes.properties = value.properties;
             result.attributes.reply = value.reply;
+            result.attributes.redelivered = value.redelivered;
             result.payload.type.type = value.type.name;
             result.payload.type.subtype = value.type.subname;
             std::swap( result.payload.data, value.payload);
@@ -8,18 +8,25 @@
 #include "queue/forward/common.h"
 #include "queue/common/queue.h"
 #include "queue/api/rm/queue.h"
+#include "queue/common/environment.h"
 
 #include "common/communication/ipc.h"
 #include "common/message/dispatch.h"
 #include "common/message/handle.h"
 #include "common/transaction/context.h"
+#include "common/call/context.h"
 #include "common/server/handle.h"
+#include "common/log.h"
+#include "common/internal/log.h"
+#include "common/algorithm.h"
 
 #include "queue/rm/switch.h"
 
 
 #include "tx.h"
 
+#include <iterator>
+
 namespace casual
 {
    namespace queue
@@ -30,66 +37,133 @@ namespace casual
          {
             namespace
             {
-               bool perform( const forward::Task& task)
+               //!
+               //! @return the retries of the queue, from the group that has it
+               //!
+               std::size_t retries( const std::string& queue)
                {
-                  try
-                  {
-                     if( tx_begin() != TX_OK)
+                  return queue::lookup::Cache::instance().invoke( queue, [&]( const common::message::queue::lookup::Reply& group){
+
+                     if( group.queue == 0)
                      {
-                        return false;
+                        throw common::exception::invalid::Argument{ "failed to look up queue: " + queue};
                      }
 
-                     //
-                     // Rollback unless we commit
-                     //
-                     common::scope::Execute rollback{ [](){
-                           tx_rollback();
-                     }};
+                     common::message::queue::information::queues::Request request;
+                     request.process = common::process::handle();
+
+                     common::message::queue::information::queues::Reply reply;
+
+                     common::communication::ipc::blocking::receive(
+                           common::communication::ipc::inbound::device(),
+                           reply,
+                           common::communication::ipc::blocking::send( group.process.queue, request));
 
-                     task.dispatch( rm::blocking::dequeue( task.queue));
+                     auto found = common::range::find_if( reply.queues, [&]( const common::message::queue::information::Queue& q){
+                        return q.id == group.queue;
+                     });
 
-                     //
-                     // Check what we should do with the transaction
-                     //
+                     if( ! found)
                      {
-                        TXINFO txinfo;
-                        tx_info( &txinfo);
-
-                        if( txinfo.transaction_state == TX_ACTIVE)
-                        {
-                           tx_commit();
-                           rollback.release();
-                        }
+                        throw common::exception::invalid::Argument{ "failed to find queue in group: " + queue};
                      }
-                  }
-                  catch( const common::exception::Shutdown&)
-                  {
-                     return false;
-                  }
-                  catch( ...)
-                  {
-                     common::error::handler();
-                     return false;
-                  }
 
-                  return true;
+                     return found->retries;
+                  });
                }
 
             } // <unnamed>
          } // local
 
+         std::ostream& operator << ( std::ostream& out, const Statistics& value)
+         {
+            return out << "{ forwarded: " << value.forwarded
+                  << ", rolledback: " << value.rolledback
+                  << ", errored: " << value.errored
+                  << ", transactions: " << value.transactions
+                  << ", in-flight: " << value.in_flight
+                  << ", high: " << value.high
+                  << '}';
+         }
 
-         Dispatch::Dispatch( std::vector< forward::Task> tasks)
-            : Dispatch( std::move( tasks), { { "casual-queue-rm",  &casual_queue_xa_switch_dynamic}}) {}
+         Policy::Policy( const Configuration& configuration) : m_batch( configuration.batch) {}
 
-         Dispatch::Dispatch( std::vector< forward::Task> tasks, const std::vector< common::transaction::Resource>& resources)
-           : m_tasks( std::move( tasks))
+         std::size_t Policy::batch() const
+         {
+            return isolated() ? 1 : m_batch;
+         }
+
+         void Policy::dequeued( std::size_t count)
+         {
+            m_statistics.in_flight = count;
+            m_statistics.high = std::max( m_statistics.high, count);
+         }
+
+         void Policy::committed( std::size_t count)
+         {
+            transaction();
+            m_statistics.forwarded += count;
+         }
+
+         void Policy::rolledback( const std::vector< std::size_t>& redelivered, std::size_t retries)
+         {
+            auto isolated = this->isolated();
+
+            transaction();
+
+            for( auto count : redelivered)
+            {
+               //
+               // The group increments redelivered, and moves the message when it exceeds the retries
+               //
+               if( count + 1 > retries)
+               {
+                  ++m_statistics.errored;
+               }
+               else
+               {
+                  ++m_statistics.rolledback;
+               }
+            }
+
+            if( ! isolated && redelivered.size() > 1)
+            {
+               //
+               // We don't know which one failed, retry them one by one
+               //
+               m_isolated = redelivered.size();
+            }
+         }
+
+         void Policy::transaction()
+         {
+            ++m_statistics.transactions;
+            m_statistics.in_flight = 0;
+
+            if( m_isolated > 0)
+            {
+               --m_isolated;
+            }
+         }
+
+
+         Dispatch::Dispatch( std::vector< forward::Task> tasks, Configuration configuration)
+            : Dispatch( std::move( tasks), std::move( configuration), { { "casual-queue-rm",  &casual_queue_xa_switch_dynamic}}) {}
+
+         Dispatch::Dispatch( std::vector< forward::Task> tasks, Configuration configuration, const std::vector< common::transaction::Resource>& resources)
+           : m_tasks( std::move( tasks)), m_configuration( std::move( configuration)), m_policy( m_configuration)
          {
             if( m_tasks.size() != 1)
             {
                throw common::exception::invalid::Argument{ "only one task is allowed"};
             }
 
+            if( m_configuration.batch == 0 || m_configuration.concurrent == 0)
+            {
+               throw common::exception::invalid::Argument{ "batch and concurrent has to be at least 1",
+                  CASUAL_NIP( m_configuration.batch), CASUAL_NIP( m_configuration.concurrent)};
+            }
+
             common::signal::timer::Scoped timout{ std::chrono::seconds{ 5}};
 
             common::server::connect( common::communication::ipc::inbound::device(), {}, resources);
@@ -98,8 +172,212 @@ namespace casual
 
          void Dispatch::execute()
          {
-            while( local::perform( m_tasks.front()))
-               ;
+            try
+            {
+               m_retries = local::retries( m_tasks.front().queue);
+            }
+            catch( ...)
+            {
+               common::error::handler();
+               return;
+            }
+
+            while( perform())
+            {
+               log();
+            }
+         }
+
+         bool Dispatch::perform()
+         {
+            auto& task = m_tasks.front();
+
+            try
+            {
+               if( tx_begin() != TX_OK)
+               {
+                  return false;
+               }
+
+               //
+               // redelivered count of the messages in the transaction
+               //
+               std::vector< std::size_t> redelivered;
+
+               //
+               // Rollback unless we commit
+               //
+               common::scope::Execute rollback{ [&](){
+                     tx_rollback();
+
+                     if( ! redelivered.empty())
+                     {
+                        m_policy.rolledback( redelivered, m_retries);
+                     }
+               }};
+
+               auto batch = m_policy.batch();
+
+               std::vector< queue::Message> messages;
+
+               if( batch > 1 || m_configuration.statistics > 0)
+               {
+                  //
+                  // Take what's there, we only block (and report) when the queue is empty
+                  //
+                  messages = rm::batch::dequeue( task.queue, queue::Selector{}, batch);
+               }
+
+               if( messages.empty())
+               {
+                  report();
+
+                  //
+                  // We might wait for a while, hand back the reservations (if any) we've got
+                  // while forwarding to services
+                  //
+                  common::call::Context::instance().release();
+
+                  //
+                  // We block until there is at least one message, then we prefetch what's left
+                  // of the batch, if any
+                  //
+                  messages.push_back( rm::blocking::dequeue( task.queue));
+
+                  if( batch > 1)
+                  {
+                     auto prefetched = rm::batch::dequeue( task.queue, queue::Selector{}, batch - 1);
+                     std::move( std::begin( prefetched), std::end( prefetched), std::back_inserter( messages));
+                  }
+               }
+
+               for( auto& message : messages)
+               {
+                  redelivered.push_back( message.attributes.redelivered);
+               }
+
+               m_policy.dequeued( messages.size());
+
+               try
+               {
+                  task.dispatch( std::move( messages));
+               }
+               catch( const common::exception::Shutdown&)
+               {
+                  throw;
+               }
+               catch( const common::exception::signal::base&)
+               {
+                  throw;
+               }
+               catch( ...)
+               {
+                  //
+                  // The messages are rolled back and we carry on, the group moves them to
+                  // the error queue when the retries are exceeded
+                  //
+                  common::error::handler();
+                  return true;
+               }
+
+               //
+               // Check what we should do with the transaction
+               //
+               {
+                  TXINFO txinfo;
+                  tx_info( &txinfo);
+
+                  if( txinfo.transaction_state == TX_ACTIVE)
+                  {
+                     rollback.release();
+
+                     if( tx_commit() == TX_OK)
+                     {
+                        m_policy.committed( redelivered.size());
+                     }
+                     else
+                     {
+                        m_policy.rolledback( redelivered, m_retries);
+                     }
+                  }
+               }
+            }
+            catch( const common::exception::Shutdown&)
+            {
+               return false;
+            }
+            catch( ...)
+            {
+               common::error::handler();
+               return false;
+            }
+
+            return true;
+         }
+
+         void Dispatch::log()
+         {
+            if( m_configuration.statistics == 0)
+            {
+               return;
+            }
+
+            auto now = common::platform::clock_type::now();
+            auto elapsed = std::chrono::duration_cast< std::chrono::duration< double>>( now - m_logged.time);
+
+            if( elapsed < std::chrono::seconds{ m_configuration.statistics})
+            {
+               return;
+            }
+
+            auto& statistics = m_policy.statistics();
+
+            auto rate = ( statistics.forwarded - m_logged.forwarded) / elapsed.count();
+
+            common::log::information << "forward queue: " << m_tasks.front().queue
+                  << " - statistics: " << statistics
+                  << " - rate: " << rate << " messages/s" << std::endl;
+
+            m_logged.time = now;
+            m_logged.forwarded = statistics.forwarded;
+
+            report();
+         }
+
+         void Dispatch::report()
+         {
+            auto& statistics = m_policy.statistics();
+
+            if( m_configuration.statistics == 0 || statistics.transactions == m_reported)
+            {
+               return;
+            }
+
+            common::message::queue::forward::Statistics message;
+            message.process = common::process::handle();
+            message.queue = m_tasks.front().queue;
+            message.forwarded = statistics.forwarded;
+            message.rolledback = statistics.rolledback;
+            message.errored = statistics.errored;
+            message.transactions = statistics.transactions;
+            message.in_flight = statistics.in_flight;
+            message.high = statistics.high;
+            message.start = statistics.start;
+            message.timestamp = common::platform::clock_type::now();
+
+            try
+            {
+               //
+               // Statistics is not worth blocking for
+               //
+               common::communication::ipc::non::blocking::send( environment::broker::queue::id(), message);
+            }
+            catch( const common::exception::queue::Unavailable&)
+            {
+               common::log::internal::queue << "queue-broker unavailable - statistics not reported" << std::endl;
+            }
+
+            m_reported = statistics.transactions;
          }
 
       } // forward
@@ -43,16 +43,25 @@ namespace casual
             }
 
             std::vector< dispatch_t> dispatch;
+            forward::Configuration configuration;
          };
 
          struct Enqueuer
          {
             Enqueuer( std::string queue) : m_queue( std::move( queue)) {}
 
-            void operator () ( queue::Message&& message)
+            void operator () ( std::vector< queue::Message>&& messages)
             {
                common::trace::Scope trace{ "queue::forward::Enqueuer::operator()", common::log::internal::queue};
-               queue::rm::enqueue( m_queue, message);
+
+               if( messages.size() == 1)
+               {
+                  queue::rm::enqueue( m_queue, messages.front());
+               }
+               else
+               {
+                  queue::rm::batch::enqueue( m_queue, messages);
+               }
             }
 
          private:
@@ -74,7 +83,9 @@ namespace casual
          void start( Settings settings)
          {
 
-            Dispatch dispatch( tasks( std::move( settings)));
+            auto configuration = settings.configuration;
+
+            Dispatch dispatch( tasks( std::move( settings)), std::move( configuration));
 
             dispatch.execute();
 
@@ -89,7 +100,9 @@ namespace casual
 
                {
                   common::Arguments parser{ {
-                        common::argument::directive( {"-f", "--forward"}, "--forward  <from-queue> <to-queue>", settings, &Settings::setForward)
+                        common::argument::directive( {"-f", "--forward"}, "--forward  <from-queue> <to-queue>", settings, &Settings::setForward),
+                        common::argument::directive( {"--batch"}, "max number of messages per transaction - default 1", settings.configuration.batch),
+                        common::argument::directive( {"--statistics"}, "seconds between logged and reported statistics - default 0 (never)", settings.configuration.statistics)
                   }};
 
                   parser.parse( argc, argv);
@@ -15,6 +15,9 @@
 #include "common/buffer/pool.h"
 #include "common/call/context.h"
 
+#include <deque>
+#include <map>
+
 
 namespace casual
 {
@@ -48,16 +51,77 @@ namespace casual
             }
 
             std::vector< dispatch_t> dispatch;
+            forward::Configuration configuration;
          };
 
          struct Caller
          {
-            Caller( std::string service, std::string reply) : m_service( std::move( service)), m_reply( std::move( reply)) {}
+            Caller( std::string service, std::string reply, std::size_t concurrent)
+               : m_service( std::move( service)), m_reply( std::move( reply)), m_concurrent( concurrent) {}
 
-            void operator () ( queue::Message&& message)
+            void operator () ( std::vector< queue::Message>&& messages)
             {
                common::trace::internal::Scope trace{ "queue::forward::Caller::operator()", common::log::internal::queue};
 
+               //
+               // We keep at most m_concurrent calls in-flight, and collect the replies per
+               // reply queue so we can enqueue them in one exchange each
+               //
+               std::deque< Call> calls;
+               std::map< std::string, std::vector< queue::Message>> replies;
+
+               //
+               // Make sure we don't leave any calls behind if something goes wrong
+               //
+               common::scope::Execute discard{ [&](){
+                  for( auto& call : calls)
+                  {
+                     common::call::Context::instance().cancel( call.descriptor);
+                     common::buffer::pool::Holder::instance().deallocate( call.buffer);
+                  }
+               }};
+
+               for( auto& message : messages)
+               {
+                  if( calls.size() >= m_concurrent)
+                  {
+                     receive( calls, replies);
+                  }
+                  calls.push_back( call( message));
+               }
+
+               while( ! calls.empty())
+               {
+                  receive( calls, replies);
+               }
+
+               discard.release();
+
+               for( auto& reply : replies)
+               {
+                  if( reply.second.size() == 1)
+                  {
+                     queue::rm::enqueue( reply.first, reply.second.front());
+                  }
+                  else
+                  {
+                     queue::rm::batch::enqueue( reply.first, reply.second);
+                  }
+               }
+            }
+
+         private:
+
+            struct Call
+            {
+               common::platform::descriptor_type descriptor;
+               char* buffer;
+               long size;
+               std::string reply;
+            };
+
+            Call call( queue::Message& message)
+            {
                //
                // Prepare the xatmi-buffer
                //
@@ -70,31 +134,50 @@ namespace casual
 
                common::log::internal::queue << "payload: " << payload << std::endl;
 
-               long size = payload.memory.size();
+               Call result;
+               result.size = payload.memory.size();
+               result.buffer = common::buffer::pool::Holder::instance().insert( std::move( payload));
+               result.reply = m_reply.empty() ? message.attributes.reply : m_reply;
 
-               auto buffer = common::buffer::pool::Holder::instance().insert( std::move( payload));
+               try
+               {
+                  result.descriptor = common::call::Context::instance().async( m_service, result.buffer, result.size, TPNOTIME);
+               }
+               catch( ...)
+               {
+                  common::buffer::pool::Holder::instance().deallocate( result.buffer);
+                  throw;
+               }
 
-               common::call::Context::instance().sync( m_service, buffer, size, buffer, size, TPNOTIME);
+               return result;
+            }
 
-               const auto& replyqueue = m_reply.empty() ? message.attributes.reply : m_reply;
+            void receive( std::deque< Call>& calls, std::map< std::string, std::vector< queue::Message>>& replies)
+            {
+               //
+               // We take the oldest call, the reply replaces (and deallocates) the input buffer
+               //
+               auto call = std::move( calls.front());
+               calls.pop_front();
 
-               if( ! replyqueue.empty())
-               {
-                  auto data = common::buffer::pool::Holder::instance().release( buffer);
+               common::call::Context::instance().reply( call.descriptor, &call.buffer, call.size, TPNOTIME);
 
+               auto data = common::buffer::pool::Holder::instance().release( call.buffer);
+
+               if( ! call.reply.empty())
+               {
                   queue::Message reply;
                   reply.payload.data = std::move( data.memory);
                   reply.payload.type.type = std::move( data.type.name);
                   reply.payload.type.subtype = std::move( data.type.subname);
 
-                  queue::rm::enqueue( replyqueue, reply);
-
+                  replies[ call.reply].push_back( std::move( reply));
                }
             }
 
-         private:
             std::string m_service;
             std::string m_reply;
+            std::size_t m_concurrent;
          };
 
          std::vector< forward::Task> tasks( Settings settings)
@@ -103,7 +186,7 @@ namespace casual
 
             for( auto& task : settings.dispatch)
             {
-               tasks.emplace_back( task.queue, Caller{ task.service, task.reply});
+               tasks.emplace_back( task.queue, Caller{ task.service, task.reply, settings.configuration.concurrent});
             }
 
             return tasks;
@@ -112,7 +195,9 @@ namespace casual
          void start( Settings settings)
          {
 
-            Dispatch dispatch( tasks( std::move( settings)));
+            auto configuration = settings.configuration;
+
+            Dispatch dispatch( tasks( std::move( settings)), std::move( configuration));
 
             dispatch.execute();
 
@@ -127,7 +212,10 @@ namespace casual
 
                {
                   common::Arguments parser{ {
-                     common::argument::directive( {"-f", "--forward"}, "forward  <queue> <service> [<reply>]", settings, &Settings::setForward)
+                     common::argument::directive( {"-f", "--forward"}, "forward  <queue> <service> [<reply>]", settings, &Settings::setForward),
+                     common::argument::directive( {"--batch"}, "max number of messages per transaction - default 1", settings.configuration.batch),
+                     common::argument::directive( {"--concurrent"}, "max number of service calls in-flight - default 1", settings.configuration.concurrent),
+                     common::argument::directive( {"--statistics"}, "seconds between logged and reported statistics - default 0 (never)", settings.configuration.statistics)
                   }};
 
                   parser.parse( argc, argv);
@@ -0,0 +1,270 @@
+//!
+//! blob.cpp
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#include "queue/group/blob.h"
+
+#include "common/exception.h"
+#include "common/error.h"
+#include "common/file.h"
+#include "common/internal/log.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#include <cstring>
+
+namespace casual
+{
+   namespace queue
+   {
+      namespace group
+      {
+         namespace blob
+         {
+            struct Store::Segment
+            {
+               Segment( const std::string& path) : path( path)
+               {
+                  descriptor = ::open( path.c_str(), O_RDWR | O_CREAT, 0660);
+
+                  if( descriptor == -1)
+                  {
+                     throw common::exception::invalid::File{ "failed to open blob segment: " + path + " - " + common::error::string()};
+                  }
+
+                  struct stat status;
+                  if( ::fstat( descriptor, &status) == -1)
+                  {
+                     ::close( descriptor);
+                     throw common::exception::invalid::File{ "failed to stat blob segment: " + path + " - " + common::error::string()};
+                  }
+                  size = status.st_size;
+               }
+
+               ~Segment()
+               {
+                  unmap();
+                  ::close( descriptor);
+               }
+
+               void write( const char* data, std::size_t count)
+               {
+                  auto offset = size;
+
+                  while( count > 0)
+                  {
+                     auto written = ::pwrite( descriptor, data, count, offset);
+
+                     if( written == -1)
+                     {
+                        if( errno == EINTR)
+                        {
+                           continue;
+                        }
+                        throw common::exception::invalid::File{ "failed to write blob segment: " + path + " - " + common::error::string()};
+                     }
+                     data += written;
+                     offset += written;
+                     count -= written;
+                  }
+                  size = offset;
+               }
+
+               const char* map( std::size_t end)
+               {
+                  if( end > mapped)
+                  {
+                     //
+                     // The segment has grown since we mapped it
+                     //
+                     unmap();
+
+                     auto address = ::mmap( nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+
+                     if( address == MAP_FAILED)
+                     {
+                        throw common::exception::invalid::File{ "failed to map blob segment: " + path + " - " + common::error::string()};
+                     }
+                     mapping = static_cast< const char*>( address);
+                     mapped = size;
+                  }
+                  return mapping;
+               }
+
+               void unmap()
+               {
+                  if( mapping)
+                  {
+                     ::munmap( const_cast< char*>( mapping), mapped);
+                     mapping = nullptr;
+                     mapped = 0;
+                  }
+               }
+
+               std::string path;
+               int descriptor = -1;
+               std::size_t size = 0;
+
+               const char* mapping = nullptr;
+               std::size_t mapped = 0;
+            };
+
+            Store::Store( const std::string& queuebase, Settings settings)
+               : m_settings( std::move( settings))
+            {
+               if( queuebase.empty() || queuebase == ":memory:")
+               {
+                  m_settings.threshold = 0;
+                  return;
+               }
+
+               m_base = queuebase + ".blob.";
+
+               //
+               // Find existing segments, we continue to append to the last one. We do this even if
+               // threshold is 0, the queuebase could still refer to blobs from earlier runs
+               //
+               auto directory = m_base.find( '/') == std::string::npos ? std::string{ "."} : common::directory::name::base( m_base);
+               auto prefix = common::file::name::base( m_base);
+
+               std::unique_ptr< DIR, int(*)( DIR*)> handle{ ::opendir( directory.c_str()), &::closedir};
+
+               if( handle)
+               {
+                  while( auto entry = ::readdir( handle.get()))
+                  {
+                     std::string name = entry->d_name;
+
+                     if( name.size() > prefix.size() && name.compare( 0, prefix.size(), prefix) == 0)
+                     {
+                        auto number = name.substr( prefix.size());
+
+                        if( number.find_first_not_of( "0123456789") == std::string::npos)
+                        {
+                           auto id = std::stoul( number);
+                           segment( id);
+                           m_active = std::max( m_active, id);
+                        }
+                     }
+                  }
+               }
+
+               common::log::internal::queue << "blob store: " << m_base << "* - segments: " << m_segments.size() << " - threshold: " << m_settings.threshold << std::endl;
+            }
+
+            Store::~Store() = default;
+
+            bool Store::external( std::size_t size) const
+            {
+               return m_settings.threshold > 0 && size > m_settings.threshold;
+            }
+
+            Reference Store::write( const common::platform::binary_type& payload)
+            {
+               if( m_active == 0 || ( segment( m_active).size > 0 && segment( m_active).size + payload.size() > m_settings.segment))
+               {
+                  ++m_active;
+               }
+
+               auto& active = segment( m_active);
+
+               Reference result;
+               result.segment = m_active;
+               result.offset = active.size;
+               result.size = payload.size();
+
+               active.write( payload.data(), payload.size());
+               m_dirty.insert( m_active);
+
+               return result;
+            }
+
+            void Store::read( const Reference& reference, common::platform::binary_type& payload)
+            {
+               auto found = m_segments.find( reference.segment);
+
+               if( found == std::end( m_segments))
+               {
+                  throw common::exception::invalid::File{ "blob segment missing: " + path( reference.segment)};
+               }
+
+               auto& segment = *found->second;
+
+               if( reference.offset + reference.size > segment.size)
+               {
+                  throw common::exception::invalid::File{ "blob reference out of range: " + segment.path};
+               }
+
+               auto data = segment.map( reference.offset + reference.size) + reference.offset;
+               payload.assign( data, data + reference.size);
+            }
+
+            void Store::sync()
+            {
+               for( auto id : m_dirty)
+               {
+                  auto found = m_segments.find( id);
+
+                  if( found != std::end( m_segments) && ::fdatasync( found->second->descriptor) == -1)
+                  {
+                     throw common::exception::invalid::File{ "failed to sync blob segment: " + found->second->path + " - " + common::error::string()};
+                  }
+               }
+               m_dirty.clear();
+            }
+
+            std::map< std::size_t, std::size_t> Store::segments() const
+            {
+               std::map< std::size_t, std::size_t> result;
+
+               for( auto& segment : m_segments)
+               {
+                  result.emplace( segment.first, segment.second->size);
+               }
+               return result;
+            }
+
+            void Store::remove( std::size_t segment)
+            {
+               auto found = m_segments.find( segment);
+
+               if( found != std::end( m_segments))
+               {
+                  auto path = found->second->path;
+
+                  m_dirty.erase( segment);
+                  m_segments.erase( found);
+
+                  common::file::remove( path);
+
+                  common::log::internal::queue << "blob segment removed: " << path << std::endl;
+               }
+            }
+
+            std::string Store::path( std::size_t segment) const
+            {
+               return m_base + std::to_string( segment);
+            }
+
+            Store::Segment& Store::segment( std::size_t segment)
+            {
+               auto found = m_segments.find( segment);
+
+               if( found == std::end( m_segments))
+               {
+                  found = m_segments.emplace( segment, std::unique_ptr< Segment>{ new Segment{ path( segment)}}).first;
+               }
+               return *found->second;
+            }
+
+         } // blob
+      } // group
+   } // queue
+} // casual
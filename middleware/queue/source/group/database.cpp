@@ -10,6 +10,7 @@
 #include "common/algorithm.h"
 
 #include "common/exception.h"
+#include "common/error.h"
 #include "common/internal/log.h"
 #include "common/internal/trace.h"
 
@@ -37,11 +38,13 @@ namespace casual
                   struct Reply
                   {
 
-                     std::tuple< std::int64_t, common::message::queue::dequeue::Reply::Message> operator () ( sql::database::Row& row) const
+                     using result_type = std::tuple< std::int64_t, common::message::queue::dequeue::Reply::Message, blob::Reference>;
+
+                     result_type operator () ( sql::database::Row& row) const
                      {
 
-                        // SELECT ROWID, id, properties, reply, redelivered, type, avalible, timestamp, payload
-                        std::tuple< std::int64_t, common::message::queue::dequeue::Reply::Message> result;
+                        // SELECT ROWID, id, properties, reply, redelivered, type, avalible, timestamp, payload, segment, offset, size
+                        result_type result;
                         row.get( 0, std::get< 0>( result));
 
                         row.get( 1, std::get< 1>( result).id.get());
@@ -55,6 +58,13 @@ namespace casual
                         std::get< 1>( result).timestamp = common::platform::time_point{ std::chrono::microseconds{ row.get< common::platform::time_point::rep>( 8)}};
                         row.get( 9, std::get< 1>( result).payload);
 
+                        //
+                        // null (0) if the payload is inline
+                        //
+                        row.get( 10, std::get< 2>( result).segment);
+                        row.get( 11, std::get< 2>( result).offset);
+                        row.get( 12, std::get< 2>( result).size);
+
                         return result;
                      }
 
@@ -82,26 +92,119 @@ namespace casual
                } // transform
 
 
+               namespace durability
+               {
+                  const char* name( Durability::Journal journal)
+                  {
+                     switch( journal)
+                     {
+                        case Durability::Journal::wal: return "wal";
+                        default: return "rollback";
+                     }
+                  }
+
+                  const char* name( Durability::Synchronous synchronous)
+                  {
+                     switch( synchronous)
+                     {
+                        case Durability::Synchronous::off: return "OFF";
+                        case Durability::Synchronous::normal: return "NORMAL";
+                        default: return "FULL";
+                     }
+                  }
+
+                  //!
+                  //! pragmas that reports a value has to be stepped as a query, execute
+                  //! expects no rows
+                  //!
+                  std::string pragma( sql::database::Connection& connection, const std::string& statement)
+                  {
+                     std::string result;
+
+                     auto query = connection.query( statement);
+
+                     sql::database::Row row;
+
+                     if( query.fetch( row))
+                     {
+                        row.get( 0, result);
+                     }
+                     return result;
+                  }
+
+                  void apply( sql::database::Connection& connection, const Durability& durability)
+                  {
+                     if( durability.journal == Durability::Journal::wal)
+                     {
+                        //
+                        // in-memory databases can't use wal, sqlite reports the mode it actually uses
+                        //
+                        auto mode = pragma( connection, "PRAGMA journal_mode = WAL;");
+
+                        if( mode != "wal")
+                        {
+                           common::log::internal::queue << "journal_mode wal not applicable - using: " << mode << std::endl;
+                        }
+                        else if( durability.checkpoint > 0)
+                        {
+                           //
+                           // The group does the checkpoints, outside the write transactions
+                           //
+                           pragma( connection, "PRAGMA wal_autocheckpoint = 0;");
+                        }
+                     }
+                     else
+                     {
+                        //
+                        // wal is persistent in the database file, hence we have to set rollback explicitly
+                        //
+                        auto mode = pragma( connection, "PRAGMA journal_mode = DELETE;");
+
+                        if( mode != "delete")
+                        {
+                           common::log::internal::queue << "journal_mode rollback not applicable - using: " << mode << std::endl;
+                        }
+                     }
+
+                     connection.execute( std::string{ "PRAGMA synchronous = "} + name( durability.synchronous) + ";");
+
+                     if( durability.cache > 0)
+                     {
+                        //
+                        // negative value is interpreted as KiB
+                        //
+                        connection.execute( "PRAGMA cache_size = -" + std::to_string( durability.cache) + ";");
+                     }
+                  }
+               } // durability
+
             } // <unnamed>
          } // local
 
+         std::ostream& operator << ( std::ostream& out, const Durability& value)
+         {
+            return out << "{ journal: " << local::durability::name( value.journal)
+                  << ", synchronous: " << local::durability::name( value.synchronous)
+                  << ", cache: " << value.cache
+                  << ", checkpoint: " << value.checkpoint
+                  << '}';
+         }
 
 
-
-         Database::Database( const std::string& database, std::string groupname) : m_connection( database)
+         Database::Database( const std::string& database, std::string groupname, Durability durability, blob::Settings blob)
+            : m_connection( database), m_durability( std::move( durability)), m_blob( database, std::move( blob))
          {
 
             common::trace::internal::Scope trace{ "Database::Database", common::log::internal::queue};
 
+            common::log::internal::queue << "durability: " << m_durability << std::endl;
+
             //
             // Make sure we got FK
             //
             m_connection.execute( "PRAGMA foreign_keys = ON;");
 
-            //
-            // We can't set WAL mode, for some reason...
-            //
-            //m_connection.execute( "PRAGMA journal_mode=WAL;");
+            local::durability::apply( m_connection, m_durability);
 
             m_connection.execute(
                 R"( CREATE TABLE IF NOT EXISTS queue 
@@ -139,6 +242,20 @@ namespace casual
                   payload       BLOB,
                   FOREIGN KEY (queue) REFERENCES queue( id)); )");
 
+            //
+            // Payloads that are stored in the blob segments, the row is the reference count
+            // of the blob
+            //
+            m_connection.execute(
+                R"( CREATE TABLE IF NOT EXISTS blob
+                ( message       BLOB PRIMARY KEY,
+                  segment       INTEGER NOT NULL,
+                  offset        INTEGER NOT NULL,
+                  size          INTEGER NOT NULL); )");
+
+            m_connection.execute(
+                  "CREATE INDEX IF NOT EXISTS i_segment_blob ON blob ( segment);" );
+
             m_connection.execute(
                   "CREATE INDEX IF NOT EXISTS i_id_message  ON message ( id);" );
 
@@ -175,65 +292,24 @@ namespace casual
             // Triggers
             //
 
-            m_connection.execute( R"(
-               CREATE TRIGGER IF NOT EXISTS insert_message INSERT ON message 
-               BEGIN
-                  UPDATE queue SET
-                     timestamp = new.timestamp,
-                     uncommitted_count = uncommitted_count + 1
-                  WHERE id = new.queue AND new.state = 1;
-
-                 UPDATE queue SET
-                     timestamp = new.timestamp,
-                     count = count + 1,
-                     size = size + length( new.payload)
-                  WHERE id = new.queue AND new.state = 2;
-
-               END;
-
-               )");
-
-            m_connection.execute( R"(
-               CREATE TRIGGER IF NOT EXISTS update_message_state UPDATE OF state ON message 
-               BEGIN
-                  UPDATE queue SET
-                     count = count + 1,
-                     size = size + length( new.payload),
-                     uncommitted_count = uncommitted_count - 1
-                  WHERE id = new.queue AND old.state = 1 AND new.state = 2;
-               END;
-
-               )");
-
-            m_connection.execute( R"(
-               CREATE TRIGGER IF NOT EXISTS update_message_queue UPDATE OF queue ON message 
-               BEGIN
-
-                  UPDATE queue SET  -- 'queue move' update the new queue
-                     count = count + 1,
-                     size = size + length( new.payload)
-                  WHERE id = new.queue AND new.queue != old.queue;
-
-                  UPDATE queue SET  -- 'queue move' update the old queue
-                     count = count - 1,
-                     size = size - length( old.payload)
-                  WHERE id = old.queue AND old.queue != new.queue;
-
-               END;
-
-               )");
+            //
+            // The triggers are recreated every time, so an existing queuebase gets the current ones.
+            //
+            // count, size and uncommitted for the queues are kept in memory, see Database::flush, hence
+            // we drop the triggers that updated the queue table for every message
+            //
+            m_connection.execute( "DROP TRIGGER IF EXISTS insert_message;");
+            m_connection.execute( "DROP TRIGGER IF EXISTS update_message_state;");
+            m_connection.execute( "DROP TRIGGER IF EXISTS update_message_queue;");
+            m_connection.execute( "DROP TRIGGER IF EXISTS delete_message;");
 
+            //
+            // The blob row is inserted before, and deleted after, the message row.
+            //
             m_connection.execute( R"(
-               CREATE TRIGGER IF NOT EXISTS delete_message DELETE ON message 
+               CREATE TRIGGER delete_message DELETE ON message 
                BEGIN
-                  UPDATE queue SET 
-                     count = count - 1,
-                     size = size - length( old.payload)
-                  WHERE id = old.queue AND old.state IN ( 2, 3);
-
-                  UPDATE queue SET 
-                      uncommitted_count = uncommitted_count - 1
-                  WHERE id = old.queue AND old.state = 1;
+                  DELETE FROM blob WHERE message = old.id;
                END;
 
                )");
@@ -244,30 +320,45 @@ namespace casual
             {
                m_statement.enqueue = m_connection.precompile( "INSERT INTO message VALUES (?,?,?,?,?,?,?,?,?,?,?,?,?);");
 
+               m_statement.blob.insert = m_connection.precompile( "INSERT INTO blob VALUES ( :message, :segment, :offset, :size);");
+               m_statement.blob.remove = m_connection.precompile( "DELETE FROM blob WHERE message = :message;");
+               m_statement.blob.segments = m_connection.precompile( "SELECT segment, count( *), sum( size) FROM blob GROUP BY segment;");
+               m_statement.blob.references = m_connection.precompile( "SELECT message, offset, size FROM blob WHERE segment = :segment;");
+               m_statement.blob.move = m_connection.precompile( "UPDATE blob SET segment = :segment, offset = :offset WHERE message = :message;");
+
                m_statement.dequeue.first = m_connection.precompile( R"( 
                      SELECT 
-                        ROWID, id, properties, reply, redelivered, type, subtype, avalible, timestamp, payload
+                        m.ROWID, m.id, m.properties, m.reply, m.redelivered, m.type, m.subtype, m.avalible, m.timestamp, m.payload, b.segment, b.offset, b.size
                      FROM 
-                        message 
-                     WHERE queue = :queue AND state = 2 AND ( avalible is NULL OR avalible < :avalible) ORDER BY timestamp ASC LIMIT 1; )");
+                        message m LEFT JOIN blob b ON b.message = m.id
+                     WHERE m.queue = :queue AND m.state = 2 AND ( m.avalible is NULL OR m.avalible < :avalible) ORDER BY m.timestamp ASC LIMIT 1; )");
 
                m_statement.dequeue.first_id = m_connection.precompile( R"( 
                      SELECT 
-                        ROWID, id, properties, reply, redelivered, type, subtype, avalible, timestamp, payload
+                        m.ROWID, m.id, m.properties, m.reply, m.redelivered, m.type, m.subtype, m.avalible, m.timestamp, m.payload, b.segment, b.offset, b.size
+                     FROM 
+                        message m LEFT JOIN blob b ON b.message = m.id
+                     WHERE m.id = :id AND m.queue = :queue AND m.state = 2 AND ( m.avalible is NULL OR m.avalible < :avalible); )");
+
+               m_statement.dequeue.available = m_connection.precompile( R"( 
+                     SELECT 
+                        m.ROWID, m.id, m.properties, m.reply, m.redelivered, m.type, m.subtype, m.avalible, m.timestamp, m.payload, b.segment, b.offset, b.size
                      FROM 
-                        message 
-                     WHERE id = :id AND queue = :queue AND state = 2 AND ( avalible is NULL OR avalible < :avalible); )");
+                        message m LEFT JOIN blob b ON b.message = m.id
+                     WHERE m.queue = :queue AND m.state = 2 AND ( m.avalible is NULL OR m.avalible < :avalible) ORDER BY m.timestamp ASC LIMIT :limit; )");
 
                m_statement.dequeue.first_match = m_connection.precompile( R"( 
                      SELECT 
-                        ROWID, id, properties, reply, redelivered, type, subtype, avalible, timestamp, payload
+                        m.ROWID, m.id, m.properties, m.reply, m.redelivered, m.type, m.subtype, m.avalible, m.timestamp, m.payload, b.segment, b.offset, b.size
                      FROM 
-                        message 
-                     WHERE queue = :queue AND state = 2 AND properties = :properties AND ( avalible is NULL OR avalible < :avalible) ORDER BY timestamp ASC LIMIT 1; )");
+                        message m LEFT JOIN blob b ON b.message = m.id
+                     WHERE m.queue = :queue AND m.state = 2 AND m.properties = :properties AND ( m.avalible is NULL OR m.avalible < :avalible) ORDER BY m.timestamp ASC LIMIT 1; )");
 
 
                m_statement.state.xid =  m_connection.precompile( "UPDATE message SET gtrid = :gtrid, state = 3 WHERE ROWID = :id");
                m_statement.state.nullxid = m_connection.precompile( "DELETE FROM message WHERE ROWID = :id");
+               m_statement.state.broken = m_connection.precompile(
+                     "UPDATE message SET state = 5, queue = ( SELECT error FROM queue WHERE ROWID = message.queue) WHERE ROWID = :id");
 
 
                m_statement.commit1 = m_connection.precompile( "UPDATE message SET state = 2 WHERE gtrid = :gtrid AND state = 1;");
@@ -332,13 +423,55 @@ namespace casual
                 */
                m_statement.information.message = m_connection.precompile( R"(
                   SELECT
-                     m.id, m.queue, m.origin, m.gtrid, m.state, m.reply, m.redelivered, m.type, m.subtype, m.avalible, m.timestamp, length( m.payload)
+                     m.id, m.queue, m.origin, m.gtrid, m.state, m.reply, m.redelivered, m.type, m.subtype, m.avalible, m.timestamp,
+                     ifnull( length( m.payload), 0) + ifnull( b.size, 0)
                   FROM
-                     message m
+                     message m LEFT JOIN blob b ON b.message = m.id
                   WHERE
                      m.queue = ?
                 )");
 
+               m_statement.counter.transaction = m_connection.precompile( R"(
+                  SELECT
+                     m.queue, m.state, count( *), sum( ifnull( length( m.payload), 0) + ifnull( b.size, 0))
+                  FROM
+                     message m LEFT JOIN blob b ON b.message = m.id
+                  WHERE
+                     m.gtrid = :gtrid
+                  GROUP BY m.queue, m.state;
+                )");
+
+               m_statement.counter.moved = m_connection.precompile( R"(
+                  SELECT
+                     m.queue, q.error, count( *), sum( ifnull( length( m.payload), 0) + ifnull( b.size, 0))
+                  FROM
+                     message m JOIN queue q ON q.id = m.queue LEFT JOIN blob b ON b.message = m.id
+                  WHERE
+                     m.redelivered > q.retries
+                  GROUP BY m.queue, q.error;
+                )");
+
+               m_statement.counter.flush = m_connection.precompile(
+                     "UPDATE queue SET count = :count, size = :size, uncommitted_count = :uncommitted, timestamp = :timestamp WHERE id = :id;");
+            }
+
+            counters();
+         }
+
+         Database::~Database()
+         {
+            try
+            {
+               if( ! m_dirty.empty())
+               {
+                  begin();
+                  flush();
+                  commit();
+               }
+            }
+            catch( ...)
+            {
+               common::error::handler();
             }
          }
 
@@ -379,6 +512,9 @@ namespace casual
             queue.id = m_connection.rowid();
             queue.type = Queue::cQueue;
 
+            m_counters[ queue.error].timestamp = now;
+            m_counters[ queue.id].timestamp = now;
+
             common::log::internal::queue << "queue: " << queue << std::endl;
 
             return queue;
@@ -407,6 +543,12 @@ namespace casual
             {
                m_connection.execute( "DELETE FROM queue WHERE id = :id;", existing.front().error);
                m_connection.execute( "DELETE FROM queue WHERE id = :id;", existing.front().id);
+
+               for( auto queue : { existing.front().error, existing.front().id})
+               {
+                  m_counters.erase( queue);
+                  m_dirty.erase( queue);
+               }
             }
          }
 
@@ -453,35 +595,114 @@ namespace casual
 
             common::message::queue::enqueue::Reply reply;
 
+            reply.id = enqueue( message.trid, message.queue, message.message);
+
+            return reply;
+         }
+
+         common::message::queue::enqueue::batch::Reply Database::enqueue( const common::message::queue::enqueue::batch::Request& message)
+         {
+            common::trace::internal::Scope trace{ "queue::Database::enqueue batch", common::log::internal::queue};
+
+            common::log::internal::queue << "request: " << message << std::endl;
+
+            common::message::queue::enqueue::batch::Reply reply;
+            reply.ids.reserve( message.messages.size());
+
+            //
+            // The batch is atomic within the surrounding (write) transaction
+            //
+            auto counter = m_counters[ message.queue];
+            m_connection.execute( "SAVEPOINT batch;");
+
+            try
+            {
+               for( auto& m : message.messages)
+               {
+                  reply.ids.push_back( enqueue( message.trid, message.queue, m));
+               }
+            }
+            catch( ...)
+            {
+               m_connection.execute( "ROLLBACK TO SAVEPOINT batch;");
+               m_connection.execute( "RELEASE SAVEPOINT batch;");
+               m_counters[ message.queue] = counter;
+               throw;
+            }
+
+            m_connection.execute( "RELEASE SAVEPOINT batch;");
+
+            return reply;
+         }
+
+         common::Uuid Database::enqueue( const common::transaction::ID& trid, Queue::id_type queue, const common::message::queue::base_message& message)
+         {
             //
             // We create a unique id if none is provided.
             //
-            reply.id = message.message.id ? message.message.id : common::uuid::make();
+            auto id = message.id ? message.id : common::uuid::make();
 
+            auto gtrid = common::transaction::global( trid);
 
+            long state = trid ? message::State::added : message::State::enqueued;
 
+            auto now = common::platform::clock_type::now();
 
-            auto gtrid = common::transaction::global( message.trid);
+            auto insert = [&]( const common::platform::binary_type& payload){
+               m_statement.enqueue.execute(
+                     id.get(),
+                     queue,
+                     queue,
+                     gtrid,
+                     message.properties,
+                     state,
+                     message.reply,
+                     0,
+                     message.type.name,
+                     message.type.subname,
+                     message.avalible,
+                     now,
+                     payload);
+            };
+
+            if( m_blob.external( message.payload.size()))
+            {
+               //
+               // The blob row goes in first, the delete trigger removes it with the message
+               //
+               auto reference = m_blob.write( message.payload);
+               m_statement.blob.insert.execute( id.get(), reference.segment, reference.offset, reference.size);
 
-            long state = message.trid ? message::State::added : message::State::enqueued;
+               try
+               {
+                  insert( {});
+               }
+               catch( ...)
+               {
+                  m_statement.blob.remove.execute( id.get());
+                  throw;
+               }
+            }
+            else
+            {
+               insert( message.payload);
+            }
 
+            auto& counter = m_counters[ queue];
 
-            m_statement.enqueue.execute(
-                  reply.id.get(),
-                  message.queue,
-                  message.queue,
-                  gtrid,
-                  message.message.properties,
-                  state,
-                  message.message.reply,
-                  0,
-                  message.message.type.name,
-                  message.message.type.subname,
-                  message.message.avalible,
-                  common::platform::clock_type::now(),
-                  message.message.payload);
+            if( trid)
+            {
+               ++counter.uncommitted;
+            }
+            else
+            {
+               ++counter.count;
+               counter.size += message.payload.size();
+            }
+            counter.timestamp = now;
+            m_dirty.insert( queue);
 
-            return reply;
+            return id;
          }
 
 
@@ -510,41 +731,228 @@ namespace casual
                return m_statement.dequeue.first.query( message.queue, now);
             };
 
-            auto resultset = query();
+            //
+            // There can only be one message with a specific id
+            //
+            auto count = message.selector.id ? 1 : std::max( message.count, std::size_t{ 1});
 
-            sql::database::Row row;
+            //
+            // All or nothing, same as batch enqueue
+            //
+            auto counter = m_counters[ message.queue];
+            m_connection.execute( "SAVEPOINT dequeue;");
+
+            try
+            {
+               while( reply.message.size() < count)
+               {
+                  auto resultset = query();
+
+                  sql::database::Row row;
+
+                  if( ! resultset.fetch( row))
+                  {
+                     common::log::internal::queue << "dequeue - qid: " << message.queue << " - no message" << std::endl;
+                     break;
+                  }
+
+                  auto result = local::transform::Reply()( row);
+
+                  //
+                  // Update state, hence the next query will not find this message
+                  //
+                  try
+                  {
+                     dequeued( message.queue, std::get< 0>( result), message.trid, std::get< 2>( result), std::get< 1>( result));
+                  }
+                  catch( const common::exception::invalid::File&)
+                  {
+                     //
+                     // The message with the broken blob is moved out of the way, otherwise
+                     // it would be the head of the queue forever
+                     //
+                     common::error::handler();
+                     broken( message.queue, std::get< 0>( result), std::get< 2>( result));
+                     continue;
+                  }
+
+                  reply.message.push_back( std::move( std::get< 1>( result)));
+               }
+            }
+            catch( ...)
+            {
+               m_connection.execute( "ROLLBACK TO SAVEPOINT dequeue;");
+               m_connection.execute( "RELEASE SAVEPOINT dequeue;");
+               m_counters[ message.queue] = counter;
+               throw;
+            }
+
+            m_connection.execute( "RELEASE SAVEPOINT dequeue;");
+
+            return reply;
+         }
+
+         std::vector< common::message::queue::dequeue::Reply> Database::dequeue( Queue::id_type queue, const std::vector< common::message::queue::dequeue::Request>& requests)
+         {
+            common::trace::internal::Scope trace{ "queue::Database::dequeue batch", common::log::internal::queue};
+
+            std::vector< common::message::queue::dequeue::Reply> replies;
+
+            std::size_t total = 0;
+            for( auto& request : requests)
+            {
+               total += std::max( request.count, std::size_t{ 1});
+            }
+
+            auto now = std::chrono::time_point_cast< std::chrono::microseconds>(
+                  common::platform::clock_type::now()).time_since_epoch().count();
+
+            //
+            // One read for all requests
+            //
+            std::vector< local::transform::Reply::result_type> available;
+            {
+               auto resultset = m_statement.dequeue.available.query( queue, now, total);
 
-            if( ! resultset.fetch( row))
+               sql::database::Row row;
+
+               while( resultset.fetch( row))
+               {
+                  available.push_back( local::transform::Reply()( row));
+               }
+            }
+
+            common::log::internal::queue << "dequeue - qid: " << queue << " requests: " << requests.size() << " available: " << available.size() << std::endl;
+
+            auto result = std::begin( available);
+
+            //
+            // All or nothing, same as single dequeue
+            //
+            auto counter = m_counters[ queue];
+            m_connection.execute( "SAVEPOINT dequeue;");
+
+            try
             {
-               common::log::internal::queue << "dequeue - qid: " << message.queue << " - no message" << std::endl;
+               for( auto& request : requests)
+               {
+                  if( result == std::end( available))
+                  {
+                     break;
+                  }
+
+                  common::message::queue::dequeue::Reply reply;
+
+                  auto count = std::max( request.count, std::size_t{ 1});
 
-               return reply;
+                  while( reply.message.size() < count && result != std::end( available))
+                  {
+                     try
+                     {
+                        dequeued( queue, std::get< 0>( *result), request.trid, std::get< 2>( *result), std::get< 1>( *result));
+                     }
+                     catch( const common::exception::invalid::File&)
+                     {
+                        //
+                        // Same as single dequeue, the broken message is moved out of the way
+                        //
+                        common::error::handler();
+                        broken( queue, std::get< 0>( *result), std::get< 2>( *result));
+                        ++result;
+                        continue;
+                     }
+                     reply.message.push_back( std::move( std::get< 1>( *result)));
+                     ++result;
+                  }
+
+                  if( reply.message.empty())
+                  {
+                     //
+                     // The rest was broken, this and the following requests get nothing
+                     //
+                     break;
+                  }
+                  replies.push_back( std::move( reply));
+               }
             }
+            catch( ...)
+            {
+               m_connection.execute( "ROLLBACK TO SAVEPOINT dequeue;");
+               m_connection.execute( "RELEASE SAVEPOINT dequeue;");
+               m_counters[ queue] = counter;
+               throw;
+            }
+
+            m_connection.execute( "RELEASE SAVEPOINT dequeue;");
 
-            auto result = local::transform::Reply()( row);
+            return replies;
+         }
 
+         void Database::dequeued( Queue::id_type queue, std::int64_t row, const common::transaction::ID& trid, const blob::Reference& reference,
+               common::message::queue::dequeue::Reply::Message& message)
+         {
             //
-            // Update state
+            // Read the payload first, a missing or short segment shall not leave
+            // the message updated
             //
-            if( message.trid)
+            if( reference)
             {
-               auto gtrid = common::transaction::global(  message.trid);
+               m_blob.read( reference, message.payload);
+            }
 
-               m_statement.state.xid.execute( gtrid, std::get< 0>( result));
+            if( trid)
+            {
+               m_statement.state.xid.execute( common::transaction::global( trid), row);
             }
             else
             {
-               m_statement.state.nullxid.execute( std::get< 0>( result));
+               m_statement.state.nullxid.execute( row);
             }
 
-            common::log::internal::queue << "dequeue - qid: " << message.queue << " id: " << std::get< 1>( result).id << " size: " << std::get< 1>( result).payload.size() << " trid: " << message.trid << std::endl;
+            if( ! trid)
+            {
+               auto& counter = m_counters[ queue];
+               --counter.count;
+               counter.size -= message.payload.size();
+               m_dirty.insert( queue);
+            }
 
-            reply.message.push_back( std::move( std::get< 1>( result)));
+            common::log::internal::queue << "dequeue - id: " << message.id << " size: " << message.payload.size() << " trid: " << trid << std::endl;
+         }
 
-            return reply;
+
+         void Database::broken( Queue::id_type queue, std::int64_t row, const blob::Reference& reference)
+         {
+            m_statement.state.broken.execute( row);
+
+            //
+            // Broken messages are not counted in any queue
+            //
+            auto& counter = m_counters[ queue];
+            --counter.count;
+            counter.size -= reference.size;
+            m_dirty.insert( queue);
+
+            common::log::error << "queue: " << queue << " - message moved to error queue, blob can't be read - segment: "
+                  << reference.segment << " offset: " << reference.offset << " size: " << reference.size << std::endl;
          }
 
 
+         template< typename F>
+         void Database::transaction( const common::transaction::xid_range_type& gtrid, F&& functor)
+         {
+            auto query = m_statement.counter.transaction.query( gtrid);
+            sql::database::Row row;
+
+            while( query.fetch( row))
+            {
+               auto queue = row.get< Queue::id_type>( 0);
+
+               functor( m_counters[ queue], row.get< long>( 1), row.get< std::size_t>( 2), row.get< std::size_t>( 3));
+               m_dirty.insert( queue);
+            }
+         }
+
          void Database::commit( const common::transaction::ID& id)
          {
             common::trace::internal::Scope trace{ "queue::Database::commit", common::log::internal::queue};
@@ -553,6 +961,22 @@ namespace casual
 
             auto gtrid = common::transaction::global( id);
 
+            transaction( gtrid, []( Counter& counter, long state, std::size_t count, std::size_t size){
+               if( state == message::State::added)
+               {
+                  // 1 -> 2
+                  counter.uncommitted -= count;
+                  counter.count += count;
+                  counter.size += size;
+               }
+               else if( state == message::State::removed)
+               {
+                  // 3 -> deleted
+                  counter.count -= count;
+                  counter.size -= size;
+               }
+            });
+
             m_statement.commit1.execute( gtrid);
             m_statement.commit2.execute( gtrid);
          }
@@ -566,8 +990,44 @@ namespace casual
 
             auto gtrid = common::transaction::global( id);
 
+            transaction( gtrid, []( Counter& counter, long state, std::size_t count, std::size_t size){
+               if( state == message::State::added)
+               {
+                  // 1 -> deleted, 3 -> 2 does not affect the counters
+                  counter.uncommitted -= count;
+               }
+            });
+
             m_statement.rollback1.execute( gtrid);
             m_statement.rollback2.execute( gtrid);
+
+            //
+            // Messages that exceeded retries are moved to the error queue
+            //
+            {
+               auto query = m_statement.counter.moved.query();
+               sql::database::Row row;
+
+               while( query.fetch( row))
+               {
+                  auto from = row.get< Queue::id_type>( 0);
+                  auto to = row.get< Queue::id_type>( 1);
+                  auto count = row.get< std::size_t>( 2);
+                  auto size = row.get< std::size_t>( 3);
+
+                  auto& source = m_counters[ from];
+                  source.count -= count;
+                  source.size -= size;
+
+                  auto& error = m_counters[ to];
+                  error.count += count;
+                  error.size += size;
+
+                  m_dirty.insert( from);
+                  m_dirty.insert( to);
+               }
+            }
+
             m_statement.rollback3.execute();
          }
 
@@ -622,10 +1082,22 @@ namespace casual
                row.get( 2, queue.retries);
                row.get( 3, queue.error);
                row.get( 4, queue.type);
-               row.get( 5, queue.count);
-               row.get( 6, queue.size);
-               row.get( 7, queue.uncommitted);
-               row.get( 8, queue.timestamp);
+               auto found = m_counters.find( queue.id);
+
+               if( found != std::end( m_counters))
+               {
+                  queue.count = found->second.count;
+                  queue.size = found->second.size;
+                  queue.uncommitted = found->second.uncommitted;
+                  queue.timestamp = found->second.timestamp;
+               }
+               else
+               {
+                  row.get( 5, queue.count);
+                  row.get( 6, queue.size);
+                  row.get( 7, queue.uncommitted);
+                  row.get( 8, queue.timestamp);
+               }
 
                result.push_back( std::move( queue));
             }
@@ -674,8 +1146,214 @@ namespace casual
 
 
          void Database::begin() { m_connection.exclusive_begin();}
-         void Database::commit() { m_connection.commit();}
-         void Database::rollback() { m_connection.rollback();}
+         void Database::commit()
+         {
+            //
+            // The blobs has to be durable before the rows that refer to them
+            //
+            if( m_durability.synchronous != Durability::Synchronous::off)
+            {
+               m_blob.sync();
+            }
+            m_connection.commit();
+         }
+
+         void Database::checkpoint()
+         {
+            if( m_durability.journal == Durability::Journal::wal)
+            {
+               common::trace::internal::Scope trace{ "queue::Database::checkpoint", common::log::internal::queue};
+
+               local::durability::pragma( m_connection, "PRAGMA wal_checkpoint( PASSIVE);");
+            }
+         }
+         void Database::rollback()
+         {
+            m_connection.rollback();
+
+            //
+            // The counters could have changes that never made it, we start over
+            //
+            counters();
+         }
+
+         void Database::flush()
+         {
+            if( m_dirty.empty())
+            {
+               return;
+            }
+
+            common::trace::internal::Scope trace{ "queue::Database::flush", common::log::internal::queue};
+
+            for( auto queue : m_dirty)
+            {
+               auto found = m_counters.find( queue);
+
+               if( found != std::end( m_counters))
+               {
+                  auto& counter = found->second;
+                  m_statement.counter.flush.execute( counter.count, counter.size, counter.uncommitted, counter.timestamp, queue);
+               }
+            }
+
+            common::log::internal::queue << "flushed counters for queues: " << m_dirty.size() << std::endl;
+
+            m_dirty.clear();
+         }
+
+         void Database::counters()
+         {
+            common::trace::internal::Scope trace{ "queue::Database::counters", common::log::internal::queue};
+
+            m_counters.clear();
+            m_dirty.clear();
+
+            {
+               auto query = m_connection.query( "SELECT id, timestamp FROM queue;");
+               sql::database::Row row;
+
+               while( query.fetch( row))
+               {
+                  row.get( 1, m_counters[ row.get< Queue::id_type>( 0)].timestamp);
+               }
+            }
+
+            auto query = m_connection.query( R"(
+               SELECT
+                  m.queue,
+                  sum( m.state IN ( 2, 3)),
+                  sum( CASE WHEN m.state IN ( 2, 3) THEN ifnull( length( m.payload), 0) + ifnull( b.size, 0) ELSE 0 END),
+                  sum( m.state = 1),
+                  max( m.timestamp)
+               FROM
+                  message m LEFT JOIN blob b ON b.message = m.id
+               GROUP BY m.queue;
+               )");
+
+            sql::database::Row row;
+
+            while( query.fetch( row))
+            {
+               auto& counter = m_counters[ row.get< Queue::id_type>( 0)];
+
+               row.get( 1, counter.count);
+               row.get( 2, counter.size);
+               row.get( 3, counter.uncommitted);
+               counter.timestamp = std::max( counter.timestamp, row.get< common::platform::time_point>( 4));
+            }
+
+            common::log::internal::queue << "counters rebuilt for queues: " << m_counters.size() << std::endl;
+         }
+
+
+         void Database::compact()
+         {
+            auto segments = m_blob.segments();
+
+            if( segments.empty())
+            {
+               return;
+            }
+
+            common::trace::internal::Scope trace{ "queue::Database::compact", common::log::internal::queue};
+
+            //
+            // live references and bytes per segment
+            //
+            std::map< std::size_t, std::tuple< std::size_t, std::size_t>> live;
+            {
+               auto query = m_statement.blob.segments.query();
+               sql::database::Row row;
+
+               while( query.fetch( row))
+               {
+                  auto& value = live[ row.get< std::size_t>( 0)];
+                  row.get( 1, std::get< 0>( value));
+                  row.get( 2, std::get< 1>( value));
+               }
+            }
+
+            std::vector< std::size_t> removable;
+            std::vector< std::size_t> compactable;
+
+            for( auto& segment : segments)
+            {
+               if( segment.first == m_blob.active())
+               {
+                  continue;
+               }
+
+               auto found = live.find( segment.first);
+
+               if( found == std::end( live))
+               {
+                  removable.push_back( segment.first);
+               }
+               else if( std::get< 1>( found->second) * 2 < segment.second)
+               {
+                  //
+                  // less than half of the segment is alive
+                  //
+                  compactable.push_back( segment.first);
+               }
+            }
+
+            if( ! compactable.empty())
+            {
+               begin();
+
+               try
+               {
+                  for( auto segment : compactable)
+                  {
+                     std::vector< std::tuple< common::Uuid, blob::Reference>> references;
+                     {
+                        auto query = m_statement.blob.references.query( segment);
+                        sql::database::Row row;
+
+                        while( query.fetch( row))
+                        {
+                           std::tuple< common::Uuid, blob::Reference> value;
+                           row.get( 0, std::get< 0>( value).get());
+                           std::get< 1>( value).segment = segment;
+                           row.get( 1, std::get< 1>( value).offset);
+                           row.get( 2, std::get< 1>( value).size);
+                           references.push_back( std::move( value));
+                        }
+                     }
+
+                     common::platform::binary_type payload;
+
+                     for( auto& reference : references)
+                     {
+                        m_blob.read( std::get< 1>( reference), payload);
+                        auto moved = m_blob.write( payload);
+                        m_statement.blob.move.execute( moved.segment, moved.offset, std::get< 0>( reference).get());
+                     }
+
+                     common::log::internal::queue << "blob segment: " << segment << " - moved: " << references.size() << std::endl;
+                  }
+               }
+               catch( ...)
+               {
+                  rollback();
+                  throw;
+               }
+
+               commit();
+
+               //
+               // The references are durable in the new location, the old segments can go
+               //
+               common::range::copy( compactable, std::back_inserter( removable));
+            }
+
+            for( auto segment : removable)
+            {
+               m_blob.remove( segment);
+            }
+         }
 
 
       } // server
@@ -12,6 +12,7 @@
 
 #include "common/message/dispatch.h"
 #include "common/message/handle.h"
+#include "common/exception.h"
 
 
 namespace casual
@@ -22,27 +23,94 @@ namespace casual
       namespace group
       {
 
+         namespace local
+         {
+            namespace
+            {
+               namespace pending
+               {
+                  template< typename R, typename P>
+                  std::size_t take( std::deque< R>& requests, std::size_t count, P&& result)
+                  {
+                     count = std::min( count, requests.size());
+
+                     auto last = std::next( std::begin( requests), count);
+                     std::move( std::begin( requests), last, std::back_inserter( result));
+                     requests.erase( std::begin( requests), last);
+
+                     return count;
+                  }
+
+                  template< typename R, typename P>
+                  void erase( std::deque< R>& requests, P&& predicate)
+                  {
+                     requests.erase( std::remove_if( std::begin( requests), std::end( requests), predicate), std::end( requests));
+                  }
+
+                  template< typename P>
+                  void erase( State::Pending::Waiting& waiting, P&& predicate)
+                  {
+                     erase( waiting.any, predicate);
+                     erase( waiting.id, predicate);
+
+                     for( auto current = std::begin( waiting.properties); current != std::end( waiting.properties);)
+                     {
+                        erase( current->second, predicate);
+                        current = current->second.empty() ? waiting.properties.erase( current) : std::next( current);
+                     }
+                  }
+
+                  std::deque< State::Pending::request_type>& line( State::Pending::Waiting& waiting, const State::Pending::request_type& request)
+                  {
+                     if( request.selector.id)
+                     {
+                        return waiting.id;
+                     }
+                     if( ! request.selector.properties.empty())
+                     {
+                        return waiting.properties[ request.selector.properties];
+                     }
+                     return waiting.any;
+                  }
+
+               } // pending
+            } // <unnamed>
+         } // local
+
          void State::Pending::dequeue( const common::message::queue::dequeue::Request& request)
          {
             if( request.block)
             {
-               requests.push_back( request);
+               local::pending::line( requests[ request.queue], request).push_back( request);
             }
          }
 
-
-         void State::Pending::enqueue( const common::transaction::ID& trid, queue_id_type id)
+         void State::Pending::restore( std::vector< request_type> woken)
          {
-            auto found = common::range::find_if( requests, [&]( const request_type& r){
-               return r.queue == id;
-            });
+            //
+            // Reverse, so the requests keeps their order first in line
+            //
+            for( auto current = woken.rbegin(); current != woken.rend(); ++current)
+            {
+               local::pending::line( requests[ current->queue], *current).push_front( std::move( *current));
+            }
+         }
 
-            if( found)
+
+         void State::Pending::enqueue( const common::transaction::ID& trid, queue_id_type id, const std::string& properties)
+         {
+            if( requests.count( id) > 0)
             {
                //
                // Someone is waiting for messages in this queue
                //
-               transactions[ trid][ id]++;
+               auto& enqueued = transactions[ trid][ id];
+               ++enqueued.count;
+
+               if( ! properties.empty())
+               {
+                  ++enqueued.properties[ properties];
+               }
             }
          }
 
@@ -51,15 +119,30 @@ namespace casual
             common::message::queue::dequeue::forget::Reply reply;
             reply.correlation = request.correlation;
 
-            auto found = common::range::find_if( requests, [&]( const request_type& r){
-               return r.queue == request.queue && r.process == request.process;
-            });
+            auto found = requests.find( request.queue);
 
-            reply.found = static_cast< bool>( found);
-
-            if( found)
+            if( found != std::end( requests))
             {
-               requests.erase( std::begin( found));
+               auto& waiting = found->second;
+
+               auto predicate = [&]( const request_type& r){
+                  if( ! reply.found && r.process == request.process)
+                  {
+                     //
+                     // We only forget the first one
+                     //
+                     reply.found = true;
+                     return true;
+                  }
+                  return false;
+               };
+
+               local::pending::erase( waiting, predicate);
+
+               if( waiting.empty())
+               {
+                  requests.erase( found);
+               }
 
                if( requests.empty())
                {
@@ -74,26 +157,59 @@ namespace casual
          {
             result_t result;
 
-            auto found = common::range::find( transactions, trid);
+            auto found = transactions.find( trid);
+
+            if( found == std::end( transactions))
+            {
+               return result;
+            }
+
+            auto enqueued = std::move( found->second);
+            transactions.erase( found);
 
-            if( found)
+            for( auto& queue : enqueued)
             {
-               result.enqueued = std::move( found->second);
-               transactions.erase( std::begin( found));
+               auto waiting = requests.find( queue.first);
+
+               if( waiting == std::end( requests))
+               {
+                  continue;
+               }
 
                //
-               // Move all request that is interested in committed queues to the end.
-               // We use the second part of the partition directly
+               // One message can only satisfy one request, we wake the ones selecting on properties
+               // that matches the enqueued, and the ones without selector. A message that matches
+               // both could leave one of them without a message, and it's restored to pending.
                //
-               auto interested = std::get< 1>( common::range::stable_partition( requests, [&]( const request_type& r){
-                  return ! common::range::find( result.enqueued, r.queue);
-               }));
+               for( auto& properties : queue.second.properties)
+               {
+                  auto line = waiting->second.properties.find( properties.first);
+
+                  if( line != std::end( waiting->second.properties))
+                  {
+                     local::pending::take( line->second, properties.second, result.selective);
+
+                     if( line->second.empty())
+                     {
+                        waiting->second.properties.erase( line);
+                     }
+                  }
+               }
 
                //
-               // move the requests to the result, and erase them in pending
+               // We can't tell if a specific id was enqueued, so they always get to try
                //
-               common::range::move( interested, result.requests);
-               requests.erase( std::begin( interested), std::end( interested));
+               local::pending::take( waiting->second.id, waiting->second.id.size(), result.selective);
+
+               if( ! waiting->second.any.empty())
+               {
+                  local::pending::take( waiting->second.any, queue.second.count, result.any[ queue.first]);
+               }
+
+               if( waiting->second.empty())
+               {
+                  requests.erase( waiting);
+               }
             }
 
             return result;
@@ -106,11 +222,14 @@ namespace casual
 
          void State::Pending::erase( common::platform::pid_type pid)
          {
-            auto found = std::get< 1>( common::range::stable_partition( requests, [=]( const request_type& r){
-               return r.process.pid != pid;
-            }));
+            for( auto current = std::begin( requests); current != std::end( requests);)
+            {
+               local::pending::erase( current->second, [=]( const request_type& r){
+                  return r.process.pid == pid;
+               });
 
-            requests.erase( std::begin( found), std::end( found));
+               current = current->second.empty() ? requests.erase( current) : std::next( current);
+            }
          }
 
 
@@ -121,6 +240,7 @@ namespace casual
                common::message::dispatch::Handler handler{
                   handle::dead::Process{ state},
                   handle::enqueue::Request{ state},
+                  handle::enqueue::batch::Request{ state},
                   handle::dequeue::Request{ state},
                   handle::dequeue::forget::Request{ state},
                   handle::transaction::commit::Request{ state},
@@ -153,10 +273,15 @@ namespace casual
                      //
 
                      while( handler( ipc.non_blocking_next()) &&
-                           state.persistent.size() < common::platform::batch::transaction)
+                           state.persistent.size() < state.batch)
                      {
                         ;
                      }
+
+                     if( state.flush.transaction())
+                     {
+                        state.queuebase.flush();
+                     }
                   }
 
                   //
@@ -170,6 +295,18 @@ namespace casual
 
                   state.persistent.erase( std::end( remain), std::end( state.persistent));
 
+                  //
+                  // Checkpoint after the replies are sent, so the callers don't wait for it
+                  //
+                  if( state.checkpoint.transaction())
+                  {
+                     state.queuebase.checkpoint();
+                  }
+
+                  if( state.compaction.transaction())
+                  {
+                     state.queuebase.compact();
+                  }
 
                }
 
@@ -177,7 +314,57 @@ namespace casual
          } // message
 
 
-         Server::Server( Settings settings) : m_state( std::move( settings.queuebase), std::move( settings.name))
+         namespace local
+         {
+            namespace
+            {
+               Durability durability( const Settings& settings)
+               {
+                  Durability result;
+
+                  if( settings.journal == "wal")
+                  {
+                     result.journal = Durability::Journal::wal;
+                  }
+                  else if( ! settings.journal.empty() && settings.journal != "rollback")
+                  {
+                     throw common::exception::invalid::Argument{ "unknown journal", CASUAL_NIP( settings.journal)};
+                  }
+
+                  if( settings.synchronous == "normal")
+                  {
+                     result.synchronous = Durability::Synchronous::normal;
+                  }
+                  else if( settings.synchronous == "off")
+                  {
+                     result.synchronous = Durability::Synchronous::off;
+                  }
+                  else if( ! settings.synchronous.empty() && settings.synchronous != "full")
+                  {
+                     throw common::exception::invalid::Argument{ "unknown synchronous", CASUAL_NIP( settings.synchronous)};
+                  }
+
+                  result.cache = settings.cache;
+                  result.checkpoint = settings.checkpoint;
+
+                  return result;
+               }
+
+               blob::Settings blob( const Settings& settings)
+               {
+                  blob::Settings result;
+                  result.threshold = settings.blob;
+                  return result;
+               }
+
+            } // <unnamed>
+         } // local
+
+
+         Server::Server( Settings settings)
+            : m_state( std::move( settings.queuebase), std::move( settings.name), local::durability( settings),
+                  settings.batch > 0 ? settings.batch : common::platform::batch::transaction,
+                  local::blob( settings))
          {
             //
             // Talk to queue-broker to get configuration
@@ -226,6 +413,29 @@ namespace casual
                   }
                }
 
+               //
+               // Volatile queues are created in the queuebase as any other queue, only the
+               // messages are held in memory
+               //
+               {
+                  auto queues = m_state.queuebase.queues();
+
+                  for( auto&& queue : reply.queues)
+                  {
+                     if( ! queue.persistent)
+                     {
+                        auto found = common::range::find_if( queues, [&]( const Queue& q){
+                           return q.name == queue.name;
+                        });
+
+                        if( found)
+                        {
+                           m_state.memory.add( *found);
+                        }
+                     }
+                  }
+               }
+
 
                //
                // Try to remove queues
@@ -240,6 +450,7 @@ namespace casual
                common::message::queue::Information information;
                information.process = common::process::handle();
                information.queues = m_state.queuebase.queues();
+               m_state.memory.information( information.queues);
 
                common::communication::ipc::blocking::send( environment::broker::queue::id(), information);
             }
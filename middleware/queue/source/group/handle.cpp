@@ -12,6 +12,7 @@
 #include "common/internal/log.h"
 #include "common/trace.h"
 #include "common/error.h"
+#include "common/exception.h"
 
 
 // todo: temp
@@ -44,34 +45,99 @@ namespace casual
 
                   namespace pending
                   {
-                     void replies( State& state, const common::transaction::ID& trid)
+                     void send( State& state, const common::message::queue::dequeue::Request& request, common::message::queue::dequeue::Reply& reply)
                      {
-                        common::trace::Scope trace{ "queue::handle::pending", common::log::internal::queue};
+                        reply.correlation = request.correlation;
 
+                        if( request.trid)
+                        {
+                           involved( state, request);
+                        }
 
-                        auto pending = state.pending.commit( trid);
+                        try
+                        {
+                           common::communication::ipc::blocking::send( request.process.queue, reply);
+                        }
+                        catch( const common::exception::queue::Unavailable& exception)
+                        {
+                           common::log::internal::queue << "ipc-queue unavailable for request: " << request << " - action: ignore\n";
+                        }
+                     }
+
+                     //!
+                     //! Dequeues for requests without selector, one read for all of them
+                     //!
+                     void any( State& state, Queue::id_type queue, std::vector< common::message::queue::dequeue::Request>& requests)
+                     {
+                        std::vector< common::message::queue::dequeue::Reply> replies;
 
-                        for( auto& request : pending.requests)
+                        try
                         {
-                           try
+                           if( state.memory.handles( queue))
                            {
-                              auto& remaining = pending.enqueued[ request.queue];
-
-                              if( remaining > 0)
+                              for( auto& request : requests)
                               {
-                                 if( dequeue::request( state, request))
-                                 {
-                                    --remaining;
-                                 }
-                                 else
+                                 auto reply = state.memory.dequeue( request);
+
+                                 if( reply.message.empty())
                                  {
-                                    //
-                                    // Put it back in pending
-                                    //
-                                    state.pending.dequeue( request);
+                                    break;
                                  }
+                                 replies.push_back( std::move( reply));
                               }
+                           }
+                           else
+                           {
+                              replies = state.queuebase.dequeue( queue, requests);
+                           }
+                        }
+                        catch( const sql::database::exception::Base& exception)
+                        {
+                           //
+                           // The queuebase has rolled back, nothing is dequeued and all
+                           // requests goes back to pending
+                           //
+                           common::log::error << exception.what() << std::endl;
+                        }
+                        catch( const common::exception::invalid::File& exception)
+                        {
+                           common::log::error << exception << std::endl;
+                        }
+
+                        auto request = std::begin( requests);
+
+                        for( auto& reply : replies)
+                        {
+                           send( state, *request, reply);
+                           ++request;
+                        }
+
+                        //
+                        // The ones that did not get any message are back first in line
+                        //
+                        state.pending.restore( std::vector< common::message::queue::dequeue::Request>{
+                           std::make_move_iterator( request), std::make_move_iterator( std::end( requests))});
+                     }
 
+                     void replies( State& state, const common::transaction::ID& trid)
+                     {
+                        common::trace::Scope trace{ "queue::handle::pending", common::log::internal::queue};
+
+                        auto pending = state.pending.commit( trid);
+
+                        for( auto& waiting : pending.any)
+                        {
+                           any( state, waiting.first, waiting.second);
+                        }
+
+                        for( auto& request : pending.selective)
+                        {
+                           try
+                           {
+                              //
+                              // Puts it back in pending if there is no message for it
+                              //
+                              dequeue::request( state, request);
                            }
                            catch( const common::exception::queue::Unavailable& exception)
                            {
@@ -81,6 +147,63 @@ namespace casual
                      }
                   } // pending
 
+                  void enqueued( State& state, const common::message::queue::enqueue::Request& message)
+                  {
+                     state.pending.enqueue( message.trid, message.queue, message.message.properties);
+                  }
+
+                  void enqueued( State& state, const common::message::queue::enqueue::batch::Request& message)
+                  {
+                     for( auto& m : message.messages)
+                     {
+                        state.pending.enqueue( message.trid, message.queue, m.properties);
+                     }
+                  }
+
+                  template< typename M>
+                  void enqueue( State& state, M& message)
+                  {
+                     auto persistent = ! state.memory.handles( message.queue);
+
+                     auto reply = persistent ? state.queuebase.enqueue( message) : state.memory.enqueue( message);
+                     reply.correlation = message.correlation;
+
+                     enqueued( state, message);
+
+                     if( message.trid)
+                     {
+                        involved( state, message);
+
+                        common::communication::ipc::blocking::send( message.process.queue, reply);
+                     }
+                     else
+                     {
+                        if( persistent)
+                        {
+                           //
+                           // enqueue is not in transaction, we guarantee atomic enqueue so
+                           // we send reply when whe're in persistent state
+                           //
+                           state.persist( std::move( reply), { message.process.queue});
+                        }
+                        else
+                        {
+                           //
+                           // volatile, there is no persistent state to wait for
+                           //
+                           common::communication::ipc::blocking::send( message.process.queue, reply);
+                        }
+
+                        //
+                        // Check if there are any pending request for the current queue (and selector).
+                        // This could result in the message is dequeued before (persistent) reply to the caller
+                        //
+                        // We have to do it now, since it won't be any commits...
+                        //
+                        pending::replies( state, message.trid);
+                     }
+                  }
+
 
 
 
@@ -115,6 +238,7 @@ namespace casual
                      reply.correlation = message.correlation;
                      reply.process = common::process::handle();
                      reply.queues = m_state.queuebase.queues();
+                     m_state.memory.information( reply.queues);
 
                      common::communication::ipc::blocking::send( message.process.queue, reply);
                   }
@@ -130,7 +254,8 @@ namespace casual
                      common::message::queue::information::messages::Reply reply;
                      reply.correlation = message.correlation;
                      reply.process = common::process::handle();
-                     reply.messages = m_state.queuebase.messages( message.qid);
+                     reply.messages = m_state.memory.handles( message.qid) ?
+                           m_state.memory.messages( message.qid) : m_state.queuebase.messages( message.qid);
 
                      common::communication::ipc::blocking::send( message.process.queue, reply);
                   }
@@ -147,40 +272,59 @@ namespace casual
 
                   try
                   {
-                     auto reply = m_state.queuebase.enqueue( message);
-                     reply.correlation = message.correlation;
+                     local::enqueue( m_state, message);
+                  }
+                  catch( const sql::database::exception::Base& exception)
+                  {
+                     common::log::error << exception.what() << std::endl;
+                  }
+                  catch( const common::exception::invalid::File& exception)
+                  {
+                     common::log::error << exception << std::endl;
+                  }
+               }
 
-                     m_state.pending.enqueue( message.trid, message.queue);
+               namespace batch
+               {
+                  void Request::operator () ( message_type& message)
+                  {
+                     common::trace::Scope trace{ "queue::handle::enqueue::batch::Request", common::log::internal::queue};
 
-                     if( message.trid)
+                     try
+                     {
+                        //
+                        // All inserts are done within the same (scoped) write transaction
+                        // as any other request in this pump iteration
+                        //
+                        local::enqueue( m_state, message);
+                        return;
+                     }
+                     catch( const sql::database::exception::Base& exception)
+                     {
+                        common::log::error << exception.what() << std::endl;
+                     }
+                     catch( const common::exception::invalid::File& exception)
                      {
-                        local::involved( m_state, message);
+                        common::log::error << exception << std::endl;
+                     }
 
+                     //
+                     // Nothing of the batch is enqueued, reply without ids so the caller knows
+                     //
+                     common::message::queue::enqueue::batch::Reply reply;
+                     reply.correlation = message.correlation;
+
+                     try
+                     {
                         common::communication::ipc::blocking::send( message.process.queue, reply);
                      }
-                     else
+                     catch( const common::exception::queue::Unavailable& exception)
                      {
-                        //
-                        // enqueue is not in transaction, we guarantee atomic enqueue so
-                        // we send reply when whe're in persistent state
-                        //
-                        m_state.persist( std::move( reply), { message.process.queue});
-
-                        //
-                        // Check if there are any pending request for the current queue (and selector).
-                        // This could result in the message is dequeued before (persistent) reply to the caller
-                        //
-                        // We have to do it now, since it won't be any commits...
-                        //
-                        local::pending::replies( m_state, message.trid);
+                        common::log::internal::queue << "ipc-queue unavailable for request: " << message << " - action: ignore\n";
                      }
-
-                  }
-                  catch( const sql::database::exception::Base& exception)
-                  {
-                     common::log::error << exception.what() << std::endl;
                   }
-               }
+
+               } // batch
 
             } // enqueue
 
@@ -193,7 +337,8 @@ namespace casual
 
                   try
                   {
-                     auto reply = state.queuebase.dequeue( message);
+                     auto reply = state.memory.handles( message.queue) ?
+                           state.memory.dequeue( message) : state.queuebase.dequeue( message);
 
                      if( message.block && reply.message.empty())
                      {
@@ -221,7 +366,19 @@ namespace casual
                   {
                      common::log::error << exception.what() << std::endl;
                   }
-                  return false;
+                  catch( const common::exception::invalid::File& exception)
+                  {
+                     common::log::error << exception << std::endl;
+                  }
+
+                  //
+                  // Nothing is dequeued, reply empty so the caller doesn't wait for it
+                  //
+                  common::message::queue::dequeue::Reply reply;
+                  reply.correlation = message.correlation;
+                  common::communication::ipc::blocking::send( message.process.queue, reply);
+
+                  return true;
                }
 
 
@@ -270,6 +427,7 @@ namespace casual
                      try
                      {
                         m_state.queuebase.commit( message.trid);
+                        m_state.memory.commit( message.trid);
                         common::log::internal::transaction << "committed trid: " << message.trid << " - number of messages: " << m_state.queuebase.affected() << std::endl;
 
                         //
@@ -302,6 +460,7 @@ namespace casual
                      try
                      {
                         m_state.queuebase.rollback( message.trid);
+                        m_state.memory.rollback( message.trid);
                         common::log::internal::transaction << "rollback trid: " << message.trid << " - number of messages: " << m_state.queuebase.affected() << std::endl;
 
                         //
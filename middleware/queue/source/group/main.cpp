@@ -31,7 +31,13 @@ int main( int argc, char **argv)
       {
          casual::common::Arguments parser{ {
                casual::common::argument::directive( { "-qb", "--queuebase"}, "path to this queue server persistent storage", settings.queuebase),
-               casual::common::argument::directive( { "-n", "--name"}, "group name", settings.name)
+               casual::common::argument::directive( { "-n", "--name"}, "group name", settings.name),
+               casual::common::argument::directive( { "--journal"}, "queuebase journal mode [rollback|wal]", settings.journal),
+               casual::common::argument::directive( { "--synchronous"}, "queuebase synchronous mode [full|normal|off]", settings.synchronous),
+               casual::common::argument::directive( { "--cache"}, "queuebase page cache size in KiB", settings.cache),
+               casual::common::argument::directive( { "--checkpoint"}, "number of write transactions between wal checkpoints", settings.checkpoint),
+               casual::common::argument::directive( { "--batch"}, "max number of persistent replies per write transaction", settings.batch),
+               casual::common::argument::directive( { "--blob-threshold"}, "payloads larger than this (bytes) is stored outside the queuebase, 0 -> never", settings.blob)
          }};
 
          parser.parse( argc, argv);
@@ -0,0 +1,314 @@
+//!
+//! memory.cpp
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#include "queue/group/memory.h"
+
+#include "common/algorithm.h"
+#include "common/exception.h"
+#include "common/internal/log.h"
+#include "common/internal/trace.h"
+
+
+namespace casual
+{
+   namespace queue
+   {
+      namespace group
+      {
+         namespace local
+         {
+            namespace
+            {
+               common::platform::binary_type global( const common::transaction::ID& trid)
+               {
+                  auto range = common::transaction::global( trid);
+                  return { std::begin( range), std::end( range)};
+               }
+
+            } // <unnamed>
+         } // local
+
+         void Memory::add( const Queue& queue)
+         {
+            common::log::internal::queue << "volatile queue: " << queue << std::endl;
+
+            auto& storage = m_queues[ queue.id];
+            storage.error = queue.error;
+            storage.retries = queue.retries;
+
+            //
+            // The error queue is volatile as well, it has nowhere to send messages
+            // that exceeds the retries, since the group error queue is persistent.
+            //
+            m_queues[ queue.error].retries = queue.retries;
+         }
+
+         bool Memory::handles( Queue::id_type queue) const
+         {
+            return m_queues.count( queue) > 0;
+         }
+
+         Memory::Storage& Memory::storage( Queue::id_type queue)
+         {
+            auto found = m_queues.find( queue);
+
+            if( found == std::end( m_queues))
+            {
+               throw common::exception::invalid::Argument{ "queue is not volatile", CASUAL_NIP( queue)};
+            }
+            return found->second;
+         }
+
+         common::message::queue::enqueue::Reply Memory::enqueue( const common::message::queue::enqueue::Request& message)
+         {
+            common::trace::internal::Scope trace{ "queue::Memory::enqueue", common::log::internal::queue};
+
+            common::message::queue::enqueue::Reply reply;
+
+            reply.id = enqueue( message.trid, message.queue, message.message);
+
+            return reply;
+         }
+
+         common::message::queue::enqueue::batch::Reply Memory::enqueue( const common::message::queue::enqueue::batch::Request& message)
+         {
+            common::trace::internal::Scope trace{ "queue::Memory::enqueue batch", common::log::internal::queue};
+
+            common::message::queue::enqueue::batch::Reply reply;
+            reply.ids.reserve( message.messages.size());
+
+            for( auto& m : message.messages)
+            {
+               reply.ids.push_back( enqueue( message.trid, message.queue, m));
+            }
+
+            return reply;
+         }
+
+         common::Uuid Memory::enqueue( const common::transaction::ID& trid, Queue::id_type queue, const common::message::queue::base_message& message)
+         {
+            auto& entries = storage( queue).entries;
+
+            Entry entry;
+            static_cast< common::message::queue::base_message&>( entry.message) = message;
+
+            //
+            // We create a unique id if none is provided.
+            //
+            if( ! entry.message.id)
+            {
+               entry.message.id = common::uuid::make();
+            }
+            entry.message.timestamp = common::platform::clock_type::now();
+            entry.origin = queue;
+
+            if( trid)
+            {
+               entry.gtrid = local::global( trid);
+               entry.state = group::message::State::added;
+            }
+
+            auto position = entries.insert( std::end( entries), std::move( entry));
+
+            if( trid)
+            {
+               m_transactions[ position->gtrid].emplace_back( queue, position);
+            }
+
+            return position->message.id;
+         }
+
+         common::message::queue::dequeue::Reply Memory::dequeue( const common::message::queue::dequeue::Request& message)
+         {
+            common::trace::internal::Scope trace{ "queue::Memory::dequeue", common::log::internal::queue};
+
+            common::message::queue::dequeue::Reply reply;
+
+            auto& entries = storage( message.queue).entries;
+
+            auto now = common::platform::clock_type::now();
+
+            auto available = [&]( const Entry& e){
+               return e.state == group::message::State::enqueued
+                     && e.message.avalible < now
+                     && ( ! message.selector.id || e.message.id == message.selector.id)
+                     && ( message.selector.properties.empty() || e.message.properties == message.selector.properties);
+            };
+
+            auto count = message.selector.id ? 1 : std::max( message.count, std::size_t{ 1});
+
+            auto position = std::begin( entries);
+
+            while( reply.message.size() < count)
+            {
+               position = std::find_if( position, std::end( entries), available);
+
+               if( position == std::end( entries))
+               {
+                  break;
+               }
+
+               if( message.trid)
+               {
+                  //
+                  // We keep the message until the transaction is committed
+                  //
+                  position->state = group::message::State::removed;
+                  position->gtrid = local::global( message.trid);
+                  m_transactions[ position->gtrid].emplace_back( message.queue, position);
+
+                  reply.message.push_back( position->message);
+                  ++position;
+               }
+               else
+               {
+                  reply.message.push_back( std::move( position->message));
+                  position = entries.erase( position);
+               }
+            }
+
+            common::log::internal::queue << "dequeue - qid: " << message.queue << " messages: " << reply.message.size() << " trid: " << message.trid << std::endl;
+
+            return reply;
+         }
+
+         void Memory::commit( const common::transaction::ID& id)
+         {
+            auto found = m_transactions.find( local::global( id));
+
+            if( found == std::end( m_transactions))
+            {
+               return;
+            }
+
+            common::trace::internal::Scope trace{ "queue::Memory::commit", common::log::internal::queue};
+
+            for( auto& involved : found->second)
+            {
+               auto& position = std::get< 1>( involved);
+
+               if( position->state == group::message::State::added)
+               {
+                  position->state = group::message::State::enqueued;
+                  position->gtrid.clear();
+               }
+               else
+               {
+                  m_queues[ std::get< 0>( involved)].entries.erase( position);
+               }
+            }
+
+            m_transactions.erase( found);
+         }
+
+         void Memory::rollback( const common::transaction::ID& id)
+         {
+            auto found = m_transactions.find( local::global( id));
+
+            if( found == std::end( m_transactions))
+            {
+               return;
+            }
+
+            common::trace::internal::Scope trace{ "queue::Memory::rollback", common::log::internal::queue};
+
+            for( auto& involved : found->second)
+            {
+               auto& storage = m_queues[ std::get< 0>( involved)];
+               auto& position = std::get< 1>( involved);
+
+               if( position->state == group::message::State::added)
+               {
+                  storage.entries.erase( position);
+                  continue;
+               }
+
+               position->state = group::message::State::enqueued;
+               position->gtrid.clear();
+
+               if( ++position->message.redelivered > storage.retries && handles( storage.error))
+               {
+                  //
+                  // move to error queue
+                  //
+                  position->message.redelivered = 0;
+
+                  auto& error = m_queues[ storage.error].entries;
+                  error.splice( std::end( error), storage.entries, position);
+               }
+            }
+
+            m_transactions.erase( found);
+         }
+
+         void Memory::information( std::vector< common::message::queue::information::Queue>& queues) const
+         {
+            for( auto& queue : queues)
+            {
+               auto found = m_queues.find( queue.id);
+
+               if( found == std::end( m_queues))
+               {
+                  continue;
+               }
+
+               queue.persistent = false;
+               queue.count = 0;
+               queue.size = 0;
+               queue.uncommitted = 0;
+
+               for( auto& entry : found->second.entries)
+               {
+                  if( entry.state == group::message::State::added)
+                  {
+                     ++queue.uncommitted;
+                  }
+                  else
+                  {
+                     ++queue.count;
+                     queue.size += entry.message.payload.size();
+                  }
+               }
+            }
+         }
+
+         std::vector< common::message::queue::information::Message> Memory::messages( Queue::id_type id) const
+         {
+            std::vector< common::message::queue::information::Message> result;
+
+            auto found = m_queues.find( id);
+
+            if( found == std::end( m_queues))
+            {
+               return result;
+            }
+
+            for( auto& entry : found->second.entries)
+            {
+               common::message::queue::information::Message message;
+
+               message.id = entry.message.id;
+               message.queue = id;
+               message.origin = entry.origin;
+               message.trid = entry.gtrid;
+               message.state = entry.state;
+               message.reply = entry.message.reply;
+               message.redelivered = entry.message.redelivered;
+               message.type = entry.message.type;
+               message.avalible = entry.message.avalible;
+               message.timestamp = entry.message.timestamp;
+               message.size = entry.message.payload.size();
+
+               result.push_back( std::move( message));
+            }
+
+            return result;
+         }
+
+      } // group
+   } // queue
+} // casual
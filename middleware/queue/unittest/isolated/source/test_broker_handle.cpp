@@ -57,6 +57,7 @@ namespace casual
                broker::handle::connect::Request{ state.state},
                broker::handle::lookup::Request{ state.state},
                broker::handle::group::Involved{ state.state},
+               broker::handle::forward::Statistics{ state.state},
                broker::handle::transaction::commit::Request{ state.state},
                broker::handle::transaction::commit::Reply{ state.state},
                broker::handle::transaction::rollback::Request{ state.state},
@@ -185,6 +186,38 @@ namespace casual
          EXPECT_TRUE( state.state.involved.at( trid).at( 0) == state.group10.process());
       }
 
+      TEST( casual_queue_broker, handle_forward_statistics__twice__expect_latest)
+      {
+         test::State state;
+
+         common::mockup::ipc::Router broker{ common::communication::ipc::inbound::id()};
+         common::mockup::ipc::Instance forward{ 42};
+
+         common::communication::ipc::Helper ipc;
+
+         {
+            common::message::queue::forward::Statistics statistics;
+            statistics.process = forward.process();
+            statistics.queue = "queue1";
+            statistics.forwarded = 10;
+            ipc.blocking_send( broker.input(), statistics);
+
+            statistics.forwarded = 20;
+            statistics.errored = 1;
+            ipc.blocking_send( broker.input(), statistics);
+
+            ipc.blocking_send( broker.input(), common::message::shutdown::Request{});
+         }
+
+         test::handle( state);
+
+         ASSERT_TRUE( state.state.forwards.size() == 1);
+         auto& statistics = state.state.forwards.at( forward.process().pid);
+         EXPECT_TRUE( statistics.queue == "queue1");
+         EXPECT_TRUE( statistics.forwarded == 20);
+         EXPECT_TRUE( statistics.errored == 1);
+      }
+
       TEST( casual_queue_broker, handle_group_involved__xid1_1_group__xid2_2_groups)
       {
          test::State state;
@@ -0,0 +1,131 @@
+//!
+//! test_forward.cpp
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#include <gtest/gtest.h>
+
+#include "queue/forward/common.h"
+
+#include <sstream>
+
+namespace casual
+{
+   namespace queue
+   {
+      namespace local
+      {
+         namespace
+         {
+            forward::Configuration configuration( std::size_t batch)
+            {
+               forward::Configuration result;
+               result.batch = batch;
+               return result;
+            }
+
+            std::vector< std::size_t> redelivered( std::size_t count, std::size_t value = 0)
+            {
+               return std::vector< std::size_t>( count, value);
+            }
+
+         } // <unnamed>
+      } // local
+
+      TEST( casual_queue_forward, policy_batch_10__expect_batch_10)
+      {
+         forward::Policy policy{ local::configuration( 10)};
+
+         EXPECT_TRUE( policy.batch() == 10);
+         EXPECT_FALSE( policy.isolated());
+      }
+
+      TEST( casual_queue_forward, policy_batch_10__commit__expect_forwarded)
+      {
+         forward::Policy policy{ local::configuration( 10)};
+
+         policy.dequeued( 10);
+         EXPECT_TRUE( policy.statistics().in_flight == 10);
+
+         policy.committed( 10);
+
+         EXPECT_TRUE( policy.batch() == 10);
+         EXPECT_TRUE( policy.statistics().forwarded == 10);
+         EXPECT_TRUE( policy.statistics().transactions == 1);
+         EXPECT_TRUE( policy.statistics().in_flight == 0);
+         EXPECT_TRUE( policy.statistics().high == 10);
+      }
+
+      TEST( casual_queue_forward, policy_batch_10__rollback_3__expect_3_transactions_with_batch_1)
+      {
+         forward::Policy policy{ local::configuration( 10)};
+
+         policy.dequeued( 3);
+         policy.rolledback( local::redelivered( 3), 5);
+
+         EXPECT_TRUE( policy.isolated());
+
+         //
+         // two healthy messages and one that fails
+         //
+         EXPECT_TRUE( policy.batch() == 1);
+         policy.committed( 1);
+         EXPECT_TRUE( policy.batch() == 1);
+         policy.rolledback( local::redelivered( 1, 1), 5);
+         EXPECT_TRUE( policy.batch() == 1);
+         policy.committed( 1);
+
+         EXPECT_FALSE( policy.isolated());
+         EXPECT_TRUE( policy.batch() == 10);
+
+         EXPECT_TRUE( policy.statistics().forwarded == 2);
+         EXPECT_TRUE( policy.statistics().rolledback == 4);
+         EXPECT_TRUE( policy.statistics().transactions == 4);
+      }
+
+      TEST( casual_queue_forward, policy_batch_1__rollback__expect_not_isolated)
+      {
+         forward::Policy policy{ local::configuration( 1)};
+
+         policy.rolledback( local::redelivered( 1), 5);
+
+         EXPECT_FALSE( policy.isolated());
+         EXPECT_TRUE( policy.batch() == 1);
+      }
+
+      TEST( casual_queue_forward, policy_rollback__redelivered_exceeds_retries__expect_errored)
+      {
+         forward::Policy policy{ local::configuration( 10)};
+
+         policy.rolledback( { 0, 1, 2}, 2);
+
+         EXPECT_TRUE( policy.statistics().rolledback == 2);
+         EXPECT_TRUE( policy.statistics().errored == 1);
+      }
+
+      TEST( casual_queue_forward, policy_rollback__retries_0__expect_all_errored)
+      {
+         forward::Policy policy{ local::configuration( 10)};
+
+         policy.rolledback( local::redelivered( 4), 0);
+
+         EXPECT_TRUE( policy.statistics().rolledback == 0);
+         EXPECT_TRUE( policy.statistics().errored == 4);
+      }
+
+      TEST( casual_queue_forward, statistics__expect_streamed)
+      {
+         forward::Policy policy{ local::configuration( 10)};
+         policy.committed( 3);
+         policy.rolledback( local::redelivered( 1), 0);
+
+         std::ostringstream out;
+         out << policy.statistics();
+
+         EXPECT_TRUE( out.str() == "{ forwarded: 3, rolledback: 0, errored: 1, transactions: 2, in-flight: 0, high: 0}") << out.str();
+      }
+
+   } // queue
+} // casual
@@ -165,6 +165,459 @@ namespace casual
 
       }
 
+      TEST( casual_queue_group_database, wal_journal__enqueue_checkpoint__open_again__expect_message)
+      {
+         common::file::scoped::Path path{
+            common::file::name::unique(
+               common::environment::directory::temporary() + "/",
+               "unittest_queue_server_database.db")
+            };
+
+         group::Durability durability;
+         durability.journal = group::Durability::Journal::wal;
+         durability.synchronous = group::Durability::Synchronous::normal;
+         durability.cache = 1024;
+         durability.checkpoint = 1;
+
+         auto origin = local::message( group::Queue{});
+
+         {
+            group::Database database( path, "test_group", durability);
+
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+            origin.queue = queue.id;
+
+            {
+               auto writer = sql::database::scoped::write( database);
+               database.enqueue( origin);
+            }
+
+            EXPECT_TRUE( common::file::exists( path.path() + "-wal"));
+
+            database.checkpoint();
+         }
+
+         {
+            group::Database database( path, "test_group", durability);
+
+            auto queues = database.queues();
+            ASSERT_TRUE( queues.size() == 3);
+
+            auto fetched = database.dequeue( local::request( queues.at( 2)));
+
+            ASSERT_TRUE( fetched.message.size() == 1);
+            EXPECT_TRUE( fetched.message.front().id == origin.message.id);
+         }
+      }
+
+      TEST( casual_queue_group_database, wal_journal__open_again_with_rollback__expect_no_wal_file)
+      {
+         common::file::scoped::Path path{
+            common::file::name::unique(
+               common::environment::directory::temporary() + "/",
+               "unittest_queue_server_database.db")
+            };
+
+         auto origin = local::message( group::Queue{});
+
+         {
+            group::Durability durability;
+            durability.journal = group::Durability::Journal::wal;
+
+            group::Database database( path, "test_group", durability);
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+            origin.queue = queue.id;
+
+            auto writer = sql::database::scoped::write( database);
+            database.enqueue( origin);
+         }
+
+         group::Database database( path, "test_group");
+
+         {
+            auto writer = sql::database::scoped::write( database);
+            database.enqueue( local::message( database.queues().at( 2)));
+         }
+
+         EXPECT_FALSE( common::file::exists( path.path() + "-wal"));
+
+         auto request = local::request( database.queues().at( 2));
+         request.count = 10;
+         EXPECT_TRUE( database.dequeue( request).message.size() == 2);
+      }
+
+      TEST( casual_queue_group_database, wal_journal__in_memory__expect_fallback)
+      {
+         group::Durability durability;
+         durability.journal = group::Durability::Journal::wal;
+
+         group::Database database( local::file(), "test_group", durability);
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         database.enqueue( local::message( queue));
+         database.checkpoint();
+
+         EXPECT_TRUE( database.dequeue( local::request( queue)).message.size() == 1);
+      }
+
+      namespace local
+      {
+         namespace
+         {
+            common::file::scoped::Path temporary()
+            {
+               return common::file::scoped::Path{
+                  common::file::name::unique(
+                     common::environment::directory::temporary() + "/",
+                     "unittest_queue_server_database.db")
+                  };
+            }
+
+            common::file::scoped::Path segment( const common::file::scoped::Path& queuebase, std::size_t id)
+            {
+               return common::file::scoped::Path{ queuebase.path() + ".blob." + std::to_string( id)};
+            }
+
+            group::blob::Settings blob( std::size_t segment = 1024 * 1024)
+            {
+               group::blob::Settings result;
+               result.threshold = 100;
+               result.segment = segment;
+               return result;
+            }
+
+            common::message::queue::enqueue::Request large( const group::Queue& queue, std::size_t size = 1000)
+            {
+               auto result = message( queue);
+               result.message.payload.resize( size);
+               common::range::copy( common::uuid::string( result.message.id), std::begin( result.message.payload));
+               return result;
+            }
+
+         } // <unnamed>
+      } // local
+
+      TEST( casual_queue_group_database, blob__enqueue_large_payload__expect_stored_in_segment__dequeue_same_payload)
+      {
+         auto path = local::temporary();
+         auto segment = local::segment( path, 1);
+
+         group::Database database( path, "test_group", group::Durability{}, local::blob());
+
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         auto origin = local::large( queue);
+         database.enqueue( origin);
+
+         EXPECT_TRUE( common::file::exists( segment.path()));
+
+         auto queues = database.queues();
+         ASSERT_TRUE( queues.size() == 3);
+         EXPECT_TRUE( queues.at( 2).size == origin.message.payload.size()) << "size: " << queues.at( 2).size;
+
+         auto messages = database.messages( queue.id);
+         ASSERT_TRUE( messages.size() == 1);
+         EXPECT_TRUE( messages.at( 0).size == origin.message.payload.size());
+
+         auto fetched = database.dequeue( local::request( queue));
+
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).id == origin.message.id);
+         EXPECT_TRUE( fetched.message.at( 0).payload == origin.message.payload);
+
+         EXPECT_TRUE( database.queues().at( 2).size == 0);
+      }
+
+      TEST( casual_queue_group_database, blob__small_payload__expect_inline)
+      {
+         auto path = local::temporary();
+
+         group::Database database( path, "test_group", group::Durability{}, local::blob());
+
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         auto origin = local::message( queue);
+         database.enqueue( origin);
+
+         EXPECT_FALSE( common::file::exists( path.path() + ".blob.1"));
+
+         auto fetched = database.dequeue( local::request( queue));
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).payload == origin.message.payload);
+      }
+
+      TEST( casual_queue_group_database, blob__enqueue_rollback__expect_no_messages__size_0)
+      {
+         auto path = local::temporary();
+         auto segment = local::segment( path, 1);
+
+         group::Database database( path, "test_group", group::Durability{}, local::blob());
+
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         common::transaction::ID xid = common::transaction::ID::create();
+
+         auto origin = local::large( queue);
+         origin.trid = xid;
+         database.enqueue( origin);
+
+         database.rollback( xid);
+
+         EXPECT_TRUE( database.dequeue( local::request( queue)).message.empty());
+         EXPECT_TRUE( database.queues().at( 2).size == 0);
+      }
+
+      TEST( casual_queue_group_database, blob__open_again__expect_same_payload)
+      {
+         auto path = local::temporary();
+         auto segment = local::segment( path, 1);
+
+         auto origin = local::large( group::Queue{});
+
+         {
+            group::Database database( path, "test_group", group::Durability{}, local::blob());
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+            origin.queue = queue.id;
+
+            database.begin();
+            database.enqueue( origin);
+            database.commit();
+         }
+
+         {
+            group::Database database( path, "test_group", group::Durability{}, local::blob());
+
+            auto queues = database.queues();
+            ASSERT_TRUE( queues.size() == 3);
+
+            auto fetched = database.dequeue( local::request( queues.at( 2)));
+
+            ASSERT_TRUE( fetched.message.size() == 1);
+            EXPECT_TRUE( fetched.message.at( 0).payload == origin.message.payload);
+         }
+      }
+
+      TEST( casual_queue_group_database, blob__open_again_without_threshold__expect_same_payload)
+      {
+         auto path = local::temporary();
+         auto segment = local::segment( path, 1);
+
+         auto origin = local::large( group::Queue{});
+
+         {
+            group::Database database( path, "test_group", group::Durability{}, local::blob());
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+            origin.queue = queue.id;
+
+            database.begin();
+            database.enqueue( origin);
+            database.commit();
+         }
+
+         {
+            group::Database database( path, "test_group", group::Durability{}, group::blob::Settings{});
+
+            auto fetched = database.dequeue( local::request( database.queues().at( 2)));
+
+            ASSERT_TRUE( fetched.message.size() == 1);
+            EXPECT_TRUE( fetched.message.at( 0).payload == origin.message.payload);
+         }
+      }
+
+      TEST( casual_queue_group_database, blob__segment_missing__dequeue__expect_broken_moved_to_error_queue__next_dequeued)
+      {
+         auto path = local::temporary();
+         auto segment = local::segment( path, 1);
+
+         auto origin = local::large( group::Queue{});
+         auto next = local::message( group::Queue{});
+
+         {
+            group::Database database( path, "test_group", group::Durability{}, local::blob());
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+            origin.queue = queue.id;
+            next.queue = queue.id;
+
+            database.begin();
+            database.enqueue( origin);
+            database.enqueue( next);
+            database.commit();
+         }
+
+         common::file::remove( segment.path());
+
+         group::Database database( path, "test_group", group::Durability{}, local::blob());
+
+         auto fetched = database.dequeue( local::request( database.queues().at( 2)));
+
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).id == next.message.id);
+         EXPECT_TRUE( database.messages( origin.queue).empty());
+
+         auto error = database.messages( database.queues().at( 1).id);
+         ASSERT_TRUE( error.size() == 1);
+         EXPECT_TRUE( error.at( 0).id == origin.message.id);
+         EXPECT_TRUE( error.at( 0).state == group::message::State::broken);
+
+         //
+         // Broken messages are never dequeued, not even from the error queue
+         //
+         EXPECT_TRUE( database.dequeue( local::request( database.queues().at( 1))).message.empty());
+      }
+
+      TEST( casual_queue_group_database, blob__segment_rollover__dequeue_first__compact__expect_first_segment_removed)
+      {
+         auto path = local::temporary();
+         auto first = local::segment( path, 1);
+         auto second = local::segment( path, 2);
+
+         group::Database database( path, "test_group", group::Durability{}, local::blob( 1500));
+
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         auto one = local::large( queue);
+         database.enqueue( one);
+         auto two = local::large( queue);
+         database.enqueue( two);
+
+         EXPECT_TRUE( common::file::exists( first.path()));
+         EXPECT_TRUE( common::file::exists( second.path()));
+
+         database.compact();
+         EXPECT_TRUE( common::file::exists( first.path()));
+
+         auto fetched = database.dequeue( local::request( queue));
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).payload == one.message.payload);
+
+         database.compact();
+         EXPECT_FALSE( common::file::exists( first.path()));
+
+         fetched = database.dequeue( local::request( queue));
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).payload == two.message.payload);
+      }
+
+      TEST( casual_queue_group_database, blob__mostly_dead_segment__compact__expect_live_blobs_moved)
+      {
+         auto path = local::temporary();
+         auto first = local::segment( path, 1);
+         auto second = local::segment( path, 2);
+
+         group::Database database( path, "test_group", group::Durability{}, local::blob( 3000));
+
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         std::vector< common::message::queue::enqueue::Request> messages;
+
+         for( auto count = 0; count < 4; ++count)
+         {
+            messages.push_back( local::large( queue));
+            database.enqueue( messages.back());
+         }
+
+         //
+         // 3 in the first segment, 1 in the second. Dequeue 2 of the first
+         //
+         for( auto count = 0; count < 2; ++count)
+         {
+            auto fetched = database.dequeue( local::request( queue));
+            ASSERT_TRUE( fetched.message.size() == 1);
+         }
+
+         database.compact();
+
+         EXPECT_FALSE( common::file::exists( first.path()));
+         EXPECT_TRUE( database.queues().at( 2).size == 2000);
+
+         for( auto count = 2; count < 4; ++count)
+         {
+            auto fetched = database.dequeue( local::request( queue));
+            ASSERT_TRUE( fetched.message.size() == 1);
+            EXPECT_TRUE( fetched.message.at( 0).id == messages.at( count).message.id);
+            EXPECT_TRUE( fetched.message.at( 0).payload == messages.at( count).message.payload);
+         }
+      }
+
+      TEST( casual_queue_group_database, counters__enqueue_3_one_uncommitted__open_again__expect_rebuilt)
+      {
+         auto path = local::temporary();
+
+         auto origin = local::message( group::Queue{});
+
+         {
+            group::Database database( path, "test_group");
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+            origin.queue = queue.id;
+
+            database.begin();
+            database.enqueue( origin);
+            database.enqueue( local::message( queue));
+            database.enqueue( local::message( queue, common::transaction::ID::create()));
+            database.commit();
+         }
+
+         group::Database database( path, "test_group");
+
+         auto queues = database.queues();
+         ASSERT_TRUE( queues.size() == 3);
+         EXPECT_TRUE( queues.at( 2).count == 2) << "count: " << queues.at( 2).count;
+         EXPECT_TRUE( queues.at( 2).size == 2 * origin.message.payload.size());
+         EXPECT_TRUE( queues.at( 2).uncommitted == 1);
+      }
+
+      TEST( casual_queue_group_database, counters__enqueue__flush__expect_queue_table_updated)
+      {
+         auto path = local::temporary();
+
+         group::Database database( path, "test_group");
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         auto origin = local::message( queue);
+
+         database.begin();
+         database.enqueue( origin);
+         database.flush();
+         database.commit();
+
+         sql::database::Connection connection( path);
+         auto query = connection.query( "SELECT count, size, uncommitted_count FROM queue WHERE id = ?;", queue.id);
+
+         sql::database::Row row;
+         ASSERT_TRUE( query.fetch( row));
+         EXPECT_TRUE( row.get< std::size_t>( 0) == 1);
+         EXPECT_TRUE( row.get< std::size_t>( 1) == origin.message.payload.size());
+         EXPECT_TRUE( row.get< std::size_t>( 2) == 0);
+      }
+
+      TEST( casual_queue_group_database, counters__dequeue_rollback_exceed_retries__expect_counted_in_error_queue)
+      {
+         auto path = local::file();
+         group::Database database( path, "test_group");
+
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         auto origin = local::message( queue);
+         database.enqueue( origin);
+
+         auto xid = common::transaction::ID::create();
+         EXPECT_TRUE( database.dequeue( local::request( queue, xid)).message.size() == 1);
+
+         database.rollback( xid);
+
+         auto queues = database.queues();
+         ASSERT_TRUE( queues.size() == 3);
+
+         // error queue
+         EXPECT_TRUE( queues.at( 1).id == queue.error);
+         EXPECT_TRUE( queues.at( 1).count == 1);
+         EXPECT_TRUE( queues.at( 1).size == origin.message.payload.size());
+
+         EXPECT_TRUE( queues.at( 2).count == 0) << "count: " << queues.at( 2).count;
+         EXPECT_TRUE( queues.at( 2).size == 0);
+         EXPECT_TRUE( queues.at( 2).uncommitted == 0);
+      }
+
       TEST( casual_queue_group_database, create_5_queue_on_disc_and_open_again)
       {
          common::file::scoped::Path path{
@@ -429,6 +882,260 @@ namespace casual
       }
 
 
+      TEST( casual_queue_group_database, batch_enqueue_100_message__dequeue_max_30__expect_30_30_30_10)
+      {
+         auto path = local::file();
+         group::Database database( path, "test_group");
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         common::message::queue::enqueue::batch::Request batch;
+         batch.queue = queue.id;
+
+         auto count = 0;
+         while( count++ < 100)
+         {
+            auto m = local::message( queue).message;
+            m.type.name = std::to_string( count);
+            batch.messages.push_back( std::move( m));
+         }
+
+         {
+            auto writer = sql::database::scoped::write( database);
+            auto reply = database.enqueue( batch);
+
+            ASSERT_TRUE( reply.ids.size() == 100);
+            EXPECT_TRUE( reply.ids.front() == batch.messages.front().id);
+            EXPECT_TRUE( reply.ids.back() == batch.messages.back().id);
+         }
+
+         auto writer = sql::database::scoped::write( database);
+
+         auto request = local::request( queue);
+         request.count = 30;
+
+         auto origin = std::begin( batch.messages);
+
+         for( std::size_t expected : { 30, 30, 30, 10})
+         {
+            auto fetched = database.dequeue( request);
+
+            ASSERT_TRUE( fetched.message.size() == expected) << "size: " << fetched.message.size();
+
+            for( auto& message : fetched.message)
+            {
+               EXPECT_TRUE( origin->id == message.id);
+               EXPECT_TRUE( origin->type == message.type);
+               EXPECT_TRUE( origin->payload == message.payload);
+               ++origin;
+            }
+         }
+
+         EXPECT_TRUE( database.dequeue( request).message.empty());
+      }
+
+      TEST( casual_queue_group_database, batch_enqueue_in_transaction__rollback__expect_no_messages)
+      {
+         auto path = local::file();
+         group::Database database( path, "test_group");
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         common::transaction::ID xid = common::transaction::ID::create();
+
+         common::message::queue::enqueue::batch::Request batch;
+         batch.queue = queue.id;
+         batch.trid = xid;
+         batch.messages = { local::message( queue).message, local::message( queue).message, local::message( queue).message};
+
+         EXPECT_TRUE( database.enqueue( batch).ids.size() == 3);
+
+         database.rollback( xid);
+
+         auto request = local::request( queue);
+         request.count = 10;
+
+         EXPECT_TRUE( database.dequeue( request).message.empty());
+      }
+
+      TEST( casual_queue_group_database, batch_enqueue_duplicate_id__expect_throw__no_messages)
+      {
+         auto path = local::file();
+         group::Database database( path, "test_group");
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         common::message::queue::enqueue::batch::Request batch;
+         batch.queue = queue.id;
+         batch.messages = { local::message( queue).message, local::message( queue).message, local::message( queue).message};
+         batch.messages.back().id = batch.messages.front().id;
+
+         {
+            auto writer = sql::database::scoped::write( database);
+
+            EXPECT_THROW({
+               database.enqueue( batch);
+            }, sql::database::exception::Base);
+         }
+
+         auto request = local::request( queue);
+         request.count = 10;
+
+         EXPECT_TRUE( database.dequeue( request).message.empty());
+         EXPECT_TRUE( database.queues().at( 2).count == 0);
+      }
+
+      TEST( casual_queue_group_database, dequeue_count_10__fails_at_second__expect_throw__no_messages_dequeued)
+      {
+         auto path = local::temporary();
+
+         {
+            group::Database database( path, "test_group");
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+
+            auto writer = sql::database::scoped::write( database);
+            for( auto count = 0; count < 3; ++count)
+            {
+               database.enqueue( local::message( queue));
+            }
+         }
+
+         {
+            //
+            // Make the dequeue of the second message fail
+            //
+            sql::database::Connection connection( path);
+            connection.execute( "CREATE TRIGGER unittest_fail BEFORE DELETE ON message WHEN old.ROWID = 2 BEGIN SELECT RAISE( ABORT, 'unittest'); END;");
+         }
+
+         group::Database database( path, "test_group");
+         auto queue = database.queues().at( 2);
+
+         auto request = local::request( queue);
+         request.count = 10;
+
+         {
+            auto writer = sql::database::scoped::write( database);
+
+            EXPECT_THROW({
+               database.dequeue( request);
+            }, sql::database::exception::Base);
+         }
+
+         EXPECT_TRUE( database.messages( queue.id).size() == 3);
+         EXPECT_TRUE( database.queues().at( 2).count == 3);
+      }
+
+      TEST( casual_queue_group_database, dequeue_from_id__count_10__expect_1_message)
+      {
+         auto path = local::file();
+         group::Database database( path, "test_group");
+         auto queue = database.create( group::Queue{ "unittest_queue"});
+
+         auto origin = local::message( queue);
+         database.enqueue( origin);
+         database.enqueue( local::message( queue));
+
+         auto request = local::request( queue);
+         request.selector.id = origin.message.id;
+         request.count = 10;
+
+         auto fetched = database.dequeue( request);
+
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.front().id == origin.message.id);
+      }
+
+
+      TEST( casual_queue_group_database, batch_enqueue_5__dequeue_for_3_requests_count_1_1_2__expect_messages_in_order)
+      {
+         auto path = local::file();
+         group::Database database( path, "test_group");
+
+         auto queue = database.create( group::Queue{ "unittest_queue", 1});
+
+         std::vector< common::message::queue::enqueue::Request> messages;
+
+         for( auto count = 0; count < 5; ++count)
+         {
+            messages.push_back( local::message( queue));
+            database.enqueue( messages.back());
+         }
+
+         std::vector< common::message::queue::dequeue::Request> requests;
+         for( std::size_t count : { 1, 1, 2})
+         {
+            requests.push_back( local::request( queue, common::transaction::ID::create()));
+            requests.back().count = count;
+         }
+
+         auto replies = database.dequeue( queue.id, requests);
+
+         ASSERT_TRUE( replies.size() == 3);
+         ASSERT_TRUE( replies.at( 0).message.size() == 1);
+         ASSERT_TRUE( replies.at( 1).message.size() == 1);
+         ASSERT_TRUE( replies.at( 2).message.size() == 2);
+
+         EXPECT_TRUE( replies.at( 0).message.at( 0).id == messages.at( 0).message.id);
+         EXPECT_TRUE( replies.at( 1).message.at( 0).id == messages.at( 1).message.id);
+         EXPECT_TRUE( replies.at( 2).message.at( 0).id == messages.at( 2).message.id);
+         EXPECT_TRUE( replies.at( 2).message.at( 1).id == messages.at( 3).message.id);
+
+         //
+         // Only one left, the second request gets nothing
+         //
+         requests.resize( 2);
+         replies = database.dequeue( queue.id, requests);
+
+         ASSERT_TRUE( replies.size() == 1);
+         ASSERT_TRUE( replies.at( 0).message.size() == 1);
+         EXPECT_TRUE( replies.at( 0).message.at( 0).id == messages.at( 4).message.id);
+
+         //
+         // The first request rolls back, its message is available again
+         //
+         database.rollback( requests.at( 0).trid);
+
+         EXPECT_TRUE( database.dequeue( local::request( queue)).message.size() == 1);
+      }
+
+      TEST( casual_queue_group_database, dequeue_for_3_requests__fails_at_third_message__expect_throw__no_messages_dequeued)
+      {
+         auto path = local::temporary();
+
+         {
+            group::Database database( path, "test_group");
+            auto queue = database.create( group::Queue{ "unittest_queue"});
+
+            auto writer = sql::database::scoped::write( database);
+            for( auto count = 0; count < 3; ++count)
+            {
+               database.enqueue( local::message( queue));
+            }
+         }
+
+         {
+            //
+            // Make the dequeue of the third message fail
+            //
+            sql::database::Connection connection( path);
+            connection.execute( "CREATE TRIGGER unittest_fail BEFORE DELETE ON message WHEN old.ROWID = 3 BEGIN SELECT RAISE( ABORT, 'unittest'); END;");
+         }
+
+         group::Database database( path, "test_group");
+         auto queue = database.queues().at( 2);
+
+         std::vector< common::message::queue::dequeue::Request> requests{ 3, local::request( queue)};
+
+         {
+            auto writer = sql::database::scoped::write( database);
+
+            EXPECT_THROW({
+               database.dequeue( queue.id, requests);
+            }, sql::database::exception::Base);
+         }
+
+         EXPECT_TRUE( database.messages( queue.id).size() == 3);
+         EXPECT_TRUE( database.queues().at( 2).count == 3);
+      }
+
       TEST( casual_queue_group_database, enqueue_one_message_in_transaction)
       {
          auto path = local::file();
@@ -0,0 +1,313 @@
+//!
+//! test_group_memory.cpp
+//!
+//! Created on: Oct 18, 2016
+//!     Author: Lazan
+//!
+
+#include <gtest/gtest.h>
+
+
+#include "queue/group/memory.h"
+
+#include "common/exception.h"
+
+
+namespace casual
+{
+   namespace queue
+   {
+      namespace local
+      {
+         namespace
+         {
+            static const common::transaction::ID nullId{};
+
+            group::Queue queue( std::size_t retries = 0)
+            {
+               group::Queue result{ "unittest_queue", retries};
+               result.id = 10;
+               result.error = 11;
+               result.persistent = false;
+               return result;
+            }
+
+            group::Memory memory( const group::Queue& queue)
+            {
+               group::Memory result;
+               result.add( queue);
+               return result;
+            }
+
+            common::message::queue::enqueue::Request message( const group::Queue& queue, const common::transaction::ID& trid = nullId)
+            {
+               common::message::queue::enqueue::Request result;
+
+               result.queue = queue.id;
+               result.trid = trid;
+
+               result.message.id = common::uuid::make();
+               result.message.reply = "someQueue";
+               result.message.type = common::buffer::type::binary();
+
+               common::range::copy( common::uuid::string( common::uuid::make()), std::back_inserter(result.message.payload));
+
+               return result;
+            }
+
+            common::message::queue::dequeue::Request request( const group::Queue& queue, const common::transaction::ID& trid = nullId)
+            {
+               common::message::queue::dequeue::Request result;
+
+               result.queue = queue.id;
+               result.trid = trid;
+
+               return result;
+            }
+
+         } // <unnamed>
+      } // local
+
+
+      TEST( casual_queue_group_memory, handles__expect_queue_and_error_queue)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         EXPECT_TRUE( memory.handles( queue.id));
+         EXPECT_TRUE( memory.handles( queue.error));
+         EXPECT_FALSE( memory.handles( 1));
+      }
+
+      TEST( casual_queue_group_memory, enqueue_not_volatile_queue__expect_throw)
+      {
+         auto memory = local::memory( local::queue());
+
+         group::Queue other{ "other"};
+         other.id = 42;
+
+         EXPECT_THROW( { memory.enqueue( local::message( other));}, common::exception::invalid::Argument);
+      }
+
+      TEST( casual_queue_group_memory, enqueue_dequeue_one_message)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         auto origin = local::message( queue);
+         EXPECT_TRUE( memory.enqueue( origin).id == origin.message.id);
+
+         auto fetched = memory.dequeue( local::request( queue));
+
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).id == origin.message.id);
+         EXPECT_TRUE( fetched.message.at( 0).type == origin.message.type);
+         EXPECT_TRUE( fetched.message.at( 0).reply == origin.message.reply);
+         EXPECT_TRUE( fetched.message.at( 0).payload == origin.message.payload);
+
+         EXPECT_TRUE( memory.dequeue( local::request( queue)).message.empty());
+      }
+
+      TEST( casual_queue_group_memory, enqueue_without_id__expect_generated_id)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         auto origin = local::message( queue);
+         origin.message.id = common::Uuid{};
+
+         auto id = memory.enqueue( origin).id;
+         EXPECT_TRUE( static_cast< bool>( id));
+
+         auto request = local::request( queue);
+         request.selector.id = id;
+         EXPECT_TRUE( memory.dequeue( request).message.size() == 1);
+      }
+
+      TEST( casual_queue_group_memory, dequeue_message__from_properties)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         memory.enqueue( local::message( queue));
+
+         auto origin = local::message( queue);
+         origin.message.properties = "some: properties";
+         memory.enqueue( origin);
+
+         auto request = local::request( queue);
+         request.selector.properties = origin.message.properties;
+
+         auto fetched = memory.dequeue( request);
+
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).id == origin.message.id);
+
+         EXPECT_TRUE( memory.dequeue( request).message.empty());
+      }
+
+      TEST( casual_queue_group_memory, dequeue_not_available_yet__expect_0_messages)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         auto origin = local::message( queue);
+         origin.message.avalible = common::platform::clock_type::now() + std::chrono::hours{ 1};
+         memory.enqueue( origin);
+
+         EXPECT_TRUE( memory.dequeue( local::request( queue)).message.empty());
+      }
+
+      TEST( casual_queue_group_memory, batch_enqueue_10__dequeue_count_4__expect_4_4_2_in_order)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         common::message::queue::enqueue::batch::Request batch;
+         batch.queue = queue.id;
+
+         for( auto count = 0; count < 10; ++count)
+         {
+            batch.messages.push_back( local::message( queue).message);
+         }
+
+         EXPECT_TRUE( memory.enqueue( batch).ids.size() == 10);
+
+         auto request = local::request( queue);
+         request.count = 4;
+
+         auto origin = std::begin( batch.messages);
+
+         for( std::size_t expected : { 4, 4, 2})
+         {
+            auto fetched = memory.dequeue( request);
+            ASSERT_TRUE( fetched.message.size() == expected);
+
+            for( auto& message : fetched.message)
+            {
+               EXPECT_TRUE( message.id == origin->id);
+               ++origin;
+            }
+         }
+      }
+
+      TEST( casual_queue_group_memory, enqueue_in_transaction__expect_available_after_commit)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         auto xid = common::transaction::ID::create();
+         auto origin = local::message( queue, xid);
+
+         memory.enqueue( origin);
+
+         EXPECT_TRUE( memory.dequeue( local::request( queue)).message.empty());
+         EXPECT_TRUE( memory.dequeue( local::request( queue, xid)).message.empty());
+
+         memory.commit( xid);
+
+         auto fetched = memory.dequeue( local::request( queue));
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).id == origin.message.id);
+      }
+
+      TEST( casual_queue_group_memory, enqueue_in_transaction_rollback__expect_no_messages)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         auto xid = common::transaction::ID::create();
+         memory.enqueue( local::message( queue, xid));
+
+         memory.rollback( xid);
+
+         EXPECT_TRUE( memory.dequeue( local::request( queue)).message.empty());
+         EXPECT_TRUE( memory.messages( queue.id).empty());
+      }
+
+      TEST( casual_queue_group_memory, dequeue_in_transaction_commit__expect_removed)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         memory.enqueue( local::message( queue));
+
+         auto xid = common::transaction::ID::create();
+         EXPECT_TRUE( memory.dequeue( local::request( queue, xid)).message.size() == 1);
+
+         //
+         // still there, but not available
+         //
+         EXPECT_TRUE( memory.messages( queue.id).size() == 1);
+         EXPECT_TRUE( memory.dequeue( local::request( queue)).message.empty());
+
+         memory.commit( xid);
+
+         EXPECT_TRUE( memory.messages( queue.id).empty());
+      }
+
+      TEST( casual_queue_group_memory, dequeue_in_transaction_rollback__expect_redelivered)
+      {
+         auto queue = local::queue( 1);
+         auto memory = local::memory( queue);
+
+         auto origin = local::message( queue);
+         memory.enqueue( origin);
+
+         auto xid = common::transaction::ID::create();
+         EXPECT_TRUE( memory.dequeue( local::request( queue, xid)).message.size() == 1);
+
+         memory.rollback( xid);
+
+         auto fetched = memory.dequeue( local::request( queue));
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).id == origin.message.id);
+         EXPECT_TRUE( fetched.message.at( 0).redelivered == 1);
+      }
+
+      TEST( casual_queue_group_memory, dequeue_rollback_exceed_retries__expect_moved_to_error_queue)
+      {
+         auto queue = local::queue( 0);
+         auto memory = local::memory( queue);
+
+         auto origin = local::message( queue);
+         memory.enqueue( origin);
+
+         auto xid = common::transaction::ID::create();
+         EXPECT_TRUE( memory.dequeue( local::request( queue, xid)).message.size() == 1);
+
+         memory.rollback( xid);
+
+         EXPECT_TRUE( memory.dequeue( local::request( queue)).message.empty());
+
+         auto request = local::request( queue);
+         request.queue = queue.error;
+
+         auto fetched = memory.dequeue( request);
+         ASSERT_TRUE( fetched.message.size() == 1);
+         EXPECT_TRUE( fetched.message.at( 0).id == origin.message.id);
+         EXPECT_TRUE( fetched.message.at( 0).redelivered == 0);
+      }
+
+      TEST( casual_queue_group_memory, information__expect_count_size_uncommitted)
+      {
+         auto queue = local::queue();
+         auto memory = local::memory( queue);
+
+         auto origin = local::message( queue);
+         memory.enqueue( origin);
+         memory.enqueue( local::message( queue, common::transaction::ID::create()));
+
+         std::vector< common::message::queue::information::Queue> queues( 1);
+         queues.at( 0).id = queue.id;
+
+         memory.information( queues);
+
+         EXPECT_FALSE( queues.at( 0).persistent);
+         EXPECT_TRUE( queues.at( 0).count == 1) << queues.at( 0).count;
+         EXPECT_TRUE( queues.at( 0).size == origin.message.payload.size());
+         EXPECT_TRUE( queues.at( 0).uncommitted == 1);
+      }
+
+   } // queue
+} // casual
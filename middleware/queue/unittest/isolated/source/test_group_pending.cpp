@@ -32,6 +32,13 @@ namespace casual
 
                return result;
             }
+
+            common::message::queue::dequeue::Request create_selective( std::size_t queue, const std::string& properties)
+            {
+               auto result = create_request( queue);
+               result.selector.properties = properties;
+               return result;
+            }
          } // <unnamed>
       } // local
       TEST( casual_queue_group_pending, empty_commit__expect_no_pending)
@@ -42,8 +49,7 @@ namespace casual
 
          auto result = pending.commit( trid);
 
-         EXPECT_TRUE( result.enqueued.empty());
-         EXPECT_TRUE( result.requests.empty());
+         EXPECT_TRUE( result.empty());
       }
 
 
@@ -58,11 +64,12 @@ namespace casual
 
          auto result = pending.commit( trid);
 
-         ASSERT_TRUE( result.requests.size() == 1);
-         EXPECT_TRUE( result.requests.at( 0).block);
-         EXPECT_TRUE( result.requests.at( 0).queue == 10);
-         ASSERT_TRUE( result.enqueued.size() == 1);
-         EXPECT_TRUE( result.enqueued.at( 10) == 1);
+         ASSERT_TRUE( result.any.size() == 1);
+         ASSERT_TRUE( result.any.at( 10).size() == 1);
+         EXPECT_TRUE( result.any.at( 10).at( 0).block);
+         EXPECT_TRUE( result.any.at( 10).at( 0).queue == 10);
+         EXPECT_TRUE( result.selective.empty());
+         EXPECT_TRUE( pending.requests.empty());
       }
 
       TEST( casual_queue_group_pending, block_request_q10__enqueue_q20__commit__expect_0_pending)
@@ -76,8 +83,7 @@ namespace casual
 
          auto result = pending.commit( trid);
 
-         EXPECT_TRUE( result.enqueued.empty());
-         EXPECT_TRUE( result.requests.empty());
+         EXPECT_TRUE( result.empty());
       }
 
       TEST( casual_queue_group_pending, block_request_q10__enqueue_3x_q10__commit__expect_1_pending)
@@ -93,11 +99,9 @@ namespace casual
 
          auto result = pending.commit( trid);
 
-         ASSERT_TRUE( result.requests.size() == 1);
-         EXPECT_TRUE( result.requests.at( 0).block);
-         EXPECT_TRUE( result.requests.at( 0).queue == 10);
-         ASSERT_TRUE( result.enqueued.size() == 1);
-         EXPECT_TRUE( result.enqueued.at( 10) == 3);
+         ASSERT_TRUE( result.any.size() == 1);
+         ASSERT_TRUE( result.any.at( 10).size() == 1);
+         EXPECT_TRUE( result.any.at( 10).at( 0).queue == 10);
       }
 
 
@@ -112,31 +116,118 @@ namespace casual
 
          auto result = pending.commit( trid);
 
-         EXPECT_TRUE( result.enqueued.empty());
-         EXPECT_TRUE( result.requests.empty());
+         EXPECT_TRUE( result.empty());
       }
 
 
-      TEST( casual_queue_group_pending, block_request_2x_q10__enqueue_q10__commit__expect_2_pending)
+      TEST( casual_queue_group_pending, block_request_2x_q10__enqueue_q10__commit__expect_1_woken__1_pending)
       {
          auto trid = common::transaction::ID::create();
 
          group::State::Pending pending;
 
+         auto first = local::create_request( 10);
+         first.correlation = common::uuid::make();
+         pending.dequeue( first);
          pending.dequeue( local::create_request( 10));
-         pending.dequeue( local::create_request( 10));
 
          pending.enqueue( trid, 10);
 
          auto result = pending.commit( trid);
 
-         ASSERT_TRUE( result.requests.size() == 2);
-         EXPECT_TRUE( result.requests.at( 0).block);
-         EXPECT_TRUE( result.requests.at( 0).queue == 10);
-         EXPECT_TRUE( result.requests.at( 1).block);
-         EXPECT_TRUE( result.requests.at( 1).queue == 10);
-         ASSERT_TRUE( result.enqueued.size() == 1);
-         EXPECT_TRUE( result.enqueued.at( 10) == 1);
+         ASSERT_TRUE( result.any.at( 10).size() == 1);
+         EXPECT_TRUE( result.any.at( 10).at( 0).correlation == first.correlation);
+
+         ASSERT_TRUE( pending.requests.size() == 1);
+         EXPECT_TRUE( pending.requests.at( 10).any.size() == 1);
+      }
+
+      TEST( casual_queue_group_pending, block_request_3x_q10__enqueue_2x_q10__commit__restore__expect_order_kept)
+      {
+         auto trid = common::transaction::ID::create();
+
+         group::State::Pending pending;
+
+         std::vector< common::Uuid> correlations;
+
+         for( auto count = 0; count < 3; ++count)
+         {
+            auto request = local::create_request( 10);
+            request.correlation = common::uuid::make();
+            correlations.push_back( request.correlation);
+            pending.dequeue( request);
+         }
+
+         pending.enqueue( trid, 10);
+         pending.enqueue( trid, 10);
+
+         auto result = pending.commit( trid);
+         ASSERT_TRUE( result.any.at( 10).size() == 2);
+
+         //
+         // none of them got a message
+         //
+         pending.restore( std::move( result.any.at( 10)));
+
+         auto& any = pending.requests.at( 10).any;
+         ASSERT_TRUE( any.size() == 3);
+         EXPECT_TRUE( any.at( 0).correlation == correlations.at( 0));
+         EXPECT_TRUE( any.at( 1).correlation == correlations.at( 1));
+         EXPECT_TRUE( any.at( 2).correlation == correlations.at( 2));
+      }
+
+      TEST( casual_queue_group_pending, block_request_properties_a_b__enqueue_properties_b__commit__expect_b_woken)
+      {
+         auto trid = common::transaction::ID::create();
+
+         group::State::Pending pending;
+
+         pending.dequeue( local::create_selective( 10, "a"));
+         pending.dequeue( local::create_selective( 10, "b"));
+
+         pending.enqueue( trid, 10, "b");
+
+         auto result = pending.commit( trid);
+
+         EXPECT_TRUE( result.any.empty());
+         ASSERT_TRUE( result.selective.size() == 1);
+         EXPECT_TRUE( result.selective.at( 0).selector.properties == "b");
+
+         ASSERT_TRUE( pending.requests.at( 10).properties.size() == 1);
+         EXPECT_TRUE( pending.requests.at( 10).properties.count( "a") == 1);
+      }
+
+      TEST( casual_queue_group_pending, block_request_properties_a__enqueue_no_properties__commit__expect_0_woken)
+      {
+         auto trid = common::transaction::ID::create();
+
+         group::State::Pending pending;
+
+         pending.dequeue( local::create_selective( 10, "a"));
+         pending.enqueue( trid, 10);
+
+         EXPECT_TRUE( pending.commit( trid).empty());
+         EXPECT_TRUE( pending.requests.at( 10).properties.at( "a").size() == 1);
+      }
+
+      TEST( casual_queue_group_pending, block_request_2x_q10_same_process__forget__expect_1_pending)
+      {
+         group::State::Pending pending;
+
+         pending.dequeue( local::create_request( 10));
+         pending.dequeue( local::create_request( 10));
+
+         common::message::queue::dequeue::forget::Request request;
+         request.queue = 10;
+         request.process = common::process::handle();
+
+         EXPECT_TRUE( pending.forget( request).found);
+         EXPECT_TRUE( pending.requests.at( 10).any.size() == 1);
+
+         EXPECT_TRUE( pending.forget( request).found);
+         EXPECT_TRUE( pending.requests.empty());
+
+         EXPECT_FALSE( pending.forget( request).found);
       }
 
       TEST( casual_queue_group_pending, block_request_q10_q20___enqueue_q10__commit__expect_1_pending)
@@ -152,11 +243,12 @@ namespace casual
 
          auto result = pending.commit( trid);
 
-         ASSERT_TRUE( result.requests.size() == 1);
-         EXPECT_TRUE( result.requests.at( 0).block);
-         EXPECT_TRUE( result.requests.at( 0).queue == 10);
-         ASSERT_TRUE( result.enqueued.size() == 1);
-         EXPECT_TRUE( result.enqueued.at( 10) == 1);
+         ASSERT_TRUE( result.any.size() == 1);
+         ASSERT_TRUE( result.any.at( 10).size() == 1);
+         EXPECT_TRUE( result.any.at( 10).at( 0).queue == 10);
+
+         ASSERT_TRUE( pending.requests.size() == 1);
+         EXPECT_TRUE( pending.requests.count( 20) == 1);
       }
 
       TEST( casual_queue_group_pending, block_request_q10_q20___enqueue_q10_g20__commit__expect_2_pending)
@@ -173,14 +265,12 @@ namespace casual
 
          auto result = pending.commit( trid);
 
-         ASSERT_TRUE( result.requests.size() == 2);
-         EXPECT_TRUE( result.requests.at( 0).block);
-         EXPECT_TRUE( result.requests.at( 0).queue == 10);
-         EXPECT_TRUE( result.requests.at( 1).block);
-         EXPECT_TRUE( result.requests.at( 1).queue == 20);
-         ASSERT_TRUE( result.enqueued.size() == 2);
-         EXPECT_TRUE( result.enqueued.at( 10) == 1);
-         EXPECT_TRUE( result.enqueued.at( 20) == 1);
+         ASSERT_TRUE( result.any.size() == 2);
+         ASSERT_TRUE( result.any.at( 10).size() == 1);
+         EXPECT_TRUE( result.any.at( 10).at( 0).queue == 10);
+         ASSERT_TRUE( result.any.at( 20).size() == 1);
+         EXPECT_TRUE( result.any.at( 20).at( 0).queue == 20);
+         EXPECT_TRUE( pending.requests.empty());
       }
 
       TEST( casual_queue_group_pending, block_dequeue_q10_pid_42__enqueue_3x_q10__erase_pid_42__expect_0_pending)
@@ -198,13 +288,7 @@ namespace casual
 
          EXPECT_TRUE( pending.requests.empty());
 
-         {
-            auto result = pending.commit( trid);
-
-            EXPECT_TRUE( result.requests.empty());
-            ASSERT_TRUE( result.enqueued.size() == 1);
-            EXPECT_TRUE( result.enqueued.at( 10) == 3);
-         }
+         EXPECT_TRUE( pending.commit( trid).empty());
 
          EXPECT_TRUE( pending.transactions.empty());
       }
@@ -12,6 +12,7 @@
 #include "queue/api/rm/queue.h"
 #include "queue/broker/admin/queuevo.h"
 #include "queue/rm/switch.h"
+#include "queue/common/queue.h"
 
 #include "common/mockup/domain.h"
 #include "common/transaction/context.h"
@@ -226,5 +227,33 @@ domain:
          EXPECT_TRUE( messages.size() == 5);
       }
 
+      TEST( casual_queue, enqueue__restart_domain__expect_lookup_cache_invalidated)
+      {
+         const std::string payload{ "some message"};
+         queue::Message message;
+         message.payload.data.assign( std::begin( payload), std::end( payload));
+
+         common::process::Handle group;
+
+         {
+            local::Domain domain{ local::configuration()};
+
+            queue::rm::enqueue( "queueA1", message);
+            group = queue::lookup::Cache::instance().get( "queueA1").process;
+         }
+
+         {
+            local::Domain domain{ local::configuration()};
+
+            //
+            // The cached group is gone, so the enqueue has to look up the new group
+            //
+            queue::rm::enqueue( "queueA1", message);
+
+            EXPECT_TRUE( queue::lookup::Cache::instance().get( "queueA1").process != group);
+            EXPECT_TRUE( local::call::messages( "queueA1").size() == 1);
+         }
+      }
+
    } // queue
 } // casual
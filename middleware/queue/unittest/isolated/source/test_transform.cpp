@@ -68,6 +68,33 @@ namespace casual
 
       }
 
+      TEST( casual_queue_transform, forwards__one_without_ipc_queue__expect_1_forward)
+      {
+         auto state = local::state();
+
+         {
+            common::message::queue::forward::Statistics statistics;
+            statistics.process = common::process::handle();
+            statistics.queue = "q11";
+            statistics.forwarded = 42;
+            state.forwards[ statistics.process.pid] = statistics;
+         }
+
+         {
+            common::message::queue::forward::Statistics statistics;
+            statistics.process.pid = 1;
+            statistics.process.queue = -1;
+            statistics.queue = "q12";
+            state.forwards[ statistics.process.pid] = statistics;
+         }
+
+         auto forwards = transform::forwards( state);
+
+         ASSERT_TRUE( forwards.size() == 1) << CASUAL_MAKE_NVP( forwards);
+         EXPECT_TRUE( forwards.at( 0).queue == "q11");
+         EXPECT_TRUE( forwards.at( 0).forwarded == 42);
+      }
+
 
 
    } // queue
@@ -128,6 +128,18 @@ extern void tpsvrdone();
 
 extern void casual_service_forward( const char* service, char* data, long size);
 
+/*
+ * Returns a file descriptor that is readable when replies (or other messages) has arrived
+ * to the process. Can be used with select/poll/epoll, and replies are fetched with
+ * tpgetrply( ..., TPNOBLOCK). The descriptor shall not be read or closed by the caller.
+ *
+ * The descriptor is edge-triggered, replies that an earlier tpgetrply has already taken
+ * in does not make it readable again. When woken, fetch all replies that are expected.
+ *
+ * Returns -1 on failure, and tperrno is set.
+ */
+extern int casual_reply_descriptor( void);
+
 typedef enum { c_log_error, c_log_warning, c_log_information, c_log_debug } casual_log_category_t;
 extern int casual_log( casual_log_category_t category, const char* const format, ...);
 extern int casual_vlog( casual_log_category_t category, const char* const format, va_list ap);
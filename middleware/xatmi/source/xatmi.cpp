@@ -9,6 +9,7 @@
 
 #include "common/buffer/pool.h"
 #include "common/call/context.h"
+#include "common/communication/ipc.h"
 #include "common/server/context.h"
 #include "common/platform.h"
 #include "common/log.h"
@@ -292,6 +293,21 @@ void casual_service_forward( const char* service, char* data, long size)
    casual::common::server::Context::instance().forward( service, data, size);
 }
 
+int casual_reply_descriptor( void)
+{
+   casual_set_tperrno( 0);
+
+   try
+   {
+      return casual::common::communication::ipc::inbound::device().connector().descriptor();
+   }
+   catch( ...)
+   {
+      casual_set_tperrno( casual::common::error::handler());
+      return -1;
+   }
+}
+
 namespace local
 {
    namespace
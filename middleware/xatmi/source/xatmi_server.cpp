@@ -80,6 +80,8 @@ int casual_start_server( casual_server_argument* serverArgument)
 
       common::message::dispatch::Handler handler{
          common::server::handle::Call( common::communication::ipc::inbound::device(), local::transform::ServerArguments{}( *serverArgument)),
+         common::call::handle::Revoke{},
+         common::message::handle::ping(),
          common::message::handle::Shutdown{},
       };
 
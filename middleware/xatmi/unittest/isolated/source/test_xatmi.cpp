@@ -17,13 +17,17 @@
 #include "common/trace.h"
 
 #include "common/flag.h"
+#include "common/call/state.h"
 
 #include "common/message/server.h"
 #include "common/message/transaction.h"
 
 #include <map>
+#include <atomic>
 #include <vector>
 
+#include <poll.h>
+
 namespace casual
 {
    using namespace common;
@@ -82,6 +86,62 @@ namespace casual
                }
             };
 
+            namespace busy
+            {
+               //!
+               //! Replies busy, and later idle. Keeps track of whether the caller let broker expire
+               //! the pending lookup. Broker drops an expired lookup without reply, so a caller without
+               //! a deadline of its own would wait forever
+               //!
+               struct Lookup
+               {
+                  using message_type = common::message::service::lookup::Request;
+
+                  Lookup( platform::queue_id_type server, std::atomic< bool>& expire) : m_server( server), m_expire( expire) {}
+
+                  std::vector< communication::message::Complete> operator () ( message_type message)
+                  {
+                     m_expire = message.expire;
+
+                     auto reply = mockup::create::lookup::reply( message.requested, m_server);
+                     reply.correlation = message.correlation;
+
+                     std::vector< communication::message::Complete> result;
+
+                     reply.state = common::message::service::lookup::Reply::State::busy;
+                     result.emplace_back( marshal::complete( reply));
+
+                     reply.state = common::message::service::lookup::Reply::State::idle;
+                     result.emplace_back( marshal::complete( reply));
+
+                     return result;
+                  }
+
+               private:
+                  platform::queue_id_type m_server;
+                  std::atomic< bool>& m_expire;
+               };
+
+               struct Domain
+               {
+                  Domain()
+                     : server{ communication::ipc::inbound::id(), mockup::create::server({
+                        std::make_pair( std::string{ "service_1"}, common::message::service::call::Reply{})
+                     })},
+                     broker{ communication::ipc::inbound::id(), mockup::transform::Handler{ Lookup{ server.input(), expire}}},
+                     link_broker_reply{ mockup::ipc::broker::queue().output().connector().id(), broker.input()}
+                  {
+
+                  }
+
+                  std::atomic< bool> expire{ true};
+                  mockup::ipc::Router server;
+                  mockup::ipc::Router broker;
+                  mockup::ipc::Link link_broker_reply;
+               };
+
+            } // busy
+
          } // <unnamed>
       } // local
 
@@ -153,6 +213,37 @@ namespace casual
          tpfree( buffer);
       }
 
+      TEST( casual_xatmi, tpacall_TPNOREPLY_TPNOTRAN__service_busy__expect_pending_lookup_not_to_expire)
+      {
+         local::busy::Domain domain;
+
+         auto buffer = tpalloc( X_OCTET, nullptr, 128);
+
+         EXPECT_TRUE( tpacall( "service_1", buffer, 128, TPNOREPLY | TPNOTRAN) == 0) << "tperrno: " << common::error::xatmi::error( tperrno);
+
+         //
+         // TPNOREPLY has no deadline, if broker would expire the lookup we would hang
+         //
+         EXPECT_FALSE( domain.expire);
+
+         tpfree( buffer);
+      }
+
+      TEST( casual_xatmi, tpacall_service_1__service_busy__expect_pending_lookup_to_expire)
+      {
+         local::busy::Domain domain;
+
+         auto buffer = tpalloc( X_OCTET, nullptr, 128);
+
+         auto descriptor = tpacall( "service_1", buffer, 128, 0);
+         EXPECT_TRUE( descriptor > 0) << "tperrno: " << common::error::xatmi::error( tperrno);
+         EXPECT_TRUE( domain.expire);
+
+         EXPECT_TRUE( tpcancel( descriptor) != -1);
+
+         tpfree( buffer);
+      }
+
       TEST( casual_xatmi, tpacall_buffer_null__expect_expect_ok)
       {
          //
@@ -390,6 +481,57 @@ namespace casual
          tpfree( buffer);
       }
 
+      TEST( casual_xatmi, tpacall_service_1__poll_reply_descriptor__tpgetrply_TPNOBLOCK__expect_ok)
+      {
+         //
+         // Get rid of replies earlier tests might have left, before we start to poll
+         //
+         while( communication::ipc::non::blocking::next( communication::ipc::inbound::device()))
+            ;
+
+         local::Domain domain;
+
+         auto descriptor = casual_reply_descriptor();
+         ASSERT_TRUE( descriptor != -1) << "tperrno: " << common::error::xatmi::error( tperrno);
+
+         auto buffer = tpalloc( X_OCTET, nullptr, 128);
+         auto len = tptypes( buffer, nullptr, nullptr);
+
+         auto call = tpacall( "service_1", buffer, 128, 0);
+         EXPECT_TRUE( call != -1) << "tperrno: " << common::error::xatmi::error( tperrno);
+
+         struct pollfd reply{ descriptor, POLLIN, 0};
+         EXPECT_TRUE( poll( &reply, 1, 5000) == 1);
+
+         EXPECT_TRUE( tpgetrply( &call, &buffer, &len, TPNOBLOCK) != -1) << "tperrno: " << common::error::xatmi::error( tperrno);
+
+         //
+         // The reply is received, nothing new has arrived
+         //
+         EXPECT_TRUE( poll( &reply, 1, 0) == 0);
+
+         tpfree( buffer);
+      }
+
+
+      TEST( casual_xatmi, reservation__tpcall_service_1__10_times__expect_ok)
+      {
+         local::Domain domain;
+
+         call::State::Reservations::active( true);
+         scope::Execute reset{ [](){ call::State::Reservations::active( false);}};
+
+         auto buffer = tpalloc( X_OCTET, nullptr, 128);
+         auto len = tptypes( buffer, nullptr, nullptr);
+
+         for( auto count = 10; count > 0; --count)
+         {
+            EXPECT_TRUE( tpcall( "service_1", buffer, 128, &buffer, &len, 0) == 0) << "tperrno: " << common::error::xatmi::error( tperrno);
+         }
+
+         tpfree( buffer);
+      }
+
 
       /*
       TEST( casual_xatmi, tpcall_service_timeout_2__expect_TPETIME)